@@ -0,0 +1,119 @@
+#include "m3d/affine.h"
+#include "m3d/vec3.h"
+#include "m3d/mat3x3.h"
+#include "m3d/mat4x4.h"
+#include "m3d/transform.h"
+
+namespace m3d
+{
+    affine::affine() {};
+
+    affine::affine(const float& diagonal)
+    {
+        m[0][0] = diagonal;
+        m[1][1] = diagonal;
+        m[2][2] = diagonal;
+    }
+
+    affine affine::fromMat4x4(const mat4x4& m)
+    {
+        affine res;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                res.m[i][j] = m.at(i, j);
+            }
+        }
+
+        return res;
+    }
+
+    affine affine::fromTransform(const transform& t)
+    {
+        return affine::fromMat4x4(transform::toMat4x4(t));
+    }
+
+    affine affine::mul(const affine& a, const affine& b)
+    {
+        affine res;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                res.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j];
+            }
+
+            res.m[i][3] += a.m[i][3];
+        }
+
+        return res;
+    }
+
+    vec3 affine::mulPoint(const affine& a, const vec3& b)
+    {
+        vec3 res;
+
+        res.x = a.m[0][0] * b.x + a.m[0][1] * b.y + a.m[0][2] * b.z + a.m[0][3];
+        res.y = a.m[1][0] * b.x + a.m[1][1] * b.y + a.m[1][2] * b.z + a.m[1][3];
+        res.z = a.m[2][0] * b.x + a.m[2][1] * b.y + a.m[2][2] * b.z + a.m[2][3];
+
+        return res;
+    }
+
+    vec3 affine::mulDirection(const affine& a, const vec3& b)
+    {
+        vec3 res;
+
+        res.x = a.m[0][0] * b.x + a.m[0][1] * b.y + a.m[0][2] * b.z;
+        res.y = a.m[1][0] * b.x + a.m[1][1] * b.y + a.m[1][2] * b.z;
+        res.z = a.m[2][0] * b.x + a.m[2][1] * b.y + a.m[2][2] * b.z;
+
+        return res;
+    }
+
+    mat3x3 affine::toMat3x3() const
+    {
+        mat3x3 res;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                res.at(i, j) = m[i][j];
+            }
+        }
+
+        return res;
+    }
+
+    mat4x4 affine::toMat4x4() const
+    {
+        mat4x4 res;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                res.at(i, j) = m[i][j];
+            }
+        }
+
+        res.at(3, 3) = 1.0f;
+
+        return res;
+    }
+}
+
+m3d::affine operator*(const m3d::affine& a, const m3d::affine& b)
+{
+    return m3d::affine::mul(a, b);
+}
+
+m3d::affine& operator*=(m3d::affine& a, const m3d::affine& b)
+{
+    a = m3d::affine::mul(a, b);
+    return a;
+}
@@ -0,0 +1,79 @@
+#include "m3d/arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+namespace m3d
+{
+    const size_t arena::ALIGNMENT;
+
+    arena::arena(const size_t& capacity) : m_capacity(capacity), m_offset(0), m_highWater(0)
+    {
+        m_memory = (char*)malloc(capacity + ALIGNMENT);
+        if(m_memory == nullptr)
+        {
+            m_base = nullptr;
+            m_capacity = 0;
+            return;
+        }
+
+        m_base = (char*)(((uintptr_t)m_memory + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+
+        // fault every page in now instead of during the first frames
+        memset(m_base, 0, m_capacity);
+    }
+
+    arena::~arena()
+    {
+        free(m_memory);
+    }
+
+    void* arena::allocate(const size_t& size, const size_t& alignment)
+    {
+        // alignment must be a power of two
+        uintptr_t start = (uintptr_t)m_base + m_offset;
+        uintptr_t aligned = (start + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        size_t offset = (size_t)(aligned - (uintptr_t)m_base);
+
+        if(offset > m_capacity || size > m_capacity - offset)
+            return nullptr;
+
+        m_offset = offset + size;
+        if(m_offset > m_highWater)
+            m_highWater = m_offset;
+
+        return m_base + offset;
+    }
+
+    void arena::reset()
+    {
+        m_offset = 0;
+    }
+
+    size_t arena::mark() const
+    {
+        return m_offset;
+    }
+
+    void arena::rewind(const size_t& marker)
+    {
+        if(marker <= m_offset)
+            m_offset = marker;
+    }
+
+    size_t arena::used() const
+    {
+        return m_offset;
+    }
+
+    size_t arena::capacity() const
+    {
+        return m_capacity;
+    }
+
+    size_t arena::highWater() const
+    {
+        return m_highWater;
+    }
+}
@@ -0,0 +1,453 @@
+#include "m3d/m3d.h"
+#include "timer.h"
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+/** ------------- accuracy report for the fast math paths
+    every function runs its m3d and fast variants over random and adversarial inputs
+    and compares them against a double / long double reference.
+
+    errors are normwise ulps, the largest component error divided by the float ulp
+    of the largest reference component, so near zero components don't blow up the report.
+    quaternions are compared up to sign.
+
+    usage: m3daccuracy [--json file] [--quick] */
+
+using namespace m3d;
+using bench::keep;
+
+namespace
+{
+    struct row
+    {
+        std::string function;
+        std::string variant;
+        std::string inputs;
+        double maxUlp;
+        double meanUlp;
+        double maxAbs;
+        double nsPerOp;
+    };
+
+    std::vector<row> g_rows;
+    double g_minTime = 0.05;
+    const size_t SAMPLES = 100000;
+
+    std::mt19937 g_rng(1234);
+
+    float uniform(const float& low, const float& high)
+    {
+        return std::uniform_real_distribution<float>(low, high)(g_rng);
+    }
+
+    float logUniform(const float& low, const float& high)
+    {
+        return expf(uniform(logf(low), logf(high)));
+    }
+
+    double ulp(const double& v)
+    {
+        float f = (float)fabs(v);
+        if(f < FLT_MIN)
+            return std::numeric_limits<float>::denorm_min();
+        return (double)nextafterf(f, INFINITY) - (double)f;
+    }
+
+    // In is the input type, N the number of float outputs
+    template <typename In, unsigned N> struct variant
+    {
+        const char* name;
+        void (*fn)(const In&, float*);
+    };
+
+    template <typename In> struct inputSet
+    {
+        const char* name;
+        std::vector<In> values;
+    };
+
+    template <typename In, unsigned N>
+    void evaluate(const char* function, const std::vector<inputSet<In> >& sets, void (*reference)(const In&, long double*),
+                  const std::vector<variant<In, N> >& variants, const bool& signless)
+    {
+        for(const variant<In, N>& v : variants)
+        {
+            // throughput over the first (random) set
+            const std::vector<In>& timed = sets[0].values;
+            double ns = bench::measure([&](size_t iterations)
+            {
+                float out[N];
+                for(size_t n = 0; n < iterations; n++)
+                {
+                    for(const In& in : timed)
+                    {
+                        v.fn(in, out);
+                        keep(out);
+                    }
+                }
+            }, g_minTime, 1) / (double)timed.size();
+
+            for(const inputSet<In>& set : sets)
+            {
+                double maxUlp = 0.0, sumUlp = 0.0, maxAbs = 0.0;
+                for(const In& in : set.values)
+                {
+                    long double ref[N];
+                    float got[N];
+                    reference(in, ref);
+                    v.fn(in, got);
+
+                    double s = 1.0;
+                    if(signless)
+                    {
+                        long double d = 0.0;
+                        for(unsigned c = 0; c < N; c++)
+                            d += ref[c] * got[c];
+                        s = d < 0.0 ? -1.0 : 1.0;
+                    }
+
+                    double largest = 0.0, err = 0.0;
+                    for(unsigned c = 0; c < N; c++)
+                    {
+                        largest = std::max(largest, (double)fabsl(ref[c]));
+                        err = std::max(err, (double)fabsl((long double)got[c] * s - ref[c]));
+                    }
+
+                    double u = err / ulp(largest);
+                    if(u != u) u = INFINITY;
+                    maxUlp = std::max(maxUlp, u);
+                    sumUlp += u;
+                    maxAbs = std::max(maxAbs, err != err ? INFINITY : err);
+                }
+
+                row r;
+                r.function = function;
+                r.variant = v.name;
+                r.inputs = set.name;
+                r.maxUlp = maxUlp;
+                r.meanUlp = sumUlp / (double)set.values.size();
+                r.maxAbs = maxAbs;
+                r.nsPerOp = ns;
+                g_rows.push_back(r);
+
+                printf("%-22s %-26s %-14s %12.2f %12.3f %12.3g %10.3f\n", function, v.name, set.name,
+                       r.maxUlp, r.meanUlp, r.maxAbs, r.nsPerOp);
+            }
+        }
+        fflush(stdout);
+    }
+
+    ///////////////////////////////////////
+    //              TRIG                 //
+    ///////////////////////////////////////
+
+    void refSin(const float& x, long double* out) { out[0] = sinl(x); }
+    void refCos(const float& x, long double* out) { out[0] = cosl(x); }
+    void refAcos(const float& x, long double* out) { out[0] = acosl(x); }
+    void refRsqrt(const float& x, long double* out) { out[0] = 1.0L / sqrtl(x); }
+
+    void libSin(const float& x, float* out) { out[0] = sinf(x); }
+    void libCos(const float& x, float* out) { out[0] = cosf(x); }
+    void libAcos(const float& x, float* out) { out[0] = acosf(x); }
+    void libRsqrt(const float& x, float* out) { out[0] = 1.0f / sqrtf(x); }
+
+    void fSin(const float& x, float* out) { out[0] = fastSin(x); }
+    void fCos(const float& x, float* out) { out[0] = fastCos(x); }
+    void fAcos(const float& x, float* out) { out[0] = fastAcos(x); }
+    void fRsqrt(const float& x, float* out) { out[0] = fastRsqrt(x); }
+
+    void trig()
+    {
+        std::vector<inputSet<float> > angles(4);
+        angles[0].name = "random";
+        angles[1].name = "wide";
+        angles[2].name = "quadrants";
+        angles[3].name = "tiny";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            angles[0].values.push_back(uniform(-3.14159265f, 3.14159265f));
+            angles[1].values.push_back(uniform(-4096.0f, 4096.0f));
+            // right next to multiples of pi/2 where the reduction loses bits
+            int k = (int)uniform(-64.0f, 64.0f);
+            angles[2].values.push_back(nextafterf((float)(k * M_PI * 0.5), uniform(-1.0f, 1.0f) < 0.0f ? -INFINITY : INFINITY));
+            angles[3].values.push_back(logUniform(1e-30f, 1e-3f) * (n & 1 ? -1.0f : 1.0f));
+        }
+
+        std::vector<variant<float, 1> > sinVariants = { { "sinf", libSin }, { "fastSin", fSin } };
+        std::vector<variant<float, 1> > cosVariants = { { "cosf", libCos }, { "fastCos", fCos } };
+        evaluate<float, 1>("sin", angles, refSin, sinVariants, false);
+        evaluate<float, 1>("cos", angles, refCos, cosVariants, false);
+
+        std::vector<inputSet<float> > cosines(3);
+        cosines[0].name = "random";
+        cosines[1].name = "near +-1";
+        cosines[2].name = "near 0";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            cosines[0].values.push_back(uniform(-1.0f, 1.0f));
+            cosines[1].values.push_back((1.0f - logUniform(1e-7f, 1e-2f)) * (n & 1 ? -1.0f : 1.0f));
+            cosines[2].values.push_back(logUniform(1e-20f, 1e-2f) * (n & 1 ? -1.0f : 1.0f));
+        }
+
+        std::vector<variant<float, 1> > acosVariants = { { "acosf", libAcos }, { "fastAcos", fAcos } };
+        evaluate<float, 1>("acos", cosines, refAcos, acosVariants, false);
+
+        std::vector<inputSet<float> > squares(2);
+        squares[0].name = "random";
+        squares[1].name = "extreme";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            squares[0].values.push_back(logUniform(1e-4f, 1e4f));
+            squares[1].values.push_back(logUniform(1e-37f, 1e37f));
+        }
+
+        std::vector<variant<float, 1> > rsqrtVariants = { { "1 / sqrtf", libRsqrt }, { "fastRsqrt", fRsqrt } };
+        evaluate<float, 1>("rsqrt", squares, refRsqrt, rsqrtVariants, false);
+    }
+
+    ///////////////////////////////////////
+    //              VECTORS              //
+    ///////////////////////////////////////
+
+    void refNormalizeVec3(const vec3& v, long double* out)
+    {
+        long double l = sqrtl((long double)v.x * v.x + (long double)v.y * v.y + (long double)v.z * v.z);
+        out[0] = v.x / l;
+        out[1] = v.y / l;
+        out[2] = v.z / l;
+    }
+
+    void normalizedVec3(const vec3& v, float* out) { vec3 r = vec3::normalized(v); out[0] = r.x; out[1] = r.y; out[2] = r.z; }
+    void normalizedFastVec3(const vec3& v, float* out) { vec3 r = vec3::normalizedFast(v); out[0] = r.x; out[1] = r.y; out[2] = r.z; }
+
+    vec3 randomDirection()
+    {
+        vec3 v;
+        do
+        {
+            v = vec3(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f));
+        } while(v.lengthSqr() > 1.0f || v.lengthSqr() < 1e-6f);
+        return v;
+    }
+
+    void vectors()
+    {
+        std::vector<inputSet<vec3> > sets(4);
+        sets[0].name = "random";
+        sets[1].name = "tiny";
+        sets[2].name = "huge";
+        sets[3].name = "near axis";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            vec3 d = randomDirection();
+            sets[0].values.push_back(d * uniform(0.1f, 100.0f));
+            sets[1].values.push_back(d * logUniform(1e-18f, 1e-6f));
+            sets[2].values.push_back(d * logUniform(1e6f, 1e18f));
+            sets[3].values.push_back(vec3(1.0f, uniform(-1e-4f, 1e-4f), uniform(-1e-4f, 1e-4f)) * uniform(0.1f, 100.0f));
+        }
+
+        std::vector<variant<vec3, 3> > variants = { { "vec3::normalized", normalizedVec3 }, { "vec3::normalizedFast", normalizedFastVec3 } };
+        evaluate<vec3, 3>("vec3 normalize", sets, refNormalizeVec3, variants, false);
+    }
+
+    ///////////////////////////////////////
+    //              QUATERNIONS          //
+    ///////////////////////////////////////
+
+    struct slerpInput
+    {
+        quat a, b;
+        float t;
+    };
+
+    struct angleAxisInput
+    {
+        float angle;
+        vec3 axis;
+    };
+
+    quat randomQuat()
+    {
+        return quat(uniform(-3.14159265f, 3.14159265f), randomDirection().normalized());
+    }
+
+    void refNormalizeQuat(const quat& v, long double* out)
+    {
+        long double l = sqrtl((long double)v.i * v.i + (long double)v.j * v.j + (long double)v.k * v.k + (long double)v.w * v.w);
+        out[0] = v.i / l;
+        out[1] = v.j / l;
+        out[2] = v.k / l;
+        out[3] = v.w / l;
+    }
+
+    void refSlerp(const slerpInput& in, long double* out)
+    {
+        long double a[4], b[4];
+        refNormalizeQuat(in.a, a);
+        refNormalizeQuat(in.b, b);
+
+        long double d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        if(d < 0.0L)
+        {
+            for(long double& c : b) c = -c;
+            d = -d;
+        }
+
+        long double theta = acosl(fminl(d, 1.0L));
+        long double s0, s1;
+        if(theta < 1e-12L)
+        {
+            s0 = 1.0L - in.t;
+            s1 = in.t;
+        }
+        else
+        {
+            s0 = sinl((1.0L - in.t) * theta) / sinl(theta);
+            s1 = sinl(in.t * theta) / sinl(theta);
+        }
+
+        for(unsigned c = 0; c < 4; c++)
+            out[c] = a[c] * s0 + b[c] * s1;
+    }
+
+    void refAngleAxis(const angleAxisInput& in, long double* out)
+    {
+        long double s = sinl(in.angle * 0.5L);
+        out[0] = in.axis.x * s;
+        out[1] = in.axis.y * s;
+        out[2] = in.axis.z * s;
+        out[3] = cosl(in.angle * 0.5L);
+    }
+
+    void store(const quat& q, float* out) { out[0] = q.i; out[1] = q.j; out[2] = q.k; out[3] = q.w; }
+
+    void normalizedQuat(const quat& v, float* out) { store(quat::normalized(v), out); }
+    void normalizedFastQuat(const quat& v, float* out) { store(quat::normalizedFast(v), out); }
+    void slerp(const slerpInput& in, float* out) { store(quat::slerp(in.a, in.b, in.t), out); }
+    void slerpFast(const slerpInput& in, float* out) { store(quat::slerpFast(in.a, in.b, in.t), out); }
+    void angleAxis(const angleAxisInput& in, float* out) { store(quat(in.angle, in.axis), out); }
+    void angleAxisFast(const angleAxisInput& in, float* out) { store(quat::angleAxisFast(in.angle, in.axis), out); }
+
+    void quaternions()
+    {
+        std::vector<inputSet<quat> > lengths(2);
+        lengths[0].name = "random";
+        lengths[1].name = "drifted";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            lengths[0].values.push_back(randomQuat() * uniform(0.1f, 10.0f));
+            lengths[1].values.push_back(randomQuat() * (1.0f + uniform(-1e-3f, 1e-3f)));
+        }
+
+        std::vector<variant<quat, 4> > normalizeVariants = { { "quat::normalized", normalizedQuat }, { "quat::normalizedFast", normalizedFastQuat } };
+        evaluate<quat, 4>("quat normalize", lengths, refNormalizeQuat, normalizeVariants, false);
+
+        std::vector<inputSet<slerpInput> > pairs(4);
+        pairs[0].name = "random";
+        pairs[1].name = "close";
+        pairs[2].name = "opposite";
+        pairs[3].name = "endpoints";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            slerpInput in;
+            in.a = randomQuat();
+            in.b = randomQuat();
+            in.t = uniform(0.0f, 1.0f);
+            pairs[0].values.push_back(in);
+
+            in.b = in.a * quat(logUniform(1e-5f, 1e-2f), randomDirection().normalized());
+            pairs[1].values.push_back(in);
+
+            // almost the same rotation with the opposite sign, and almost half a turn apart
+            in.b = -(in.a * quat(logUniform(1e-5f, 1e-2f), randomDirection().normalized()));
+            in.b.w = -in.b.w;
+            if(n & 1)
+                in.b = in.a * quat(3.14159265f - logUniform(1e-5f, 1e-2f), randomDirection().normalized());
+            pairs[2].values.push_back(in);
+
+            in.b = randomQuat();
+            in.t = n & 1 ? 1.0f - logUniform(1e-7f, 1e-3f) : logUniform(1e-7f, 1e-3f);
+            pairs[3].values.push_back(in);
+        }
+
+        std::vector<variant<slerpInput, 4> > slerpVariants = { { "quat::slerp", slerp }, { "quat::slerpFast", slerpFast } };
+        evaluate<slerpInput, 4>("quat slerp", pairs, refSlerp, slerpVariants, true);
+
+        std::vector<inputSet<angleAxisInput> > rotations(3);
+        rotations[0].name = "random";
+        rotations[1].name = "small";
+        rotations[2].name = "many turns";
+        for(size_t n = 0; n < SAMPLES; n++)
+        {
+            angleAxisInput in;
+            in.axis = randomDirection().normalized();
+            in.angle = uniform(-6.2831853f, 6.2831853f);
+            rotations[0].values.push_back(in);
+            in.angle = logUniform(1e-20f, 1e-2f);
+            rotations[1].values.push_back(in);
+            in.angle = uniform(-1000.0f, 1000.0f);
+            rotations[2].values.push_back(in);
+        }
+
+        std::vector<variant<angleAxisInput, 4> > angleAxisVariants = { { "quat(angle, axis)", angleAxis }, { "quat::angleAxisFast", angleAxisFast } };
+        evaluate<angleAxisInput, 4>("quat angle axis", rotations, refAngleAxis, angleAxisVariants, false);
+    }
+
+    void writeJson(const char* path)
+    {
+        FILE* file = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+        if(file == nullptr)
+        {
+            fprintf(stderr, "could not open %s\n", path);
+            return;
+        }
+
+        fprintf(file, "{\n  \"accuracy\": [\n");
+        for(size_t n = 0; n < g_rows.size(); n++)
+        {
+            const row& r = g_rows[n];
+            fprintf(file, "    {\"function\": \"%s\", \"variant\": \"%s\", \"inputs\": \"%s\", \"max_ulp\": %.3f, \"mean_ulp\": %.4f, \"max_abs\": %.6g, \"ns_per_op\": %.4f}%s\n",
+                    r.function.c_str(), r.variant.c_str(), r.inputs.c_str(), r.maxUlp, r.meanUlp, r.maxAbs, r.nsPerOp,
+                    n + 1 < g_rows.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+
+        if(file != stdout)
+            fclose(file);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char* json = nullptr;
+    for(int n = 1; n < argc; n++)
+    {
+        if(strcmp(argv[n], "--json") == 0 && n + 1 < argc)
+            json = argv[++n];
+        else if(strcmp(argv[n], "--quick") == 0)
+            g_minTime = 0.01;
+        else
+        {
+            printf("usage: %s [--json file|-] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-22s %-26s %-14s %12s %12s %12s %10s\n", "function", "variant", "inputs", "max ulp", "mean ulp", "max abs", "ns/op");
+    trig();
+    vectors();
+    quaternions();
+
+    if(json)
+        writeJson(json);
+
+    return 0;
+}
@@ -0,0 +1,814 @@
+#include "m3d/m3d.h"
+#include "timer.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <memory>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/** ------------- m3d benchmarks
+    latency   dependent chain of calls, each call waits on the last result
+    throughput independent calls over a small array that stays in L1
+    batch     batch kernels over working sets from L1 to DRAM
+
+    usage: m3dbench [--filter text] [--json file] [--quick] */
+
+using namespace m3d;
+using bench::keep;
+
+namespace
+{
+    struct result
+    {
+        std::string name;
+        std::string kind;
+        size_t bytes;
+        size_t elements;
+        double nsPerOp;
+        double elementsPerSec;
+    };
+
+    struct options
+    {
+        const char* filter = nullptr;
+        const char* json = nullptr;
+        double minTime = 0.1;
+        unsigned repeats = 3;
+        bool quick = false;
+    };
+
+    options g_options;
+    std::vector<result> g_results;
+
+    bool selected(const std::string& name)
+    {
+        return g_options.filter == nullptr || name.find(g_options.filter) != std::string::npos;
+    }
+
+    double measure(const std::function<void(size_t)>& fn)
+    {
+        return bench::measure(fn, g_options.minTime, g_options.repeats);
+    }
+
+    void report(const std::string& name, const char* kind, const size_t& bytes, const size_t& elements, const double& nsPerOp)
+    {
+        result r;
+        r.name = name;
+        r.kind = kind;
+        r.bytes = bytes;
+        r.elements = elements;
+        r.nsPerOp = nsPerOp;
+        r.elementsPerSec = nsPerOp > 0.0 ? 1e9 / nsPerOp : 0.0;
+        g_results.push_back(r);
+
+        printf("%-40s %-10s %10zu B %12.3f ns/op %14.0f elem/s\n", name.c_str(), kind, bytes, nsPerOp, r.elementsPerSec);
+        fflush(stdout);
+    }
+
+    ///////////////////////////////////////
+    //              SCALAR               //
+    ///////////////////////////////////////
+
+    // op maps a value to a value of the same type so calls can be chained for latency
+    template <typename T> void scalar(const std::string& name, const T& seed, T (*op)(const T&))
+    {
+        if(!selected(name))
+            return;
+
+        report(name, "latency", sizeof(T), 1, measure([&](size_t iterations)
+        {
+            T v = seed;
+            for(size_t n = 0; n < iterations; n++)
+            {
+                v = op(v);
+                keep(v);
+            }
+        }));
+
+        const size_t COUNT = 256;
+        std::vector<T> in(COUNT, seed);
+        std::vector<T> out(COUNT, seed);
+        report(name, "throughput", sizeof(T) * COUNT, COUNT, measure([&](size_t iterations)
+        {
+            for(size_t n = 0; n < iterations; n++)
+            {
+                for(size_t i = 0; i < COUNT; i++)
+                    out[i] = op(in[i]);
+                keep(out[0]);
+            }
+        }) / (double)COUNT);
+    }
+
+    const vec2 V2(0.3f, -0.7f);
+    const vec3 V3(0.3f, -0.7f, 0.2f);
+    const vec4 V4(0.3f, -0.7f, 0.2f, 1.0f);
+    const quat Q(0.7f, vec3(0.267f, 0.534f, 0.802f));
+    const mat3x3 M3 = mat3x3::initRotationFromQuat(Q);
+    const mat4x4 M4 = mat4x4::fromMat3x3(M3);
+
+    // the scalar returning ops feed their result back into a component
+    float f_clamp(const float& v) { return clamp(v + 0.1f, -1.0f, 1.0f); }
+    float f_lerp(const float& v) { return lerp(v, 0.5f, 0.25f); }
+    float f_sinf(const float& v) { return sinf(v + 1.0f); }
+    float f_fastSin(const float& v) { return fastSin(v + 1.0f); }
+    float f_acosf(const float& v) { return acosf(v * 0.5f); }
+    float f_fastAcos(const float& v) { return fastAcos(v * 0.5f); }
+    float f_rsqrt(const float& v) { return 1.0f / sqrtf(v + 1.0f); }
+    float f_fastRsqrt(const float& v) { return fastRsqrt(v + 1.0f); }
+
+    vec2 v2_add(const vec2& v) { return v + V2; }
+    vec2 v2_dot(const vec2& v) { return vec2(vec2::dot(v, V2), v.y); }
+    vec2 v2_length(const vec2& v) { return vec2(vec2::length(v), v.y); }
+    vec2 v2_normalized(const vec2& v) { return vec2::normalized(v); }
+    vec2 v2_lerp(const vec2& v) { return vec2::lerp(v, V2, 0.25f); }
+    vec2 v2_slerp(const vec2& v) { return vec2::slerp(v, V2, 0.25f); }
+
+    vec3 v3_add(const vec3& v) { return v + V3; }
+    vec3 v3_mul(const vec3& v) { return v * -1.0f; }
+    vec3 v3_dot(const vec3& v) { return vec3(vec3::dot(v, V3), v.y, v.z); }
+    vec3 v3_cross(const vec3& v) { return vec3::cross(v, V3); }
+    vec3 v3_length(const vec3& v) { return vec3(vec3::length(v), v.y, v.z); }
+    vec3 v3_distance(const vec3& v) { return vec3(vec3::distance(v, V3), v.y, v.z); }
+    vec3 v3_normalized(const vec3& v) { return vec3::normalized(v); }
+    vec3 v3_normalizedFast(const vec3& v) { return vec3::normalizedFast(v); }
+    vec3 v3_angle(const vec3& v) { return vec3(vec3::angle(v, V3), v.y, v.z); }
+    vec3 v3_reflect(const vec3& v) { return vec3::reflect(v, V3); }
+    vec3 v3_lerp(const vec3& v) { return vec3::lerp(v, V3, 0.25f); }
+    vec3 v3_slerp(const vec3& v) { return vec3::slerp(v, V3, 0.25f); }
+    vec3 v3_minmax(const vec3& v) { return vec3::min(vec3::max(v, -V3), V3); }
+
+    vec4 v4_add(const vec4& v) { return v + V4; }
+    vec4 v4_mul(const vec4& v) { return v * -1.0f; }
+
+    quat q_mul(const quat& v) { return v * Q; }
+    quat q_normalized(const quat& v) { return quat::normalized(v); }
+    quat q_normalizedFast(const quat& v) { return quat::normalizedFast(v); }
+    quat q_slerp(const quat& v) { return quat::slerp(v, Q, 0.25f); }
+    quat q_slerpFast(const quat& v) { return quat::slerpFast(v, Q, 0.25f); }
+    quat q_angleAxisFast(const quat& v) { return quat::angleAxisFast(v.w, V3); }
+    quat q_angleAxis(const quat& v) { return quat(v.w, V3); }
+    quat q_fromMat4x4(const quat& v) { return quat::fromMat4x4(mat4x4(1.0f).rotate(v)); }
+    vec3 q_rotateVec3(const vec3& v) { return quat::rotateVec3(Q, v); }
+    vec3 q_euler(const vec3& v) { return quat::euler(quat(v.x, v.y, v.z, 0.5f)); }
+
+    mat3x3 m3_mul(const mat3x3& v) { return v * M3; }
+    vec3 m3_mulVec3(const vec3& v) { return M3 * v; }
+    mat3x3 m3_fromQuat(const mat3x3& v) { return mat3x3::initRotationFromQuat(quat(v.at(0, 0), v.at(0, 1), v.at(0, 2), 0.5f)); }
+
+    mat4x4 m4_mul(const mat4x4& v) { return v * M4; }
+    vec4 m4_mulVec4(const vec4& v) { return M4 * v; }
+    mat4x4 m4_lookat(const mat4x4& v) { return mat4x4::lookat(vec3(v.at(0, 0), v.at(0, 1), 1.0f), vec3(0.0f), vec3::up()); }
+    mat4x4 m4_perspective(const mat4x4& v) { return mat4x4::initPerspective(16.0f, 9.0f, 1.0f + v.at(3, 2) * 0.001f, 0.1f, 100.0f); }
+    mat4x4 m4_rotate(const mat4x4& v) { mat4x4 res = v; return res.rotate(Q); }
+    mat4x4 m4_inverse(const mat4x4& v) { return mat4x4::inverse(v); }
+    mat4x4 m4_inverseHomogeneous(const mat4x4& v) { return mat4x4::inverseHomogeneous(v); }
+    mat4x4 m4_inversePerspective(const mat4x4& v) { return mat4x4::inversePerspective(v); }
+
+    transform t_toMat4x4(const transform& v) { mat4x4 m = transform::toMat4x4(v); return transform(vec3(m.at(0, 3), v.position.y, v.position.z), v.rotation, v.scale); }
+    transform t_lerp(const transform& v) { return transform::lerp(v, transform(V3, Q), 0.25f); }
+
+    uint32_t quantizeQuat32(const uint32_t& v) { return quantize::packQuat32(quantize::unpackQuat32(v)); }
+    uint32_t packOctahedral(const uint32_t& v) { return packed::packOctahedral(packed::unpackOctahedral(v)); }
+    float halfRoundTrip(const float& v) { return packed::halfToFloat(packed::floatToHalf(v + 0.5f)); }
+
+    void scalarBenchmarks()
+    {
+        scalar<float>("math1D::clamp", 0.5f, f_clamp);
+        scalar<float>("math1D::lerp", 0.5f, f_lerp);
+        scalar<float>("sinf", 0.5f, f_sinf);
+        scalar<float>("math1D::fastSin", 0.5f, f_fastSin);
+        scalar<float>("acosf", 0.5f, f_acosf);
+        scalar<float>("math1D::fastAcos", 0.5f, f_fastAcos);
+        scalar<float>("1 / sqrtf", 0.5f, f_rsqrt);
+        scalar<float>("math1D::fastRsqrt", 0.5f, f_fastRsqrt);
+
+        scalar<vec2>("vec2::add", V2, v2_add);
+        scalar<vec2>("vec2::dot", V2, v2_dot);
+        scalar<vec2>("vec2::length", V2, v2_length);
+        scalar<vec2>("vec2::normalized", V2, v2_normalized);
+        scalar<vec2>("vec2::lerp", V2, v2_lerp);
+        scalar<vec2>("vec2::slerp", vec2(1.0f, 0.0f), v2_slerp);
+
+        scalar<vec3>("vec3::add", V3, v3_add);
+        scalar<vec3>("vec3::mul", V3, v3_mul);
+        scalar<vec3>("vec3::dot", V3, v3_dot);
+        scalar<vec3>("vec3::cross", V3, v3_cross);
+        scalar<vec3>("vec3::length", V3, v3_length);
+        scalar<vec3>("vec3::distance", V3, v3_distance);
+        scalar<vec3>("vec3::normalized", V3, v3_normalized);
+        scalar<vec3>("vec3::normalizedFast", V3, v3_normalizedFast);
+        scalar<vec3>("vec3::angle", V3, v3_angle);
+        scalar<vec3>("vec3::reflect", V3, v3_reflect);
+        scalar<vec3>("vec3::lerp", V3, v3_lerp);
+        scalar<vec3>("vec3::slerp", vec3::up(), v3_slerp);
+        scalar<vec3>("vec3::min/max", V3, v3_minmax);
+
+        scalar<vec4>("vec4::add", V4, v4_add);
+        scalar<vec4>("vec4::mul", V4, v4_mul);
+
+        scalar<quat>("quat::mul", Q, q_mul);
+        scalar<quat>("quat::normalized", Q, q_normalized);
+        scalar<quat>("quat::normalizedFast", Q, q_normalizedFast);
+        scalar<quat>("quat::slerp", quat(), q_slerp);
+        scalar<quat>("quat::slerpFast", quat(), q_slerpFast);
+        scalar<quat>("quat::quat(angle, axis)", Q, q_angleAxis);
+        scalar<quat>("quat::angleAxisFast", Q, q_angleAxisFast);
+        scalar<quat>("quat::fromMat4x4", Q, q_fromMat4x4);
+        scalar<vec3>("quat::rotateVec3", V3, q_rotateVec3);
+        scalar<vec3>("quat::euler", V3, q_euler);
+
+        scalar<mat3x3>("mat3x3::mul", M3, m3_mul);
+        scalar<vec3>("mat3x3::mul(vec3)", V3, m3_mulVec3);
+        scalar<mat3x3>("mat3x3::initRotationFromQuat", M3, m3_fromQuat);
+
+        scalar<mat4x4>("mat4x4::mul", M4, m4_mul);
+        scalar<vec4>("mat4x4::mul(vec4)", V4, m4_mulVec4);
+        scalar<mat4x4>("mat4x4::lookat", M4, m4_lookat);
+        scalar<mat4x4>("mat4x4::initPerspective", M4, m4_perspective);
+        scalar<mat4x4>("mat4x4::rotate", M4, m4_rotate);
+        scalar<mat4x4>("mat4x4::inverse", M4, m4_inverse);
+        scalar<mat4x4>("mat4x4::inverseHomogeneous", M4, m4_inverseHomogeneous);
+        scalar<mat4x4>("mat4x4::inversePerspective", mat4x4::initPerspectiveInfiniteReverseZ(16.0f, 9.0f, 1.0f, 0.1f), m4_inversePerspective);
+
+        scalar<transform>("transform::toMat4x4", transform(V3, Q), t_toMat4x4);
+        scalar<transform>("transform::lerp", transform(), t_lerp);
+
+        scalar<uint32_t>("quantize::quat32 round trip", quantize::packQuat32(Q), quantizeQuat32);
+        scalar<uint32_t>("packed::octahedral round trip", packed::packOctahedral(V3.normalized()), packOctahedral);
+        scalar<float>("packed::half round trip", 0.5f, halfRoundTrip);
+    }
+
+    ///////////////////////////////////////
+    //              BATCH                //
+    ///////////////////////////////////////
+
+    // working set sizes from L1 to DRAM
+    std::vector<size_t> batchSizes()
+    {
+        std::vector<size_t> res;
+        res.push_back(16 << 10);
+        res.push_back(256 << 10);
+        res.push_back(4 << 20);
+        if(!g_options.quick)
+            res.push_back(64 << 20);
+        return res;
+    }
+
+    float random01()
+    {
+        return (float)rand() / (float)RAND_MAX;
+    }
+
+    vec3 randomVec3()
+    {
+        return vec3(random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f);
+    }
+
+    quat randomQuat()
+    {
+        return quat(random01() * 6.2831853f, randomVec3().normalized());
+    }
+
+    // kernel(count) processes count elements, bytesPerElement counts input and output
+    void batch(const std::string& name, const size_t& bytesPerElement,
+               const std::function<void(size_t)>& setup, const std::function<void(size_t)>& kernel)
+    {
+        if(!selected(name))
+            return;
+
+        for(size_t bytes : batchSizes())
+        {
+            size_t count = std::max<size_t>(bytes / bytesPerElement, 1);
+            setup(count);
+            report(name, "batch", count * bytesPerElement, count, measure([&](size_t iterations)
+            {
+                for(size_t n = 0; n < iterations; n++)
+                    kernel(count);
+            }) / (double)count);
+        }
+        setup(0);
+    }
+
+    void batchBenchmarks()
+    {
+        std::vector<quat> quats;
+        std::vector<vec3> vecs;
+        std::vector<uint32_t> u32a, u32b;
+        std::vector<uint64_t> u64;
+        std::vector<uint16_t> u16;
+        std::vector<int8_t> s8;
+
+        const vec3 MIN(-1000.0f), MAX(1000.0f);
+
+        std::function<void(size_t)> quatSetup = [&](size_t count)
+        {
+            quats.resize(count);
+            for(quat& q : quats) q = randomQuat();
+            u32a.assign(count, 0);
+            u64.assign(count, 0);
+            quantize::packQuats32(quats.data(), u32a.data(), (unsigned)count);
+            quantize::packQuats48(quats.data(), u64.data(), (unsigned)count);
+        };
+        std::function<void(size_t)> vecSetup = [&](size_t count)
+        {
+            vecs.resize(count);
+            for(vec3& v : vecs) v = randomVec3();
+            u32a.assign(count, 0);
+            u64.assign(count, 0);
+            u16.assign(count * 3, 0);
+            s8.assign(count * 3, 0);
+            packed::packOctahedral(vecs.data(), u32a.data(), (unsigned)count);
+        };
+
+        batch("quantize::packQuats29", sizeof(quat) + 4, quatSetup, [&](size_t count) { quantize::packQuats29(quats.data(), u32a.data(), (unsigned)count); });
+        batch("quantize::packQuats32", sizeof(quat) + 4, quatSetup, [&](size_t count) { quantize::packQuats32(quats.data(), u32a.data(), (unsigned)count); });
+        batch("quantize::unpackQuats32", sizeof(quat) + 4, quatSetup, [&](size_t count) { quantize::unpackQuats32(u32a.data(), quats.data(), (unsigned)count); });
+        batch("quantize::packQuats48", sizeof(quat) + 8, quatSetup, [&](size_t count) { quantize::packQuats48(quats.data(), u64.data(), (unsigned)count); });
+        batch("quantize::unpackQuats48", sizeof(quat) + 8, quatSetup, [&](size_t count) { quantize::unpackQuats48(u64.data(), quats.data(), (unsigned)count); });
+        batch("quantize::packVec3s", sizeof(vec3) + 8, vecSetup, [&](size_t count) { quantize::packVec3s(vecs.data(), u64.data(), (unsigned)count, MIN, MAX, 21); });
+        batch("quantize::unpackVec3s", sizeof(vec3) + 8, vecSetup, [&](size_t count) { quantize::unpackVec3s(u64.data(), vecs.data(), (unsigned)count, MIN, MAX, 21); });
+
+        batch("quantize::delta", 12, [&](size_t count)
+        {
+            u32a.assign(count, 1);
+            u32b.assign(count, 3);
+        }, [&](size_t count) { quantize::delta(u32a.data(), u32b.data(), u32a.data(), (unsigned)count); });
+
+        batch("packed::packOctahedral", sizeof(vec3) + 4, vecSetup, [&](size_t count) { packed::packOctahedral(vecs.data(), u32a.data(), (unsigned)count); });
+        batch("packed::unpackOctahedral", sizeof(vec3) + 4, vecSetup, [&](size_t count) { packed::unpackOctahedral(u32a.data(), vecs.data(), (unsigned)count); });
+        batch("packed::packHalf(vec3)", sizeof(vec3) + 6, vecSetup, [&](size_t count) { packed::packHalf(vecs.data(), u16.data(), (unsigned)count); });
+        batch("packed::unpackHalf(vec3)", sizeof(vec3) + 6, vecSetup, [&](size_t count) { packed::unpackHalf(u16.data(), vecs.data(), (unsigned)count); });
+        batch("packed::packSnorm8(vec3)", sizeof(vec3) + 3, vecSetup, [&](size_t count) { packed::packSnorm8(vecs.data(), s8.data(), (unsigned)count); });
+        batch("packed::unpackSnorm8(vec3)", sizeof(vec3) + 3, vecSetup, [&](size_t count) { packed::unpackSnorm8(s8.data(), vecs.data(), (unsigned)count); });
+        batch("packed::packSnorm16(vec3)", sizeof(vec3) + 6, vecSetup, [&](size_t count) { packed::packSnorm16(vecs.data(), (int16_t*)u16.data(), (unsigned)count); });
+
+        std::vector<mat4x4> models, mvps;
+        std::vector<affine> affines;
+        std::vector<mat3x3> normals;
+        std::vector<transform> decomposed;
+        const mat4x4 viewProj = mat4x4::initPerspective(16.0f, 9.0f, 1.0f, 0.1f, 100.0f) * mat4x4::lookat(vec3(0.0f, 2.0f, 10.0f), vec3(0.0f), vec3::up());
+
+        std::function<void(size_t)> modelSetup = [&](size_t count)
+        {
+            models.resize(count);
+            decomposed.resize(count);
+            affines.resize(count);
+            mvps.resize(count);
+            normals.resize(count);
+            for(size_t n = 0; n < count; n++)
+            {
+                models[n] = transform(randomVec3(), randomQuat(), vec3(1.0f + random01())).toMat4x4();
+                affines[n] = affine::fromMat4x4(models[n]);
+            }
+        };
+
+        batch("instancing::mvp(mat4x4)", sizeof(mat4x4) * 2, modelSetup, [&](size_t count) { instancing::mvp(viewProj, models.data(), mvps.data(), nullptr, (unsigned)count); });
+        batch("instancing::mvp(mat4x4,normals)", sizeof(mat4x4) * 2 + sizeof(mat3x3), modelSetup, [&](size_t count) { instancing::mvp(viewProj, models.data(), mvps.data(), normals.data(), (unsigned)count); });
+        batch("instancing::mvp(affine)", sizeof(affine) + sizeof(mat4x4), modelSetup, [&](size_t count) { instancing::mvp(viewProj, affines.data(), mvps.data(), nullptr, (unsigned)count); });
+        batch("instancing::mvpParallel(affine)", sizeof(affine) + sizeof(mat4x4), modelSetup, [&](size_t count) { instancing::mvpParallel(viewProj, affines.data(), mvps.data(), nullptr, (unsigned)count); });
+
+        std::function<void(size_t)> shearSetup = [&](size_t count)
+        {
+            modelSetup(count);
+            for(mat4x4& m : models) m.at(0, 1) += 0.25f;
+        };
+
+        batch("transform::decompose", sizeof(mat4x4) + sizeof(transform), modelSetup, [&](size_t count) { transform::decompose(models.data(), decomposed.data(), (unsigned)count); });
+        batch("transform::decompose(shear)", sizeof(mat4x4) + sizeof(transform), shearSetup, [&](size_t count) { transform::decompose(models.data(), decomposed.data(), (unsigned)count); });
+
+        std::vector<dvec3> worldPositions;
+        std::vector<vec3> worldHi, worldLo, rebased;
+        const dvec3 worldOrigin(250000.125, 1000.5, -180000.75);
+
+        std::function<void(size_t)> worldSetup = [&](size_t count)
+        {
+            worldPositions.resize(count);
+            for(dvec3& v : worldPositions) v = worldOrigin + dvec3(randomVec3());
+            worldHi.resize(count);
+            worldLo.resize(count);
+            rebased.resize(count);
+            rebase::split(worldPositions.data(), worldHi.data(), worldLo.data(), (unsigned)count);
+        };
+
+        batch("rebase::relative(split)", sizeof(vec3) * 3, worldSetup, [&](size_t count) { rebase::relative(worldOrigin, worldHi.data(), worldLo.data(), rebased.data(), (unsigned)count); });
+        batch("rebase::relative(dvec3)", sizeof(dvec3) + sizeof(vec3), worldSetup, [&](size_t count) { rebase::relative(worldOrigin, worldPositions.data(), rebased.data(), (unsigned)count); });
+
+        rigidBodies bodies;
+        std::function<void(size_t)> bodySetup = [&](size_t count)
+        {
+            bodies.clear();
+            for(size_t n = 0; n < count; n++) bodies.add(randomVec3(), randomQuat(), randomVec3(), randomVec3());
+        };
+
+        batch("rigidBodies::integrate", 2 * 13 * sizeof(float) + 6 * sizeof(float), bodySetup, [&](size_t count) { bodies.integrate(1.0f / 60.0f, vec3(0.0f, -9.81f, 0.0f)); });
+
+        particles cloud;
+        const vec4 ground[2] = { vec4(0.0f, 1.0f, 0.0f, 1.0f), vec4(1.0f, 0.0f, 0.0f, 1.0f) };
+        const particleForces forces = { { 0.0f, -9.81f, 0.0f }, 0.1f, ground, 2, 0.5f };
+
+        std::function<void(size_t)> particleSetup = [&](size_t count)
+        {
+            cloud.clear();
+            for(size_t n = 0; n < count; n++) cloud.add(randomVec3(), randomVec3(), random01());
+        };
+
+        batch("particles::update", 2 * 7 * sizeof(float), particleSetup, [&](size_t count) { cloud.update(1.0f / 60.0f, forces); });
+        // half of the particles die, the kernel also restores them so it includes refilling the arrays
+        std::vector<float> lifetimes;
+        batch("particles::compactParallel", 2 * 7 * sizeof(float), [&](size_t count)
+        {
+            particleSetup(count);
+            lifetimes = cloud.life;
+            for(float& v : lifetimes) v -= 0.5f;
+        }, [&](size_t count)
+        {
+            cloud.resize((unsigned)count);
+            cloud.life = lifetimes;
+            cloud.compactParallel();
+        });
+
+        // a jittered grid, about count vertices and two triangles per quad
+        meshNormals surface;
+        std::vector<float> meshData;
+        std::vector<float> meshOut;
+
+        std::function<void(size_t)> meshSetup = [&](size_t count)
+        {
+            unsigned side = 2;
+            while((side + 1) * (side + 1) <= count) side++;
+
+            unsigned vertices = side * side;
+            meshData.resize(vertices * 8);
+            meshOut.resize(vertices * 4);
+            for(unsigned n = 0; n < vertices; n++)
+            {
+                float gx = (float)(n % side), gy = (float)(n / side);
+                meshData[n] = gx;
+                meshData[vertices + n] = random01() * 0.5f;
+                meshData[vertices * 2 + n] = gy;
+                meshData[vertices * 6 + n] = gx / side;
+                meshData[vertices * 7 + n] = gy / side;
+            }
+
+            std::vector<uint32_t> indices;
+            for(unsigned r = 0; r + 1 < side; r++)
+            {
+                for(unsigned c = 0; c + 1 < side; c++)
+                {
+                    uint32_t i = r * side + c;
+                    uint32_t quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+                    indices.insert(indices.end(), quad, quad + 6);
+                }
+            }
+
+            surface.build(indices.data(), (unsigned)indices.size() / 3, vertices);
+            float* data = meshData.data();
+            surface.normals(data, data + vertices, data + vertices * 2, data + vertices * 3, data + vertices * 4, data + vertices * 5, meshNormals::WEIGHT_AREA);
+        };
+
+        std::function<void(size_t)> meshNormalsKernel = [&](size_t count)
+        {
+            unsigned v = surface.vertexCount();
+            float* data = meshData.data();
+            surface.normalsParallel(data, data + v, data + v * 2, data + v * 3, data + v * 4, data + v * 5, meshNormals::WEIGHT_ANGLE);
+        };
+
+        std::function<void(size_t)> meshTangentsKernel = [&](size_t count)
+        {
+            unsigned v = surface.vertexCount();
+            float* data = meshData.data();
+            float* out = meshOut.data();
+            surface.tangentsParallel(data, data + v, data + v * 2, data + v * 3, data + v * 4, data + v * 5,
+                                     data + v * 6, data + v * 7, out, out + v, out + v * 2, out + v * 3);
+        };
+
+        batch("meshNormals::normalsParallel(angle)", 6 * sizeof(float), meshSetup, meshNormalsKernel);
+        batch("meshNormals::tangentsParallel", 12 * sizeof(float), meshSetup, meshTangentsKernel);
+
+        hullBuilder hulls;
+        convexHull hull;
+        std::vector<vec3> hullPoints;
+        std::function<void(size_t)> hullSetup = [&](size_t count)
+        {
+            hullPoints.resize(count);
+            for(vec3& p : hullPoints) p = randomVec3();
+        };
+
+        batch("hullBuilder::build", sizeof(vec3), hullSetup, [&](size_t count) { hulls.build(hullPoints.data(), (unsigned)count, hull); });
+        batch("hullBuilder::build(64 vertices)", sizeof(vec3), hullSetup, [&](size_t count) { hulls.build(hullPoints.data(), (unsigned)count, hull, 64); });
+
+        // pairs near contact that keep their caches between runs, like a narrowphase from one step to the next
+        const convexShape shapes[3] = { convexShape::sphere(0.5f), convexShape::box(vec3(0.5f, 0.3f, 0.4f)), convexShape::capsule(0.25f, 0.4f) };
+        std::vector<gjkPair> pairs;
+        std::vector<gjkResult> contacts;
+        std::vector<gjkCache> contactCaches;
+        std::function<void(size_t)> pairSetup = [&](size_t count)
+        {
+            pairs.resize(count);
+            contacts.resize(count);
+            contactCaches.assign(count, gjkCache());
+            for(size_t n = 0; n < count; n++)
+            {
+                gjkPair& p = pairs[n];
+                p.a = &shapes[n % 3];
+                p.b = &shapes[(n / 3) % 3];
+                p.positionA = randomVec3() * 100.0f;
+                p.rotationA = randomQuat();
+                p.positionB = p.positionA + randomVec3().normalized() * (0.8f + random01() * 0.6f);
+                p.rotationB = randomQuat();
+            }
+        };
+
+        batch("gjk::penetrationParallel(warm)", sizeof(gjkPair) + sizeof(gjkResult) + sizeof(gjkCache), pairSetup,
+              [&](size_t count) { gjk::penetrationParallel(pairs.data(), contacts.data(), contactCaches.data(), (unsigned)count); });
+
+        // points around a fixed bumpy grid, the mesh is built once and only the queries scale
+        std::vector<float> queryData;
+        std::vector<unsigned> queryTriangles;
+        triangleBVH terrain;
+        std::function<void(size_t)> querySetup = [&](size_t count)
+        {
+            queryData.resize(count * 7);
+            queryTriangles.resize(count);
+            for(size_t n = 0; n < count; n++)
+            {
+                queryData[n] = random01() * 64.0f;
+                queryData[count + n] = random01() * 4.0f - 2.0f;
+                queryData[count * 2 + n] = random01() * 64.0f;
+            }
+
+            if(terrain.triangleCount() > 0)
+                return;
+
+            const unsigned side = 65;
+            std::vector<float> grid(side * side * 3);
+            std::vector<uint32_t> indices;
+            for(unsigned n = 0; n < side * side; n++)
+            {
+                grid[n] = (float)(n % side);
+                grid[side * side + n] = random01();
+                grid[side * side * 2 + n] = (float)(n / side);
+            }
+            for(unsigned r = 0; r + 1 < side; r++)
+            {
+                for(unsigned c = 0; c + 1 < side; c++)
+                {
+                    uint32_t i = r * side + c;
+                    uint32_t quad[6] = { i, i + side, i + 1, i + 1, i + side, i + side + 1 };
+                    indices.insert(indices.end(), quad, quad + 6);
+                }
+            }
+            terrain.build(grid.data(), grid.data() + side * side, grid.data() + side * side * 2, indices.data(), (unsigned)indices.size() / 3);
+        };
+
+        auto queryStreams = [&](size_t count)
+        {
+            float* data = queryData.data();
+            return std::make_pair(pointStreams{ data, data + count, data + count * 2 },
+                                  closestStreams{ data + count * 3, data + count * 4, data + count * 5, data + count * 6 });
+        };
+
+        batch("closestPoint::triangle(streams)", 7 * sizeof(float), querySetup, [&](size_t count)
+        {
+            auto s = queryStreams(count);
+            closestPoint::triangle(s.first, (unsigned)count, vec3(0.0f, 0.0f, 0.0f), vec3(64.0f, 1.0f, 0.0f), vec3(0.0f, -1.0f, 64.0f), s.second);
+        });
+        batch("triangleBVH::closestParallel", 7 * sizeof(float) + sizeof(unsigned), querySetup, [&](size_t count)
+        {
+            auto s = queryStreams(count);
+            terrain.closestParallel(s.first, (unsigned)count, s.second, queryTriangles.data());
+        });
+
+        // a fixed catmull-rom path, the batch size is the number of points taken along it
+        spline3 path;
+        std::vector<vec3> pathPoints;
+        std::vector<float> pathParameters;
+        std::function<void(size_t)> pathSetup = [&](size_t count)
+        {
+            if(path.segmentCount() == 0)
+            {
+                std::vector<vec3> controls(64);
+                for(vec3& v : controls) v = randomVec3() * 10.0f;
+                path.build(controls.data(), (unsigned)controls.size(), spline3::CATMULL_ROM);
+            }
+
+            pathPoints.resize(count);
+            pathParameters.resize(count);
+            for(float& t : pathParameters) t = random01() * path.segmentCount();
+        };
+
+        batch("spline::evaluate", sizeof(float) + sizeof(vec3), pathSetup, [&](size_t count) { path.evaluate(pathParameters.data(), (unsigned)count, pathPoints.data()); });
+        batch("spline::evaluateUniform", sizeof(vec3), pathSetup, [&](size_t count) { path.evaluateUniform((unsigned)count, pathPoints.data()); });
+        batch("spline::evaluateUniformDistance", sizeof(vec3), pathSetup, [&](size_t count) { path.evaluateUniformDistance((unsigned)count, pathPoints.data()); });
+
+        // one track of eight keys per element, each evaluated at its own time
+        quatSpline tracks;
+        std::vector<float> trackTimes;
+        std::vector<quat> trackOut;
+        std::function<void(size_t)> trackSetup = [&](size_t count)
+        {
+            tracks.clear();
+            trackTimes.resize(count);
+            trackOut.resize(count);
+
+            float times[8];
+            quat keys[8];
+            for(size_t n = 0; n < count; n++)
+            {
+                for(unsigned k = 0; k < 8; k++)
+                {
+                    times[k] = (float)k;
+                    keys[k] = randomQuat();
+                }
+                tracks.addTrack(times, keys, 8);
+                trackTimes[n] = random01() * 7.0f;
+            }
+        };
+
+        batch("quatSpline::evaluate", sizeof(float) + sizeof(quat), trackSetup, [&](size_t) { tracks.evaluate(trackTimes.data(), trackOut.data()); });
+        batch("quatSpline::evaluateParallel", sizeof(float) + sizeof(quat), trackSetup, [&](size_t) { tracks.evaluateParallel(trackTimes.data(), trackOut.data()); });
+
+        // sample positions as three streams, value and gradient out
+        std::vector<float> noiseData;
+        std::function<void(size_t)> noiseSetup = [&](size_t count)
+        {
+            noiseData.resize(count * 7);
+            for(size_t n = 0; n < count * 3; n++) noiseData[n] = random01() * 256.0f;
+        };
+
+        auto noiseIn = [&](size_t count) { float* d = noiseData.data(); return noiseStreams{ d, d + count, d + count * 2, nullptr }; };
+        auto noiseOut = [&](size_t count, bool gradient)
+        {
+            float* d = noiseData.data() + count * 3;
+            return gradient ? noiseOutput{ d, d + count, d + count * 2, d + count * 3, nullptr } : noiseOutput{ d, nullptr, nullptr, nullptr, nullptr };
+        };
+
+        batch("noise::evaluate(perlin 3d)", 4 * sizeof(float), noiseSetup, [&](size_t count) { noise::evaluate(noise::PERLIN, 3, noiseIn(count), (unsigned)count, noiseOut(count, false)); });
+        batch("noise::evaluate(simplex 3d)", 4 * sizeof(float), noiseSetup, [&](size_t count) { noise::evaluate(noise::SIMPLEX, 3, noiseIn(count), (unsigned)count, noiseOut(count, false)); });
+        batch("noise::evaluate(simplex 3d, gradient)", 7 * sizeof(float), noiseSetup, [&](size_t count) { noise::evaluate(noise::SIMPLEX, 3, noiseIn(count), (unsigned)count, noiseOut(count, true)); });
+        batch("noise::gridParallel(simplex 2d, 4 octaves)", sizeof(float), noiseSetup, [&](size_t count)
+        {
+            noise::gridParallel(noise::SIMPLEX, vec2(0.0f, 0.0f), vec2(0.01f, 0.01f), 256, (unsigned)count / 256, noiseOut(count, false), fbmSettings(4));
+        });
+
+        std::vector<float> randomData;
+        std::function<void(size_t)> randomSetup = [&](size_t count) { randomData.resize(count * 4); };
+        auto randomOut = [&](size_t count) { float* d = randomData.data(); return randomStreams{ d, d + count, d + count * 2, d + count * 3 }; };
+        const philox generator(0x853c49e6748fea9bull);
+
+        batch("philox::generate(uniform)", sizeof(float), randomSetup, [&](size_t count) { generator.generate(philox::UNIFORM, randomOut(count), (unsigned)count); });
+        batch("philox::generate(unit vector)", 3 * sizeof(float), randomSetup, [&](size_t count) { generator.generate(philox::UNIT_VECTOR, randomOut(count), (unsigned)count); });
+        batch("philox::generate(rotation)", 4 * sizeof(float), randomSetup, [&](size_t count) { generator.generate(philox::ROTATION, randomOut(count), (unsigned)count); });
+        batch("philox::generateParallel(cosine hemisphere)", 3 * sizeof(float), randomSetup, [&](size_t count)
+        {
+            generator.generateParallel(philox::COSINE_HEMISPHERE, randomOut(count), (unsigned)count);
+        });
+
+        std::unique_ptr<transformStore> store;
+        std::vector<transform> storeOut;
+        std::vector<mat4x4> storeMatrices;
+        std::function<void(size_t)> storeSetup = [&](size_t count)
+        {
+            store.reset(new transformStore((unsigned)count));
+            for(unsigned frame = 0; frame < 2; frame++)
+            {
+                transform* t = store->write();
+                for(size_t n = 0; n < count; n++) t[n] = transform(randomVec3(), randomQuat(), vec3(1.0f, 1.0f, 1.0f));
+                store->publish(frame);
+                store->acquire();
+            }
+            storeOut.resize(count);
+            storeMatrices.resize(count);
+        };
+
+        batch("transformStore::interpolate(transform)", 3 * sizeof(transform), storeSetup, [&](size_t) { store->interpolate(0.25f, storeOut.data()); });
+        batch("transformStore::interpolateParallel(mat4x4)", 2 * sizeof(transform) + sizeof(mat4x4), storeSetup, [&](size_t)
+        {
+            store->interpolateParallel(0.25f, storeMatrices.data());
+        });
+
+        std::vector<float> spriteData;
+        std::vector<vec2> corners;
+        spriteStreams spriteIn;
+
+        std::function<void(size_t)> spriteSetup = [&](size_t count)
+        {
+            spriteData.resize(count * 7);
+            for(float& v : spriteData) v = random01() * 64.0f;
+            corners.resize(count * 4);
+            float* d = spriteData.data();
+            spriteIn = { d, d + count, d + count * 2, d + count * 3, d + count * 4, d + count * 5, d + count * 6 };
+        };
+
+        batch("sprites::quads", 7 * sizeof(float) + 4 * sizeof(vec2), spriteSetup, [&](size_t count) { sprites::quads(spriteIn, corners.data(), (unsigned)count); });
+
+        std::vector<ray> rays;
+        std::vector<vec2> ndc;
+        const mat4x4 invViewProj = mat4x4::inverse(viewProj);
+
+        std::function<void(size_t)> raySetup = [&](size_t count)
+        {
+            rays.resize(count);
+            ndc.resize(count);
+            for(vec2& v : ndc) v = vec2(random01() * 2.0f - 1.0f, random01() * 2.0f - 1.0f);
+        };
+
+        batch("ray::unproject", sizeof(vec2) + sizeof(ray), raySetup, [&](size_t count) { ray::unproject(invViewProj, ndc.data(), rays.data(), (unsigned)count); });
+        batch("ray::unprojectGrid", sizeof(ray), raySetup, [&](size_t count) { ray::unprojectGrid(invViewProj, 64, (unsigned)count / 64, rays.data()); });
+
+        std::vector<float> gpu;
+        std::function<void(size_t)> uploadSetup = [&](size_t count)
+        {
+            modelSetup(count);
+            gpu.assign(count * 16 + 4, 0.0f);
+        };
+
+        batch("uploadWriter::write(mat4x4[])", sizeof(mat4x4) * 2, uploadSetup, [&](size_t count)
+        {
+            uploadWriter writer(gpu.data(), gpu.size() * sizeof(float), uploadWriter::STD430);
+            writer.write(models.data(), (unsigned)count);
+            writer.flush();
+        });
+        batch("uploadWriter::write(mat3x3[])", sizeof(mat3x3) + 48, uploadSetup, [&](size_t count)
+        {
+            uploadWriter writer(gpu.data(), gpu.size() * sizeof(float), uploadWriter::STD140);
+            writer.write(normals.data(), (unsigned)count);
+            writer.flush();
+        });
+
+    }
+
+    ///////////////////////////////////////
+    //              OUTPUT               //
+    ///////////////////////////////////////
+
+    void writeJson(const char* path)
+    {
+        FILE* file = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+        if(file == nullptr)
+        {
+            fprintf(stderr, "could not open %s\n", path);
+            return;
+        }
+
+        fprintf(file, "{\n  \"context\": {\"compiler\": \"%s\", \"pointer_bits\": %d},\n  \"benchmarks\": [\n",
+#if defined(__clang__)
+                "clang " __clang_version__,
+#elif defined(__GNUC__)
+                "gcc " __VERSION__,
+#elif defined(_MSC_VER)
+                "msvc",
+#else
+                "unknown",
+#endif
+                (int)sizeof(void*) * 8);
+
+        for(size_t n = 0; n < g_results.size(); n++)
+        {
+            const result& r = g_results[n];
+            fprintf(file, "    {\"name\": \"%s\", \"kind\": \"%s\", \"bytes\": %zu, \"elements\": %zu, \"ns_per_op\": %.4f, \"elements_per_sec\": %.1f}%s\n",
+                    r.name.c_str(), r.kind.c_str(), r.bytes, r.elements, r.nsPerOp, r.elementsPerSec, n + 1 < g_results.size() ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+        if(file != stdout)
+            fclose(file);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    for(int n = 1; n < argc; n++)
+    {
+        if(strcmp(argv[n], "--filter") == 0 && n + 1 < argc)
+            g_options.filter = argv[++n];
+        else if(strcmp(argv[n], "--json") == 0 && n + 1 < argc)
+            g_options.json = argv[++n];
+        else if(strcmp(argv[n], "--quick") == 0)
+        {
+            g_options.quick = true;
+            g_options.minTime = 0.02;
+            g_options.repeats = 1;
+        }
+        else
+        {
+            printf("usage: %s [--filter text] [--json file|-] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    srand(1);
+    scalarBenchmarks();
+    batchBenchmarks();
+
+    if(g_options.json)
+        writeJson(g_options.json);
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+/** ------------- shared timing for the bench tools */
+
+namespace bench
+{
+    // stop the compiler from removing the work being measured
+    template <typename T> inline void keep(T& v)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&v) : "memory");
+#else
+        volatile char sink = *(volatile char*)&v;
+        (void)sink;
+#endif
+    }
+
+    // runs fn(iterations) until it takes at least minTime seconds, best of the repeats, returns ns per iteration
+    inline double measure(const std::function<void(size_t)>& fn, const double& minTime, const unsigned& repeats)
+    {
+        typedef std::chrono::steady_clock clock;
+
+        size_t iterations = 1;
+        double best = 1e30;
+        for(unsigned r = 0; r < repeats; r++)
+        {
+            for(;;)
+            {
+                clock::time_point start = clock::now();
+                fn(iterations);
+                double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+                if(seconds >= minTime)
+                {
+                    best = std::min(best, seconds * 1e9 / (double)iterations);
+                    break;
+                }
+
+                double scale = seconds > 0.0 ? minTime / seconds * 1.2 : 10.0;
+                iterations = (size_t)((double)iterations * std::min(std::max(scale, 1.5), 100.0)) + 1;
+            }
+        }
+
+        return best;
+    }
+}
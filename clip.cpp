@@ -0,0 +1,421 @@
+#include "m3d/clip.h"
+#include "m3d/vec3.h"
+#include "m3d/quat.h"
+#include "m3d/transform.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace m3d
+{
+    namespace
+    {
+        const uint32_t MAGIC = 0x43443d4d; // "M3DC"
+        const size_t ALIGNMENT = 16;
+
+        struct fileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t trackCount;
+            float duration;
+        };
+
+        struct fileTrack
+        {
+            uint32_t id;
+            uint32_t type;
+            uint32_t keyCount;
+            uint32_t reserved;
+            uint64_t timesOffset;
+            uint64_t keysOffset;
+        };
+
+        static_assert(sizeof(fileHeader) == 16, "clip header layout");
+        static_assert(sizeof(fileTrack) == 32, "clip track layout");
+        static_assert(sizeof(vec3) == 12 && sizeof(quat) == 16 && sizeof(transform) == 40, "keys are stored with the in memory layout");
+
+        inline size_t align(const size_t& v)
+        {
+            return (v + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        }
+
+        inline size_t keySize(const uint32_t& type)
+        {
+            switch(type)
+            {
+            case clip::TRACK_VEC3: return sizeof(vec3);
+            case clip::TRACK_QUAT: return sizeof(quat);
+            case clip::TRACK_TRANSFORM: return sizeof(transform);
+            default: return 0;
+            }
+        }
+    }
+
+    clip::clip() : m_data(nullptr), m_size(0), m_mapping(nullptr) {};
+
+    clip::~clip()
+    {
+        close();
+    }
+
+    bool clip::load(const void* data, const size_t& size)
+    {
+        close();
+
+        const uint8_t* bytes = (const uint8_t*)data;
+        if(size < sizeof(fileHeader) || ((uintptr_t)bytes & (ALIGNMENT - 1)) != 0)
+            return false;
+
+        const fileHeader* header = (const fileHeader*)bytes;
+        if(header->magic != MAGIC || header->version != VERSION)
+            return false;
+
+        if(sizeof(fileHeader) + (uint64_t)header->trackCount * sizeof(fileTrack) > size)
+            return false;
+
+        // validate the index once so the accessors don't have to
+        const fileTrack* tracks = (const fileTrack*)(bytes + sizeof(fileHeader));
+        for(uint32_t n = 0; n < header->trackCount; n++)
+        {
+            const fileTrack& t = tracks[n];
+            size_t ks = keySize(t.type);
+            if(ks == 0)
+                return false;
+            if((t.timesOffset & (ALIGNMENT - 1)) != 0 || (t.keysOffset & (ALIGNMENT - 1)) != 0)
+                return false;
+            if(t.keyCount == 0 || (n > 0 && t.id <= tracks[n - 1].id))
+                return false;
+            // compared against the remaining size so hostile offsets can't wrap
+            if(t.timesOffset > size || (uint64_t)t.keyCount * sizeof(float) > size - t.timesOffset)
+                return false;
+            if(t.keysOffset > size || (uint64_t)t.keyCount * ks > size - t.keysOffset)
+                return false;
+
+            // findKey searches the times, written so a NaN fails too
+            const float* times = (const float*)(bytes + t.timesOffset);
+            for(uint32_t k = 1; k < t.keyCount; k++)
+            {
+                if(!(times[k] >= times[k - 1]))
+                    return false;
+            }
+        }
+
+        m_data = bytes;
+        m_size = size;
+        return true;
+    }
+
+    bool clip::open(const char* path)
+    {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        HANDLE mapping = NULL;
+        if(GetFileSizeEx(file, &size) && size.QuadPart > 0)
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if(mapping == NULL)
+            return false;
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if(data == NULL)
+            return false;
+
+        if(!load(data, (size_t)size.QuadPart))
+        {
+            UnmapViewOfFile(data);
+            return false;
+        }
+#else
+        int file = ::open(path, O_RDONLY);
+        if(file < 0)
+            return false;
+
+        struct stat st;
+        void* data = MAP_FAILED;
+        if(fstat(file, &st) == 0 && st.st_size > 0)
+            data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        ::close(file);
+        if(data == MAP_FAILED)
+            return false;
+
+        if(!load(data, (size_t)st.st_size))
+        {
+            munmap(data, (size_t)st.st_size);
+            return false;
+        }
+#endif // _WIN32
+
+        m_mapping = data;
+        return true;
+    }
+
+    void clip::close()
+    {
+        if(m_mapping)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(m_mapping);
+#else
+            munmap(m_mapping, m_size);
+#endif // _WIN32
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_mapping = nullptr;
+    }
+
+    unsigned clip::trackCount() const
+    {
+        return m_data ? ((const fileHeader*)m_data)->trackCount : 0;
+    }
+
+    float clip::duration() const
+    {
+        return m_data ? ((const fileHeader*)m_data)->duration : 0.0f;
+    }
+
+    int clip::findTrack(const uint32_t& id) const
+    {
+        const fileTrack* tracks = (const fileTrack*)entry(0);
+        int low = 0;
+        int high = (int)trackCount() - 1;
+
+        while(low <= high)
+        {
+            int mid = (low + high) / 2;
+            if(tracks[mid].id < id) low = mid + 1;
+            else if(tracks[mid].id > id) high = mid - 1;
+            else return mid;
+        }
+
+        return -1;
+    }
+
+    uint32_t clip::trackId(const unsigned& track) const
+    {
+        return ((const fileTrack*)entry(track))->id;
+    }
+
+    clip::trackType clip::type(const unsigned& track) const
+    {
+        return (trackType)((const fileTrack*)entry(track))->type;
+    }
+
+    unsigned clip::keyCount(const unsigned& track) const
+    {
+        return ((const fileTrack*)entry(track))->keyCount;
+    }
+
+    const float* clip::times(const unsigned& track) const
+    {
+        return (const float*)(m_data + ((const fileTrack*)entry(track))->timesOffset);
+    }
+
+    const vec3* clip::vec3Keys(const unsigned& track) const
+    {
+        const fileTrack* t = (const fileTrack*)entry(track);
+        return t->type == TRACK_VEC3 ? (const vec3*)(m_data + t->keysOffset) : nullptr;
+    }
+
+    const quat* clip::quatKeys(const unsigned& track) const
+    {
+        const fileTrack* t = (const fileTrack*)entry(track);
+        return t->type == TRACK_QUAT ? (const quat*)(m_data + t->keysOffset) : nullptr;
+    }
+
+    const transform* clip::transformKeys(const unsigned& track) const
+    {
+        const fileTrack* t = (const fileTrack*)entry(track);
+        return t->type == TRACK_TRANSFORM ? (const transform*)(m_data + t->keysOffset) : nullptr;
+    }
+
+    vec3 clip::sampleVec3(const unsigned& track, const float& time) const
+    {
+        const vec3* keys = vec3Keys(track);
+        if(keys == nullptr)
+            return vec3();
+        if(keyCount(track) == 1)
+            return keys[0];
+
+        float t;
+        unsigned k = findKey(track, time, t);
+        return vec3::lerp(keys[k], keys[k + 1], t);
+    }
+
+    quat clip::sampleQuat(const unsigned& track, const float& time) const
+    {
+        const quat* keys = quatKeys(track);
+        if(keys == nullptr)
+            return quat();
+        if(keyCount(track) == 1)
+            return keys[0];
+
+        float t;
+        unsigned k = findKey(track, time, t);
+        return quat::slerp(keys[k], keys[k + 1], t);
+    }
+
+    transform clip::sampleTransform(const unsigned& track, const float& time) const
+    {
+        const transform* keys = transformKeys(track);
+        if(keys == nullptr)
+            return transform();
+        if(keyCount(track) == 1)
+            return keys[0];
+
+        float t;
+        unsigned k = findKey(track, time, t);
+        return transform::lerp(keys[k], keys[k + 1], t);
+    }
+
+    const void* clip::entry(const unsigned& track) const
+    {
+        return m_data + sizeof(fileHeader) + track * sizeof(fileTrack);
+    }
+
+    // returns key k so that the sample lies between k and k + 1, clamped to the ends.
+    // the track needs at least two keys, the samplers handle single key tracks. a NaN time takes the first key
+    unsigned clip::findKey(const unsigned& track, const float& time, float& t) const
+    {
+        const float* keyTimes = times(track);
+        unsigned count = keyCount(track);
+
+        if(!(time > keyTimes[0]))
+        {
+            t = 0.0f;
+            return 0;
+        }
+        if(time >= keyTimes[count - 1])
+        {
+            t = 1.0f;
+            return count - 2;
+        }
+
+        unsigned k = (unsigned)(std::upper_bound(keyTimes, keyTimes + count, time) - keyTimes) - 1;
+        t = (time - keyTimes[k]) / (keyTimes[k + 1] - keyTimes[k]);
+        return k;
+    }
+
+    ///////////////////////////////////////
+    //              WRITER               //
+    ///////////////////////////////////////
+
+    void clipWriter::addTrack(const uint32_t& id, const float* times, const vec3* keys, const unsigned& count)
+    {
+        addTrack(id, clip::TRACK_VEC3, times, keys, sizeof(vec3), count);
+    }
+
+    void clipWriter::addTrack(const uint32_t& id, const float* times, const quat* keys, const unsigned& count)
+    {
+        addTrack(id, clip::TRACK_QUAT, times, keys, sizeof(quat), count);
+    }
+
+    void clipWriter::addTrack(const uint32_t& id, const float* times, const transform* keys, const unsigned& count)
+    {
+        addTrack(id, clip::TRACK_TRANSFORM, times, keys, sizeof(transform), count);
+    }
+
+    void clipWriter::addTrack(const uint32_t& id, const uint32_t& type, const float* times, const void* keys, const size_t& keySize, const unsigned& count)
+    {
+        if(count == 0)
+            return;
+
+        track t;
+        t.id = id;
+        t.type = type;
+        t.keyCount = count;
+        t.times.assign(times, times + count);
+        t.keys.assign((const uint8_t*)keys, (const uint8_t*)keys + keySize * count);
+
+        // keep the index sorted by id for findTrack
+        std::vector<track>::iterator it = m_tracks.begin();
+        while(it != m_tracks.end() && it->id < id)
+            ++it;
+        if(it != m_tracks.end() && it->id == id)
+            *it = t;
+        else
+            m_tracks.insert(it, t);
+    }
+
+    size_t clipWriter::size() const
+    {
+        size_t res = align(sizeof(fileHeader) + m_tracks.size() * sizeof(fileTrack));
+        for(const track& t : m_tracks)
+            res += align(t.times.size() * sizeof(float)) + align(t.keys.size());
+        return res;
+    }
+
+    void clipWriter::write(void* dst) const
+    {
+        uint8_t* bytes = (uint8_t*)dst;
+        memset(bytes, 0, size());
+
+        fileHeader header;
+        header.magic = MAGIC;
+        header.version = clip::VERSION;
+        header.trackCount = (uint32_t)m_tracks.size();
+        header.duration = 0.0f;
+        for(const track& t : m_tracks)
+        {
+            if(!t.times.empty())
+                header.duration = std::max(header.duration, t.times.back());
+        }
+        memcpy(bytes, &header, sizeof(header));
+
+        size_t offset = align(sizeof(fileHeader) + m_tracks.size() * sizeof(fileTrack));
+        for(size_t n = 0; n < m_tracks.size(); n++)
+        {
+            const track& t = m_tracks[n];
+
+            fileTrack entry;
+            entry.id = t.id;
+            entry.type = t.type;
+            entry.keyCount = t.keyCount;
+            entry.reserved = 0;
+
+            entry.timesOffset = offset;
+            if(!t.times.empty())
+                memcpy(bytes + offset, t.times.data(), t.times.size() * sizeof(float));
+            offset += align(t.times.size() * sizeof(float));
+
+            entry.keysOffset = offset;
+            if(!t.keys.empty())
+                memcpy(bytes + offset, t.keys.data(), t.keys.size());
+            offset += align(t.keys.size());
+
+            memcpy(bytes + sizeof(fileHeader) + n * sizeof(fileTrack), &entry, sizeof(entry));
+        }
+    }
+
+    bool clipWriter::save(const char* path) const
+    {
+        std::vector<uint8_t> buffer(size());
+        write(buffer.data());
+
+        FILE* file = fopen(path, "wb");
+        if(file == nullptr)
+            return false;
+
+        bool res = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+        return fclose(file) == 0 && res;
+    }
+}
@@ -0,0 +1,763 @@
+#include "m3d/closestPoint.h"
+#include "m3d/vec3.h"
+#include "m3d/mat3x3.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+namespace m3d
+{
+    const unsigned triangleBVH::NONE;
+
+    namespace
+    {
+        const unsigned GRAIN = 1024;
+        const unsigned LEAF_SIZE = 4;
+        // nine streams of four lanes
+        const unsigned PACKET_FLOATS = 36;
+        const unsigned STACK_SIZE = 64;
+
+        //Real-Time Collision Detection, Ericson, 5.1.5
+        // weights of b and c for the point of the triangle closest to p
+        inline void triangleWeights(const float* p, const float* a, const float* b, const float* c, float& v, float& w)
+        {
+            float ab[3], ac[3], ap[3], bp[3], cp[3];
+            for(int k = 0; k < 3; k++)
+            {
+                ab[k] = b[k] - a[k];
+                ac[k] = c[k] - a[k];
+                ap[k] = p[k] - a[k];
+                bp[k] = p[k] - b[k];
+                cp[k] = p[k] - c[k];
+            }
+
+            float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+            float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+            v = 0.0f;
+            w = 0.0f;
+            if(d1 <= 0.0f && d2 <= 0.0f)
+                return;
+
+            float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+            float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+            if(d3 >= 0.0f && d4 <= d3)
+            {
+                v = 1.0f;
+                return;
+            }
+
+            // the edge tests also need a non zero edge, a repeated vertex would divide 0 by 0. with it
+            // degenerate triangles always end up on one of their edges or vertices
+            float vc = d1 * d4 - d3 * d2;
+            if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f && d1 - d3 > 0.0f)
+            {
+                v = d1 / (d1 - d3);
+                return;
+            }
+
+            float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+            float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+            if(d6 >= 0.0f && d5 <= d6)
+            {
+                w = 1.0f;
+                return;
+            }
+
+            float vb = d5 * d2 - d1 * d6;
+            if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f && d2 - d6 > 0.0f)
+            {
+                w = d2 / (d2 - d6);
+                return;
+            }
+
+            float va = d3 * d6 - d5 * d4;
+            if(va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f && (d4 - d3) + (d5 - d6) > 0.0f)
+            {
+                w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+                v = 1.0f - w;
+                return;
+            }
+
+            // only reached by a degenerate triangle through rounding, it falls back to vertex a
+            float sum = va + vb + vc;
+            float denom = sum > 0.0f ? 1.0f / sum : 0.0f;
+            v = vb * denom;
+            w = vc * denom;
+        }
+
+        inline void triangleScalar(const float* p, const float* a, const float* b, const float* c, float* res)
+        {
+            float v, w;
+            triangleWeights(p, a, b, c, v, w);
+            for(int k = 0; k < 3; k++)
+            {
+                res[k] = a[k] + (b[k] - a[k]) * v + (c[k] - a[k]) * w;
+            }
+        }
+
+        inline void segmentScalar(const float* p, const float* a, const float* ab, const float& invLength, float* res)
+        {
+            float t = ((p[0] - a[0]) * ab[0] + (p[1] - a[1]) * ab[1] + (p[2] - a[2]) * ab[2]) * invLength;
+            t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+            for(int k = 0; k < 3; k++)
+            {
+                res[k] = a[k] + ab[k] * t;
+            }
+        }
+
+        inline float distanceSqr(const float* a, const float* b)
+        {
+            float dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+            return dx * dx + dy * dy + dz * dz;
+        }
+
+        inline void load(const pointStreams& points, const unsigned& n, float* p)
+        {
+            p[0] = points.x[n];
+            p[1] = points.y[n];
+            p[2] = points.z[n];
+        }
+
+        inline void write(const closestStreams& res, const unsigned& n, const float* p, const float* c)
+        {
+            res.x[n] = c[0];
+            res.y[n] = c[1];
+            res.z[n] = c[2];
+            if(res.distanceSqr)
+                res.distanceSqr[n] = distanceSqr(p, c);
+        }
+
+#ifdef __SSE__
+        inline __m128 select(const __m128& mask, const __m128& a, const __m128& b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        inline __m128 dot(const __m128& ax, const __m128& ay, const __m128& az, const __m128& bx, const __m128& by, const __m128& bz)
+        {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        }
+
+        // triangleWeights for four points and four triangles, t is ax ay az bx by bz cx cy cz. every region is
+        // evaluated and they are applied from the last one the walk reaches to the first, so the first match sticks.
+        // the divisions of regions that do not apply can be inf or nan, they are masked out. the edge masks also
+        // need a non zero edge like the scalar version
+        inline void triangle4(const __m128* p, const __m128* t, __m128* res)
+        {
+            __m128 abx = _mm_sub_ps(t[3], t[0]), aby = _mm_sub_ps(t[4], t[1]), abz = _mm_sub_ps(t[5], t[2]);
+            __m128 acx = _mm_sub_ps(t[6], t[0]), acy = _mm_sub_ps(t[7], t[1]), acz = _mm_sub_ps(t[8], t[2]);
+            __m128 apx = _mm_sub_ps(p[0], t[0]), apy = _mm_sub_ps(p[1], t[1]), apz = _mm_sub_ps(p[2], t[2]);
+            __m128 bpx = _mm_sub_ps(p[0], t[3]), bpy = _mm_sub_ps(p[1], t[4]), bpz = _mm_sub_ps(p[2], t[5]);
+            __m128 cpx = _mm_sub_ps(p[0], t[6]), cpy = _mm_sub_ps(p[1], t[7]), cpz = _mm_sub_ps(p[2], t[8]);
+
+            __m128 d1 = dot(abx, aby, abz, apx, apy, apz);
+            __m128 d2 = dot(acx, acy, acz, apx, apy, apz);
+            __m128 d3 = dot(abx, aby, abz, bpx, bpy, bpz);
+            __m128 d4 = dot(acx, acy, acz, bpx, bpy, bpz);
+            __m128 d5 = dot(abx, aby, abz, cpx, cpy, cpz);
+            __m128 d6 = dot(acx, acy, acz, cpx, cpy, cpz);
+
+            __m128 va = _mm_sub_ps(_mm_mul_ps(d3, d6), _mm_mul_ps(d5, d4));
+            __m128 vb = _mm_sub_ps(_mm_mul_ps(d5, d2), _mm_mul_ps(d1, d6));
+            __m128 vc = _mm_sub_ps(_mm_mul_ps(d1, d4), _mm_mul_ps(d3, d2));
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+
+            // inside
+            __m128 sum = _mm_add_ps(_mm_add_ps(va, vb), vc);
+            __m128 denom = _mm_and_ps(_mm_cmpgt_ps(sum, zero), _mm_div_ps(one, sum));
+            __m128 v = _mm_mul_ps(vb, denom);
+            __m128 w = _mm_mul_ps(vc, denom);
+
+            // edge bc
+            __m128 d43 = _mm_sub_ps(d4, d3);
+            __m128 d56 = _mm_sub_ps(d5, d6);
+            __m128 length = _mm_add_ps(d43, d56);
+            __m128 mask = _mm_and_ps(_mm_cmple_ps(va, zero), _mm_and_ps(_mm_cmpge_ps(d43, zero), _mm_cmpge_ps(d56, zero)));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(length, zero));
+            __m128 edge = _mm_div_ps(d43, length);
+            v = select(mask, _mm_sub_ps(one, edge), v);
+            w = select(mask, edge, w);
+
+            // edge ac
+            length = _mm_sub_ps(d2, d6);
+            mask = _mm_and_ps(_mm_cmple_ps(vb, zero), _mm_and_ps(_mm_cmpge_ps(d2, zero), _mm_cmple_ps(d6, zero)));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(length, zero));
+            edge = _mm_div_ps(d2, length);
+            v = select(mask, zero, v);
+            w = select(mask, edge, w);
+
+            // vertex c
+            mask = _mm_and_ps(_mm_cmpge_ps(d6, zero), _mm_cmple_ps(d5, d6));
+            v = select(mask, zero, v);
+            w = select(mask, one, w);
+
+            // edge ab
+            length = _mm_sub_ps(d1, d3);
+            mask = _mm_and_ps(_mm_cmple_ps(vc, zero), _mm_and_ps(_mm_cmpge_ps(d1, zero), _mm_cmple_ps(d3, zero)));
+            mask = _mm_and_ps(mask, _mm_cmpgt_ps(length, zero));
+            edge = _mm_div_ps(d1, length);
+            v = select(mask, edge, v);
+            w = select(mask, zero, w);
+
+            // vertex b
+            mask = _mm_and_ps(_mm_cmpge_ps(d3, zero), _mm_cmple_ps(d4, d3));
+            v = select(mask, one, v);
+            w = select(mask, zero, w);
+
+            // vertex a
+            mask = _mm_and_ps(_mm_cmple_ps(d1, zero), _mm_cmple_ps(d2, zero));
+            v = select(mask, zero, v);
+            w = select(mask, zero, w);
+
+            res[0] = _mm_add_ps(t[0], _mm_add_ps(_mm_mul_ps(abx, v), _mm_mul_ps(acx, w)));
+            res[1] = _mm_add_ps(t[1], _mm_add_ps(_mm_mul_ps(aby, v), _mm_mul_ps(acy, w)));
+            res[2] = _mm_add_ps(t[2], _mm_add_ps(_mm_mul_ps(abz, v), _mm_mul_ps(acz, w)));
+        }
+
+        inline __m128 distanceSqr4(const __m128* a, const __m128* b)
+        {
+            __m128 dx = _mm_sub_ps(a[0], b[0]);
+            __m128 dy = _mm_sub_ps(a[1], b[1]);
+            __m128 dz = _mm_sub_ps(a[2], b[2]);
+            return dot(dx, dy, dz, dx, dy, dz);
+        }
+
+        inline void load4(const pointStreams& points, const unsigned& n, __m128* p)
+        {
+            p[0] = _mm_loadu_ps(points.x + n);
+            p[1] = _mm_loadu_ps(points.y + n);
+            p[2] = _mm_loadu_ps(points.z + n);
+        }
+
+        inline void write4(const closestStreams& res, const unsigned& n, const __m128* p, const __m128* c)
+        {
+            _mm_storeu_ps(res.x + n, c[0]);
+            _mm_storeu_ps(res.y + n, c[1]);
+            _mm_storeu_ps(res.z + n, c[2]);
+            if(res.distanceSqr)
+                _mm_storeu_ps(res.distanceSqr + n, distanceSqr4(p, c));
+        }
+#endif // __SSE__
+    }
+
+    ///////////////////////////////////////
+    //              SINGLE               //
+    ///////////////////////////////////////
+
+    vec3 closestPoint::segment(const vec3& p, const vec3& a, const vec3& b)
+    {
+        float ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+        float length = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+
+        vec3 res;
+        segmentScalar(&p.x, &a.x, ab, length > 0.0f ? 1.0f / length : 0.0f, &res.x);
+        return res;
+    }
+
+    vec3 closestPoint::triangle(const vec3& p, const vec3& a, const vec3& b, const vec3& c)
+    {
+        vec3 res;
+        triangleScalar(&p.x, &a.x, &b.x, &c.x, &res.x);
+        return res;
+    }
+
+    vec3 closestPoint::box(const vec3& p, const vec3& min, const vec3& max)
+    {
+        return vec3::max(min, vec3::min(max, p));
+    }
+
+    //Real-Time Collision Detection, Ericson, 5.1.4
+    vec3 closestPoint::box(const vec3& p, const vec3& center, const vec3& halfExtents, const quat& rotation)
+    {
+        mat3x3 r = mat3x3::initRotationFromQuat(rotation);
+        vec3 d = p - center;
+        vec3 res = center;
+
+        for(int j = 0; j < 3; j++)
+        {
+            float h = (&halfExtents.x)[j];
+            float dist = r.at(0, j) * d.x + r.at(1, j) * d.y + r.at(2, j) * d.z;
+            dist = dist > h ? h : (dist < -h ? -h : dist);
+            res.x += r.at(0, j) * dist;
+            res.y += r.at(1, j) * dist;
+            res.z += r.at(2, j) * dist;
+        }
+
+        return res;
+    }
+
+    ///////////////////////////////////////
+    //              STREAMS              //
+    ///////////////////////////////////////
+
+    void closestPoint::segment(const pointStreams& points, const unsigned& count, const vec3& a, const vec3& b, const closestStreams& res)
+    {
+        M3D_PROFILE("closestPoint::segment(streams)");
+
+        float ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+        float length = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+        float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+        unsigned n = 0;
+
+#ifdef __SSE__
+        const __m128 a4[3] = { _mm_set1_ps(a.x), _mm_set1_ps(a.y), _mm_set1_ps(a.z) };
+        const __m128 ab4[3] = { _mm_set1_ps(ab[0]), _mm_set1_ps(ab[1]), _mm_set1_ps(ab[2]) };
+        const __m128 inv = _mm_set1_ps(invLength);
+
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 p[3], c[3];
+            load4(points, n, p);
+
+            __m128 t = _mm_mul_ps(dot(_mm_sub_ps(p[0], a4[0]), _mm_sub_ps(p[1], a4[1]), _mm_sub_ps(p[2], a4[2]), ab4[0], ab4[1], ab4[2]), inv);
+            t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+            for(int k = 0; k < 3; k++)
+            {
+                c[k] = _mm_add_ps(a4[k], _mm_mul_ps(ab4[k], t));
+            }
+            write4(res, n, p, c);
+        }
+#endif // __SSE__
+
+        for(; n < count; n++)
+        {
+            float p[3], c[3];
+            load(points, n, p);
+            segmentScalar(p, &a.x, ab, invLength, c);
+            write(res, n, p, c);
+        }
+    }
+
+    void closestPoint::triangle(const pointStreams& points, const unsigned& count, const vec3& a, const vec3& b, const vec3& c, const closestStreams& res)
+    {
+        M3D_PROFILE("closestPoint::triangle(streams)");
+
+        unsigned n = 0;
+
+#ifdef __SSE__
+        const __m128 t[9] = { _mm_set1_ps(a.x), _mm_set1_ps(a.y), _mm_set1_ps(a.z),
+                              _mm_set1_ps(b.x), _mm_set1_ps(b.y), _mm_set1_ps(b.z),
+                              _mm_set1_ps(c.x), _mm_set1_ps(c.y), _mm_set1_ps(c.z) };
+
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 p[3], r[3];
+            load4(points, n, p);
+            triangle4(p, t, r);
+            write4(res, n, p, r);
+        }
+#endif // __SSE__
+
+        for(; n < count; n++)
+        {
+            float p[3], r[3];
+            load(points, n, p);
+            triangleScalar(p, &a.x, &b.x, &c.x, r);
+            write(res, n, p, r);
+        }
+    }
+
+    void closestPoint::box(const pointStreams& points, const unsigned& count, const vec3& min, const vec3& max, const closestStreams& res)
+    {
+        M3D_PROFILE("closestPoint::box(streams)");
+
+        unsigned n = 0;
+
+#ifdef __SSE__
+        const __m128 lo[3] = { _mm_set1_ps(min.x), _mm_set1_ps(min.y), _mm_set1_ps(min.z) };
+        const __m128 hi[3] = { _mm_set1_ps(max.x), _mm_set1_ps(max.y), _mm_set1_ps(max.z) };
+
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 p[3], c[3];
+            load4(points, n, p);
+            for(int k = 0; k < 3; k++)
+            {
+                c[k] = _mm_max_ps(lo[k], _mm_min_ps(hi[k], p[k]));
+            }
+            write4(res, n, p, c);
+        }
+#endif // __SSE__
+
+        for(; n < count; n++)
+        {
+            float p[3], c[3];
+            load(points, n, p);
+            for(int k = 0; k < 3; k++)
+            {
+                c[k] = std::max((&min.x)[k], std::min((&max.x)[k], p[k]));
+            }
+            write(res, n, p, c);
+        }
+    }
+
+    void closestPoint::box(const pointStreams& points, const unsigned& count, const vec3& center, const vec3& halfExtents, const quat& rotation, const closestStreams& res)
+    {
+        M3D_PROFILE("closestPoint::box(oriented streams)");
+
+        mat3x3 r = mat3x3::initRotationFromQuat(rotation);
+        unsigned n = 0;
+
+#ifdef __SSE__
+        __m128 axes[3][3];
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                axes[i][j] = _mm_set1_ps(r.at(i, j));
+            }
+        }
+        const __m128 c4[3] = { _mm_set1_ps(center.x), _mm_set1_ps(center.y), _mm_set1_ps(center.z) };
+        const __m128 h4[3] = { _mm_set1_ps(halfExtents.x), _mm_set1_ps(halfExtents.y), _mm_set1_ps(halfExtents.z) };
+
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 p[3], c[3];
+            load4(points, n, p);
+
+            __m128 d[3] = { _mm_sub_ps(p[0], c4[0]), _mm_sub_ps(p[1], c4[1]), _mm_sub_ps(p[2], c4[2]) };
+            c[0] = c4[0];
+            c[1] = c4[1];
+            c[2] = c4[2];
+
+            for(int j = 0; j < 3; j++)
+            {
+                __m128 dist = dot(axes[0][j], axes[1][j], axes[2][j], d[0], d[1], d[2]);
+                dist = _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), h4[j]), _mm_min_ps(h4[j], dist));
+                for(int i = 0; i < 3; i++)
+                {
+                    c[i] = _mm_add_ps(c[i], _mm_mul_ps(axes[i][j], dist));
+                }
+            }
+            write4(res, n, p, c);
+        }
+#endif // __SSE__
+
+        for(; n < count; n++)
+        {
+            float p[3];
+            load(points, n, p);
+
+            float d[3] = { p[0] - center.x, p[1] - center.y, p[2] - center.z };
+            float c[3] = { center.x, center.y, center.z };
+            for(int j = 0; j < 3; j++)
+            {
+                float h = (&halfExtents.x)[j];
+                float dist = r.at(0, j) * d[0] + r.at(1, j) * d[1] + r.at(2, j) * d[2];
+                dist = dist > h ? h : (dist < -h ? -h : dist);
+                for(int i = 0; i < 3; i++)
+                {
+                    c[i] += r.at(i, j) * dist;
+                }
+            }
+            write(res, n, p, c);
+        }
+    }
+
+    void closestPoint::triangles(const pointStreams& points, const triangleStreams& triangles, const unsigned& count, const closestStreams& res)
+    {
+        M3D_PROFILE("closestPoint::triangles");
+
+        const float* streams[9] = { triangles.ax, triangles.ay, triangles.az, triangles.bx, triangles.by, triangles.bz, triangles.cx, triangles.cy, triangles.cz };
+        unsigned n = 0;
+
+#ifdef __SSE__
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 p[3], t[9], r[3];
+            load4(points, n, p);
+            for(int k = 0; k < 9; k++)
+            {
+                t[k] = _mm_loadu_ps(streams[k] + n);
+            }
+            triangle4(p, t, r);
+            write4(res, n, p, r);
+        }
+#endif // __SSE__
+
+        for(; n < count; n++)
+        {
+            float p[3], t[9], r[3];
+            load(points, n, p);
+            for(int k = 0; k < 9; k++)
+            {
+                t[k] = streams[k][n];
+            }
+            triangleScalar(p, t, t + 3, t + 6, r);
+            write(res, n, p, r);
+        }
+    }
+
+    ///////////////////////////////////////
+    //                BVH                //
+    ///////////////////////////////////////
+
+    triangleBVH::triangleBVH() : m_triangleCount(0) {}
+
+    void triangleBVH::build(const float* x, const float* y, const float* z, const uint32_t* indices, const unsigned& triangleCount)
+    {
+        M3D_PROFILE("triangleBVH::build");
+
+        m_nodes.clear();
+        m_packets.clear();
+        m_lanes.clear();
+        m_triangleCount = triangleCount;
+        if(triangleCount == 0)
+            return;
+
+        m_centroids.resize((size_t)triangleCount * 3);
+        m_order.resize(triangleCount);
+        float* centroids = m_centroids.data();
+        unsigned* order = m_order.data();
+        for(unsigned t = 0; t < triangleCount; t++)
+        {
+            const uint32_t* tri = indices + t * 3;
+            centroids[t * 3] = (x[tri[0]] + x[tri[1]] + x[tri[2]]) * (1.0f / 3.0f);
+            centroids[t * 3 + 1] = (y[tri[0]] + y[tri[1]] + y[tri[2]]) * (1.0f / 3.0f);
+            centroids[t * 3 + 2] = (z[tri[0]] + z[tri[1]] + z[tri[2]]) * (1.0f / 3.0f);
+            order[t] = t;
+        }
+
+        m_nodes.reserve(2 * (triangleCount / LEAF_SIZE + 1));
+        m_nodes.push_back(node());
+        buildNode(0, order, 0, triangleCount, x, y, z, indices, centroids);
+    }
+
+    // median split on the longest axis of the centroids, leaves are one packet
+    void triangleBVH::buildNode(const unsigned& index, unsigned* order, const unsigned& begin, const unsigned& end,
+                                const float* x, const float* y, const float* z, const uint32_t* indices, const float* centroids)
+    {
+        const float* positions[3] = { x, y, z };
+
+        node res;
+        float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for(int k = 0; k < 3; k++)
+        {
+            res.min[k] = FLT_MAX;
+            res.max[k] = -FLT_MAX;
+        }
+
+        for(unsigned n = begin; n < end; n++)
+        {
+            const uint32_t* tri = indices + order[n] * 3;
+            for(int k = 0; k < 3; k++)
+            {
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    float v = positions[k][tri[corner]];
+                    res.min[k] = std::min(res.min[k], v);
+                    res.max[k] = std::max(res.max[k], v);
+                }
+                lo[k] = std::min(lo[k], centroids[order[n] * 3 + k]);
+                hi[k] = std::max(hi[k], centroids[order[n] * 3 + k]);
+            }
+        }
+
+        if(end - begin <= LEAF_SIZE)
+        {
+            unsigned packet = (unsigned)m_lanes.size() / 4;
+            res.index = packet;
+            res.count = end - begin;
+            m_nodes[index] = res;
+
+            m_packets.resize(m_packets.size() + PACKET_FLOATS);
+            m_lanes.resize(m_lanes.size() + 4);
+            float* out = m_packets.data() + (size_t)packet * PACKET_FLOATS;
+            for(unsigned lane = 0; lane < 4; lane++)
+            {
+                unsigned t = order[std::min(begin + lane, end - 1)];
+                m_lanes[packet * 4 + lane] = t;
+                for(int corner = 0; corner < 3; corner++)
+                {
+                    for(int k = 0; k < 3; k++)
+                    {
+                        out[(corner * 3 + k) * 4 + lane] = positions[k][indices[t * 3 + corner]];
+                    }
+                }
+            }
+            return;
+        }
+
+        int axis = 0;
+        for(int k = 1; k < 3; k++)
+        {
+            if(hi[k] - lo[k] > hi[axis] - lo[axis])
+                axis = k;
+        }
+
+        unsigned mid = (begin + end) / 2;
+        std::nth_element(order + begin, order + mid, order + end, [&](const unsigned& a, const unsigned& b)
+        {
+            return centroids[a * 3 + axis] < centroids[b * 3 + axis];
+        });
+
+        unsigned child = (unsigned)m_nodes.size();
+        m_nodes.resize(child + 2);
+        res.index = child;
+        res.count = 0;
+        m_nodes[index] = res;
+
+        buildNode(child, order, begin, mid, x, y, z, indices, centroids);
+        buildNode(child + 1, order, mid, end, x, y, z, indices, centroids);
+    }
+
+    unsigned triangleBVH::triangleCount() const
+    {
+        return m_triangleCount;
+    }
+
+    unsigned triangleBVH::nodeCount() const
+    {
+        return (unsigned)m_nodes.size();
+    }
+
+    // depth first, nearer child first, anything farther than the best so far is skipped
+    void triangleBVH::query(const float* p, const float& maxDistanceSqr, float* res, unsigned& triangle) const
+    {
+        res[0] = p[0];
+        res[1] = p[1];
+        res[2] = p[2];
+        res[3] = maxDistanceSqr;
+        triangle = NONE;
+
+        if(m_nodes.empty())
+            return;
+
+        auto boxDistanceSqr = [&](const node& n)
+        {
+            float d = 0.0f;
+            for(int k = 0; k < 3; k++)
+            {
+                float v = p[k] < n.min[k] ? n.min[k] - p[k] : (p[k] > n.max[k] ? p[k] - n.max[k] : 0.0f);
+                d += v * v;
+            }
+            return d;
+        };
+
+        unsigned stack[STACK_SIZE];
+        float distances[STACK_SIZE];
+        unsigned top = 0;
+        stack[top] = 0;
+        distances[top++] = boxDistanceSqr(m_nodes[0]);
+
+#ifdef __SSE__
+        const __m128 p4[3] = { _mm_set1_ps(p[0]), _mm_set1_ps(p[1]), _mm_set1_ps(p[2]) };
+#endif // __SSE__
+
+        while(top > 0)
+        {
+            top--;
+            if(distances[top] >= res[3])
+                continue;
+
+            const node& n = m_nodes[stack[top]];
+            if(n.count > 0)
+            {
+                const float* packet = m_packets.data() + (size_t)n.index * PACKET_FLOATS;
+                float cx[4], cy[4], cz[4], d[4];
+
+#ifdef __SSE__
+                __m128 t[9], c[3];
+                for(int k = 0; k < 9; k++)
+                {
+                    t[k] = _mm_loadu_ps(packet + k * 4);
+                }
+                triangle4(p4, t, c);
+                _mm_storeu_ps(cx, c[0]);
+                _mm_storeu_ps(cy, c[1]);
+                _mm_storeu_ps(cz, c[2]);
+                _mm_storeu_ps(d, distanceSqr4(p4, c));
+#else
+                for(int lane = 0; lane < 4; lane++)
+                {
+                    float a[3] = { packet[lane], packet[4 + lane], packet[8 + lane] };
+                    float b[3] = { packet[12 + lane], packet[16 + lane], packet[20 + lane] };
+                    float c[3] = { packet[24 + lane], packet[28 + lane], packet[32 + lane] };
+                    float r[3];
+                    triangleScalar(p, a, b, c, r);
+                    cx[lane] = r[0];
+                    cy[lane] = r[1];
+                    cz[lane] = r[2];
+                    d[lane] = distanceSqr(p, r);
+                }
+#endif // __SSE__
+
+                for(unsigned lane = 0; lane < n.count; lane++)
+                {
+                    if(d[lane] < res[3])
+                    {
+                        res[0] = cx[lane];
+                        res[1] = cy[lane];
+                        res[2] = cz[lane];
+                        res[3] = d[lane];
+                        triangle = m_lanes[n.index * 4 + lane];
+                    }
+                }
+                continue;
+            }
+
+            unsigned near = n.index, far = n.index + 1;
+            float nearDistance = boxDistanceSqr(m_nodes[near]);
+            float farDistance = boxDistanceSqr(m_nodes[far]);
+            if(farDistance < nearDistance)
+            {
+                std::swap(near, far);
+                std::swap(nearDistance, farDistance);
+            }
+
+            if(farDistance < res[3])
+            {
+                stack[top] = far;
+                distances[top++] = farDistance;
+            }
+            if(nearDistance < res[3])
+            {
+                stack[top] = near;
+                distances[top++] = nearDistance;
+            }
+        }
+    }
+
+    void triangleBVH::closest(const pointStreams& points, const unsigned& count, const closestStreams& res, unsigned* triangles, const float& maxDistance) const
+    {
+        M3D_PROFILE("triangleBVH::closest");
+
+        float maxDistanceSqr = maxDistance < 1e18f ? maxDistance * maxDistance : FLT_MAX;
+        for(unsigned n = 0; n < count; n++)
+        {
+            float p[3], c[4];
+            unsigned triangle;
+            load(points, n, p);
+            query(p, maxDistanceSqr, c, triangle);
+
+            res.x[n] = c[0];
+            res.y[n] = c[1];
+            res.z[n] = c[2];
+            if(res.distanceSqr)
+                res.distanceSqr[n] = c[3];
+            if(triangles)
+                triangles[n] = triangle;
+        }
+    }
+
+    void triangleBVH::closestParallel(const pointStreams& points, const unsigned& count, const closestStreams& res, unsigned* triangles, const float& maxDistance) const
+    {
+        M3D_PROFILE("triangleBVH::closestParallel");
+
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            pointStreams in = { points.x + begin, points.y + begin, points.z + begin };
+            closestStreams out = { res.x + begin, res.y + begin, res.z + begin, res.distanceSqr ? res.distanceSqr + begin : nullptr };
+            closest(in, end - begin, out, triangles ? triangles + begin : nullptr, maxDistance);
+        });
+    }
+}
@@ -0,0 +1,572 @@
+#include "m3d/convexHull.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+namespace m3d
+{
+    const unsigned hullBuilder::NONE;
+
+    namespace
+    {
+        const unsigned REMOVED = hullBuilder::NONE - 1;
+    }
+
+    void convexHull::clear()
+    {
+        vertices.clear();
+        edges.clear();
+        faces.clear();
+    }
+
+    bool convexHull::contains(const convexHull& hull, const vec3& p, const float& tolerance)
+    {
+        for(const hullFace& f : hull.faces)
+        {
+            if(vec3::dot(f.normal, p) - f.distance > tolerance)
+                return false;
+        }
+
+        return !hull.faces.empty();
+    }
+
+    ///////////////////////////////////////
+    //              BUILDER              //
+    ///////////////////////////////////////
+
+    //http://media.steampowered.com/apps/valve/2014/DirkGregorius_ImplementingQuickHull.pdf
+    bool hullBuilder::build(const vec3* points, const unsigned& count, convexHull& hull, const unsigned& maxVertices)
+    {
+        M3D_PROFILE("hullBuilder::build");
+
+        hull.clear();
+        m_points = points;
+        m_faces.clear();
+        m_edges.clear();
+        m_freeFaces.clear();
+        m_freeEdges.clear();
+        m_pending.clear();
+        m_nextConflict.assign(count, NONE);
+        m_vertexMap.assign(count, NONE);
+
+        if(count < 4 || !initialSimplex(count))
+            return false;
+
+        unsigned vertices = 4;
+        while(maxVertices == 0 || vertices < maxVertices)
+        {
+            // the farthest point overall goes first, it is never nearly coplanar with the faces it sees and
+            // with a limit it keeps as much of the volume as possible. entries for faces that changed are skipped
+            unsigned eyeFace = NONE;
+            while(!m_pending.empty() && eyeFace == NONE)
+            {
+                std::pop_heap(m_pending.begin(), m_pending.end());
+                pending top = m_pending.back();
+                m_pending.pop_back();
+
+                const face& f = m_faces[top.face];
+                if(f.alive && f.generation == top.generation && f.farthestDistance == top.distance)
+                    eyeFace = top.face;
+            }
+
+            if(eyeFace == NONE)
+                break;
+
+            // a copy, adding faces can move m_faces
+            unsigned eye = m_faces[eyeFace].farthest;
+            addPoint(eye, eyeFace);
+            vertices++;
+        }
+
+        output(hull);
+        return true;
+    }
+
+    float hullBuilder::tolerance() const
+    {
+        return m_tolerance;
+    }
+
+    bool hullBuilder::initialSimplex(const unsigned& count)
+    {
+        const vec3* p = m_points;
+
+        unsigned extremes[6] = { 0, 0, 0, 0, 0, 0 };
+        vec3 maxAbs(0.0f);
+        for(unsigned n = 0; n < count; n++)
+        {
+            for(int k = 0; k < 3; k++)
+            {
+                float v = (&p[n].x)[k];
+                if(v < (&p[extremes[k * 2]].x)[k]) extremes[k * 2] = n;
+                if(v > (&p[extremes[k * 2 + 1]].x)[k]) extremes[k * 2 + 1] = n;
+                if(fabsf(v) > (&maxAbs.x)[k]) (&maxAbs.x)[k] = fabsf(v);
+            }
+        }
+
+        // float error in the plane distances grows with the magnitude of the coordinates
+        m_tolerance = 3.0f * FLT_EPSILON * (maxAbs.x + maxAbs.y + maxAbs.z);
+
+        // the two extremes farthest apart, the point farthest from their line and the point farthest from that plane
+        unsigned a = 0, b = 0;
+        float best = 0.0f;
+        for(int k = 0; k < 3; k++)
+        {
+            float d = vec3::distanceSqr(p[extremes[k * 2]], p[extremes[k * 2 + 1]]);
+            if(d > best)
+            {
+                best = d;
+                a = extremes[k * 2];
+                b = extremes[k * 2 + 1];
+            }
+        }
+
+        if(sqrtf(best) <= m_tolerance)
+            return false;
+
+        vec3 ab = p[b] - p[a];
+        unsigned c = 0;
+        best = 0.0f;
+        for(unsigned n = 0; n < count; n++)
+        {
+            float d = vec3::lengthSqr(vec3::cross(p[n] - p[a], ab));
+            if(d > best)
+            {
+                best = d;
+                c = n;
+            }
+        }
+
+        if(sqrtf(best / vec3::lengthSqr(ab)) <= m_tolerance)
+            return false;
+
+        vec3 normal = vec3::normalized(vec3::cross(ab, p[c] - p[a]));
+        unsigned d = 0;
+        best = 0.0f;
+        for(unsigned n = 0; n < count; n++)
+        {
+            float dist = fabsf(vec3::dot(normal, p[n] - p[a]));
+            if(dist > best)
+            {
+                best = dist;
+                d = n;
+            }
+        }
+
+        if(best <= m_tolerance)
+            return false;
+
+        // abc has to face away from d
+        if(vec3::dot(normal, p[d] - p[a]) > 0.0f)
+        {
+            unsigned t = b;
+            b = c;
+            c = t;
+        }
+
+        unsigned faces[4] = { addFace(a, b, c), addFace(b, a, d), addFace(c, b, d), addFace(a, c, d) };
+
+        for(unsigned i = 0; i < 12; i++)
+        {
+            unsigned from = m_edges[i].vertex;
+            unsigned to = m_edges[m_edges[i].next].vertex;
+            for(unsigned j = 0; j < 12; j++)
+            {
+                if(m_edges[j].vertex == to && m_edges[m_edges[j].next].vertex == from)
+                    m_edges[i].twin = j;
+            }
+        }
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            if(n == a || n == b || n == c || n == d)
+                continue;
+
+            unsigned target = NONE;
+            float far = m_tolerance;
+            for(unsigned f : faces)
+            {
+                float dist = distance(f, n);
+                if(dist > far)
+                {
+                    far = dist;
+                    target = f;
+                }
+            }
+
+            if(target != NONE)
+                addConflict(target, n, far);
+        }
+
+        return true;
+    }
+
+    unsigned hullBuilder::allocateEdge()
+    {
+        if(!m_freeEdges.empty())
+        {
+            unsigned e = m_freeEdges.back();
+            m_freeEdges.pop_back();
+            return e;
+        }
+
+        m_edges.push_back(hullEdge());
+        return (unsigned)m_edges.size() - 1;
+    }
+
+    unsigned hullBuilder::addFace(const unsigned& a, const unsigned& b, const unsigned& c)
+    {
+        unsigned f;
+        if(!m_freeFaces.empty())
+        {
+            f = m_freeFaces.back();
+            m_freeFaces.pop_back();
+        }
+        else
+        {
+            f = (unsigned)m_faces.size();
+            m_faces.push_back(face());
+            m_faces[f].generation = 0;
+        }
+
+        unsigned corners[3] = { a, b, c };
+        unsigned edges[3] = { allocateEdge(), allocateEdge(), allocateEdge() };
+        for(int k = 0; k < 3; k++)
+        {
+            hullEdge& e = m_edges[edges[k]];
+            e.vertex = corners[k];
+            e.twin = NONE;
+            e.next = edges[(k + 1) % 3];
+            e.face = f;
+        }
+
+        // a sliver gets a zero normal, nothing is ever outside of it
+        vec3 normal = vec3::cross(m_points[b] - m_points[a], m_points[c] - m_points[a]);
+        float length = vec3::length(normal);
+        normal = length > 0.0f ? normal / length : vec3(0.0f);
+
+        face& res = m_faces[f];
+        res.edge = edges[0];
+        res.normal = normal;
+        res.distance = vec3::dot(normal, m_points[a]);
+        res.conflicts = NONE;
+        res.farthest = NONE;
+        res.farthestDistance = 0.0f;
+        res.generation++;
+        res.alive = true;
+        res.visible = false;
+
+        return f;
+    }
+
+    void hullBuilder::addConflict(const unsigned& f, const unsigned& point, const float& distance)
+    {
+        face& target = m_faces[f];
+        m_nextConflict[point] = target.conflicts;
+        target.conflicts = point;
+
+        if(distance > target.farthestDistance)
+        {
+            target.farthestDistance = distance;
+            target.farthest = point;
+
+            m_pending.push_back({ distance, f, target.generation });
+            std::push_heap(m_pending.begin(), m_pending.end());
+        }
+    }
+
+    float hullBuilder::distance(const unsigned& f, const unsigned& point) const
+    {
+        return vec3::dot(m_faces[f].normal, m_points[point]) - m_faces[f].distance;
+    }
+
+    void hullBuilder::addPoint(const unsigned& eye, const unsigned& eyeFace)
+    {
+        // depth first over the faces the eye can see, an edge into a face it cannot see is on the horizon
+        m_visible.clear();
+        m_horizon.clear();
+        m_stack.clear();
+
+        m_faces[eyeFace].visible = true;
+        m_visible.push_back(eyeFace);
+        m_stack.push_back({ eyeFace, m_faces[eyeFace].edge, 3 });
+
+        while(!m_stack.empty())
+        {
+            visit& top = m_stack.back();
+            if(top.remaining == 0)
+            {
+                m_stack.pop_back();
+                continue;
+            }
+
+            unsigned e = top.edge;
+            top.edge = m_edges[e].next;
+            top.remaining--;
+
+            unsigned twin = m_edges[e].twin;
+            unsigned neighbour = m_edges[twin].face;
+            if(m_faces[neighbour].visible)
+                continue;
+
+            if(distance(neighbour, eye) > m_tolerance)
+            {
+                m_faces[neighbour].visible = true;
+                m_visible.push_back(neighbour);
+                m_stack.push_back({ neighbour, m_edges[twin].next, 2 });
+            }
+            else
+            {
+                m_horizon.push_back(e);
+            }
+        }
+
+        // a fan of triangles from the horizon to the eye, the old faces are freed only after this
+        m_created.clear();
+        for(unsigned h : m_horizon)
+        {
+            unsigned a = m_edges[h].vertex;
+            unsigned b = m_edges[m_edges[h].next].vertex;
+            unsigned twin = m_edges[h].twin;
+
+            unsigned f = addFace(a, b, eye);
+            unsigned e = m_faces[f].edge;
+            m_edges[e].twin = twin;
+            m_edges[twin].twin = e;
+
+            // an eye on the plane of the face behind the horizon makes a triangle in that same plane,
+            // its own normal would be rounding noise that can flip it, so it takes the neighbour's plane
+            unsigned neighbour = m_edges[twin].face;
+            if(distance(neighbour, eye) >= -m_tolerance)
+            {
+                m_faces[f].normal = m_faces[neighbour].normal;
+                m_faces[f].distance = m_faces[neighbour].distance;
+            }
+
+            m_vertexMap[a] = f;
+            m_created.push_back(f);
+        }
+
+        // b -> eye of one triangle pairs with eye -> a of the triangle starting at b
+        for(unsigned f : m_created)
+        {
+            unsigned toEye = m_edges[m_faces[f].edge].next;
+            unsigned b = m_edges[toEye].vertex;
+            unsigned fromEye = m_edges[m_edges[m_faces[m_vertexMap[b]].edge].next].next;
+
+            m_edges[toEye].twin = fromEye;
+            m_edges[fromEye].twin = toEye;
+        }
+
+        for(unsigned h : m_horizon)
+        {
+            m_vertexMap[m_edges[h].vertex] = NONE;
+        }
+
+        // points outside the removed faces move to the new face they are farthest outside of, or are inside now
+        for(unsigned v : m_visible)
+        {
+            unsigned point = m_faces[v].conflicts;
+            while(point != NONE)
+            {
+                unsigned next = m_nextConflict[point];
+                if(point != eye)
+                {
+                    unsigned target = NONE;
+                    float far = m_tolerance;
+                    for(unsigned f : m_created)
+                    {
+                        float dist = distance(f, point);
+                        if(dist > far)
+                        {
+                            far = dist;
+                            target = f;
+                        }
+                    }
+
+                    if(target != NONE)
+                        addConflict(target, point, far);
+                }
+                point = next;
+            }
+
+            unsigned e = m_faces[v].edge;
+            for(int k = 0; k < 3; k++)
+            {
+                m_freeEdges.push_back(e);
+                e = m_edges[e].next;
+            }
+
+            m_faces[v].alive = false;
+            m_faces[v].visible = false;
+            m_faces[v].conflicts = NONE;
+            m_freeFaces.push_back(v);
+        }
+    }
+
+    unsigned hullBuilder::findGroup(unsigned f)
+    {
+        while(m_group[f] != f)
+        {
+            m_group[f] = m_group[m_group[f]];
+            f = m_group[f];
+        }
+        return f;
+    }
+
+    bool hullBuilder::onPlane(const unsigned& plane, const unsigned& f) const
+    {
+        unsigned e = m_faces[f].edge;
+        for(int k = 0; k < 3; k++, e = m_edges[e].next)
+        {
+            if(fabsf(distance(plane, m_edges[e].vertex)) > m_tolerance)
+                return false;
+        }
+        return true;
+    }
+
+    bool hullBuilder::kept(const unsigned& e)
+    {
+        return findGroup(m_edges[e].face) != findGroup(m_edges[m_edges[e].twin].face);
+    }
+
+    void hullBuilder::output(convexHull& hull)
+    {
+        // neighbouring triangles become one polygon when each is within tolerance of the plane the other's polygon
+        // started from, comparing against the first plane keeps long runs of nearly flat triangles from bending
+        m_group.resize(m_faces.size());
+        for(unsigned f = 0; f < m_faces.size(); f++)
+        {
+            m_group[f] = f;
+        }
+
+        for(unsigned f = 0; f < m_faces.size(); f++)
+        {
+            if(!m_faces[f].alive)
+                continue;
+
+            unsigned e = m_faces[f].edge;
+            for(int k = 0; k < 3; k++, e = m_edges[e].next)
+            {
+                unsigned twin = m_edges[e].twin;
+                unsigned g = m_edges[twin].face;
+                unsigned rootF = findGroup(f);
+                unsigned rootG = findGroup(g);
+                if(g < f || rootF == rootG || vec3::dot(m_faces[rootF].normal, m_faces[rootG].normal) <= 0.0f)
+                    continue;
+
+                if(onPlane(rootF, g) && onPlane(rootG, f))
+                    m_group[rootG] = rootF;
+            }
+        }
+
+        // only edges between different polygons survive, the next boundary edge is found by walking around
+        // the destination inside the polygon. vertices inside a merged polygon drop out with their edges
+        m_nextBoundary.assign(m_edges.size(), NONE);
+        for(unsigned f = 0; f < m_faces.size(); f++)
+        {
+            if(!m_faces[f].alive)
+                continue;
+
+            unsigned e = m_faces[f].edge;
+            for(int k = 0; k < 3; k++, e = m_edges[e].next)
+            {
+                if(!kept(e))
+                    continue;
+
+                unsigned next = m_edges[e].next;
+                while(!kept(next))
+                {
+                    next = m_edges[m_edges[next].twin].next;
+                }
+                m_nextBoundary[e] = next;
+
+                unsigned& degree = m_vertexMap[m_edges[e].vertex];
+                degree = degree == NONE ? 1 : degree + 1;
+            }
+        }
+
+        // a vertex left with two edges sits on a straight edge between two polygons and is removed as well
+        for(unsigned v = 0; v < m_vertexMap.size(); v++)
+        {
+            if(m_vertexMap[v] == NONE)
+                continue;
+
+            if(m_vertexMap[v] > 2)
+            {
+                m_vertexMap[v] = (unsigned)hull.vertices.size();
+                hull.vertices.push_back(m_points[v]);
+            }
+            else
+            {
+                m_vertexMap[v] = REMOVED;
+            }
+        }
+
+        m_edgeMap.assign(m_edges.size(), NONE);
+        m_faceMap.assign(m_faces.size(), NONE);
+        for(unsigned e = 0; e < m_edges.size(); e++)
+        {
+            if(m_nextBoundary[e] == NONE || m_vertexMap[m_edges[e].vertex] == REMOVED)
+                continue;
+
+            m_edgeMap[e] = (unsigned)hull.edges.size();
+            hull.edges.push_back(hullEdge());
+
+            unsigned root = findGroup(m_edges[e].face);
+            if(m_faceMap[root] == NONE)
+            {
+                m_faceMap[root] = (unsigned)hull.faces.size();
+                hullFace res;
+                res.edge = m_edgeMap[e];
+                hull.faces.push_back(res);
+            }
+        }
+
+        for(unsigned e = 0; e < m_edges.size(); e++)
+        {
+            if(m_edgeMap[e] == NONE)
+                continue;
+
+            // the edge runs on past removed vertices, its twin is the edge leaving the vertex it ends at
+            unsigned last = e;
+            while(m_vertexMap[m_edges[m_nextBoundary[last]].vertex] == REMOVED)
+            {
+                last = m_nextBoundary[last];
+            }
+
+            hullEdge& res = hull.edges[m_edgeMap[e]];
+            res.vertex = m_vertexMap[m_edges[e].vertex];
+            res.twin = m_edgeMap[m_edges[last].twin];
+            res.next = m_edgeMap[m_nextBoundary[last]];
+            res.face = m_faceMap[findGroup(m_edges[e].face)];
+        }
+
+        //https://www.khronos.org/opengl/wiki/Calculating_a_Surface_Normal (newell's method)
+        for(hullFace& f : hull.faces)
+        {
+            vec3 normal(0.0f);
+            vec3 centroid(0.0f);
+            unsigned corners = 0;
+
+            unsigned e = f.edge;
+            do
+            {
+                const vec3& a = hull.vertices[hull.edges[e].vertex];
+                const vec3& b = hull.vertices[hull.edges[hull.edges[e].next].vertex];
+                normal.x += (a.y - b.y) * (a.z + b.z);
+                normal.y += (a.z - b.z) * (a.x + b.x);
+                normal.z += (a.x - b.x) * (a.y + b.y);
+                centroid += a;
+                corners++;
+                e = hull.edges[e].next;
+            }
+            while(e != f.edge);
+
+            f.normal = vec3::normalized(normal);
+            f.distance = vec3::dot(f.normal, centroid / (float)corners);
+        }
+    }
+}
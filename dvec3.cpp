@@ -0,0 +1,205 @@
+#include "m3d/dvec3.h"
+#include "m3d/vec3.h"
+#include <math.h>
+
+namespace m3d
+{
+    dvec3::dvec3() : dvec3(0.0) {};
+    dvec3::dvec3(const double& v) : dvec3(v, v, v) {};
+    dvec3::dvec3(const vec3& v) : dvec3(v.x, v.y, v.z) {};
+    dvec3::dvec3(const double& x, const double& y, const double& z) : x(x), y(y), z(z) {};
+
+    ///////////////////////////////////////
+    //              STATIC               //
+    ///////////////////////////////////////
+
+    double dvec3::distance(const dvec3& a, const dvec3& b)
+    {
+        return dvec3::length(dvec3::sub(a, b));
+    }
+
+    double dvec3::distanceSqr(const dvec3& a, const dvec3& b)
+    {
+        return dvec3::lengthSqr(dvec3::sub(a, b));
+    }
+
+    double dvec3::dot(const dvec3& a, const dvec3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    double dvec3::length(const dvec3& v)
+    {
+        return sqrt(dvec3::lengthSqr(v));
+    }
+
+    double dvec3::lengthSqr(const dvec3& v)
+    {
+        return dvec3::dot(v, v);
+    }
+
+    dvec3 dvec3::lerp(const dvec3& a, const dvec3& b, const double& t)
+    {
+        dvec3 res;
+        res.x = a.x + (b.x - a.x) * t;
+        res.y = a.y + (b.y - a.y) * t;
+        res.z = a.z + (b.z - a.z) * t;
+        return res;
+    }
+
+    vec3 dvec3::relative(const dvec3& a, const dvec3& origin)
+    {
+        return vec3((float)(a.x - origin.x), (float)(a.y - origin.y), (float)(a.z - origin.z));
+    }
+
+    dvec3 dvec3::add(const dvec3& a, const dvec3& b)
+    {
+        dvec3 res;
+        res.x = a.x + b.x;
+        res.y = a.y + b.y;
+        res.z = a.z + b.z;
+        return res;
+    }
+
+    dvec3 dvec3::add(const dvec3& a, const vec3& b)
+    {
+        return dvec3::add(a, dvec3(b));
+    }
+
+    dvec3 dvec3::sub(const dvec3& a, const dvec3& b)
+    {
+        dvec3 res;
+        res.x = a.x - b.x;
+        res.y = a.y - b.y;
+        res.z = a.z - b.z;
+        return res;
+    }
+
+    dvec3 dvec3::sub(const dvec3& a, const vec3& b)
+    {
+        return dvec3::sub(a, dvec3(b));
+    }
+
+    dvec3 dvec3::mul(const dvec3& a, const double& b)
+    {
+        dvec3 res;
+        res.x = a.x * b;
+        res.y = a.y * b;
+        res.z = a.z * b;
+        return res;
+    }
+
+    dvec3 dvec3::div(const dvec3& a, const double& b)
+    {
+        dvec3 res;
+        res.x = a.x / b;
+        res.y = a.y / b;
+        res.z = a.z / b;
+        return res;
+    }
+
+    bool dvec3::equals(const dvec3& a, const dvec3& b)
+    {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    ///////////////////////////////////////
+    //              METHODS              //
+    ///////////////////////////////////////
+
+    double dvec3::length() const
+    {
+        return dvec3::length(*this);
+    }
+
+    double dvec3::lengthSqr() const
+    {
+        return dvec3::lengthSqr(*this);
+    }
+
+    vec3 dvec3::toVec3() const
+    {
+        return vec3((float)x, (float)y, (float)z);
+    }
+}
+
+bool operator==(const m3d::dvec3& a, const m3d::dvec3&b)
+{
+    return m3d::dvec3::equals(a, b);
+}
+
+bool operator!=(const m3d::dvec3& a, const m3d::dvec3&b)
+{
+    return !m3d::dvec3::equals(a, b);
+}
+
+m3d::dvec3 operator-(const m3d::dvec3& a)
+{
+    return m3d::dvec3::mul(a, -1.0);
+}
+
+m3d::dvec3 operator+(const m3d::dvec3& a, const m3d::dvec3& b)
+{
+    return m3d::dvec3::add(a, b);
+}
+
+m3d::dvec3 operator+(const m3d::dvec3& a, const m3d::vec3& b)
+{
+    return m3d::dvec3::add(a, b);
+}
+
+m3d::dvec3 operator-(const m3d::dvec3& a, const m3d::dvec3& b)
+{
+    return m3d::dvec3::sub(a, b);
+}
+
+m3d::dvec3 operator-(const m3d::dvec3& a, const m3d::vec3& b)
+{
+    return m3d::dvec3::sub(a, b);
+}
+
+m3d::dvec3 operator*(const m3d::dvec3& a, const double& b)
+{
+    return m3d::dvec3::mul(a, b);
+}
+
+m3d::dvec3 operator/(const m3d::dvec3& a, const double& b)
+{
+    return m3d::dvec3::div(a, b);
+}
+
+m3d::dvec3& operator+=(m3d::dvec3& a, const m3d::dvec3& b)
+{
+    a = m3d::dvec3::add(a, b);
+    return a;
+}
+
+m3d::dvec3& operator+=(m3d::dvec3& a, const m3d::vec3& b)
+{
+    a = m3d::dvec3::add(a, b);
+    return a;
+}
+
+m3d::dvec3& operator-=(m3d::dvec3& a, const m3d::dvec3& b)
+{
+    a = m3d::dvec3::sub(a, b);
+    return a;
+}
+
+m3d::dvec3& operator-=(m3d::dvec3& a, const m3d::vec3& b)
+{
+    a = m3d::dvec3::sub(a, b);
+    return a;
+}
+
+m3d::dvec3& operator*=(m3d::dvec3& a, const double& b)
+{
+    a = m3d::dvec3::mul(a, b);
+    return a;
+}
+
+m3d::dvec3& operator/=(m3d::dvec3& a, const double& b)
+{
+    a = m3d::dvec3::div(a, b);
+    return a;
+}
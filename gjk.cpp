@@ -0,0 +1,862 @@
+#include "m3d/gjk.h"
+#include "m3d/convexHull.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <float.h>
+#include <math.h>
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GJK_ITERATIONS = 32;
+        const unsigned EPA_ITERATIONS = 64;
+        const unsigned EPA_VERTICES = EPA_ITERATIONS + 4;
+        // a closed triangle mesh has 2 * vertices - 4 faces
+        const unsigned EPA_FACES = 2 * EPA_VERTICES;
+        const unsigned EPA_EDGES = 3 * EPA_FACES;
+        // relative progress below which gjk and epa stop
+        const float GJK_TOLERANCE = 1e-5f;
+        const float EPA_TOLERANCE = 1e-4f;
+        // a tetrahedron whose height is below this fraction of its edges is treated as flat
+        const float FLAT_TOLERANCE = 1e-5f;
+        // cores closer than this, relative to their size, count as touching
+        const float TOUCH_TOLERANCE = 1e-6f;
+        const unsigned GRAIN = 256;
+
+        inline float dot(const vec3& a, const vec3& b)
+        {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        inline vec3 cross(const vec3& a, const vec3& b)
+        {
+            return vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+        }
+
+        inline vec3 sub(const vec3& a, const vec3& b)
+        {
+            return vec3(a.x - b.x, a.y - b.y, a.z - b.z);
+        }
+
+        inline vec3 mad(const vec3& a, const vec3& b, const float& s)
+        {
+            return vec3(a.x + b.x * s, a.y + b.y * s, a.z + b.z * s);
+        }
+
+        // rotation as a row major 3x3 matrix plus a translation
+        struct frame
+        {
+            float r[9];
+            vec3 t;
+
+            vec3 rotate(const vec3& v) const
+            {
+                return vec3(r[0] * v.x + r[1] * v.y + r[2] * v.z,
+                            r[3] * v.x + r[4] * v.y + r[5] * v.z,
+                            r[6] * v.x + r[7] * v.y + r[8] * v.z);
+            }
+
+            vec3 rotateInverse(const vec3& v) const
+            {
+                return vec3(r[0] * v.x + r[3] * v.y + r[6] * v.z,
+                            r[1] * v.x + r[4] * v.y + r[7] * v.z,
+                            r[2] * v.x + r[5] * v.y + r[8] * v.z);
+            }
+
+            vec3 apply(const vec3& v) const
+            {
+                vec3 res = rotate(v);
+                return vec3(res.x + t.x, res.y + t.y, res.z + t.z);
+            }
+        };
+
+        //https://www.euclideanspace.com/maths/geometry/rotations/conversions/quaternionToMatrix/
+        void toMatrix(const quat& q, float* r)
+        {
+            float ii = q.i * q.i, jj = q.j * q.j, kk = q.k * q.k;
+            float ij = q.i * q.j, ik = q.i * q.k, jk = q.j * q.k;
+            float iw = q.i * q.w, jw = q.j * q.w, kw = q.k * q.w;
+
+            r[0] = 1.0f - 2.0f * (jj + kk);
+            r[1] = 2.0f * (ij - kw);
+            r[2] = 2.0f * (ik + jw);
+            r[3] = 2.0f * (ij + kw);
+            r[4] = 1.0f - 2.0f * (ii + kk);
+            r[5] = 2.0f * (jk - iw);
+            r[6] = 2.0f * (ik - jw);
+            r[7] = 2.0f * (jk + iw);
+            r[8] = 1.0f - 2.0f * (ii + jj);
+        }
+
+        // a point of the minkowski difference, w = a - b with a in the space of shape a and b in the space of b
+        struct vertex
+        {
+            vec3 w;
+            vec3 a;
+            vec3 b;
+        };
+
+        struct simplex
+        {
+            vertex v[4];
+            float bary[4];
+            unsigned count;
+        };
+
+        // everything runs in the space of shape a, b is moved into it once per query
+        struct query
+        {
+            const convexShape* a;
+            const convexShape* b;
+            frame world;
+            frame relative;
+            // supports include the radii, only for epa
+            bool margin;
+
+            void setup(const convexShape& shapeA, const vec3& positionA, const quat& rotationA,
+                       const convexShape& shapeB, const vec3& positionB, const quat& rotationB)
+            {
+                a = &shapeA;
+                b = &shapeB;
+                margin = false;
+
+                float rb[9];
+                toMatrix(rotationA, world.r);
+                toMatrix(rotationB, rb);
+                world.t = positionA;
+
+                for(int i = 0; i < 3; i++)
+                {
+                    for(int j = 0; j < 3; j++)
+                    {
+                        relative.r[i * 3 + j] = world.r[i] * rb[j] + world.r[3 + i] * rb[3 + j] + world.r[6 + i] * rb[6 + j];
+                    }
+                }
+                relative.t = world.rotateInverse(sub(positionB, positionA));
+            }
+
+            vertex support(const vec3& d) const
+            {
+                vertex res;
+                vec3 db = relative.rotateInverse(vec3(-d.x, -d.y, -d.z));
+                res.a = convexShape::support(*a, d);
+                res.b = convexShape::support(*b, db);
+
+                if(margin)
+                {
+                    float length = sqrtf(dot(d, d));
+                    if(length > 0.0f)
+                    {
+                        res.a = mad(res.a, d, a->radius / length);
+                        res.b = mad(res.b, db, b->radius / length);
+                    }
+                }
+
+                res.w = sub(res.a, relative.apply(res.b));
+                return res;
+            }
+        };
+
+        vec3 combine(const simplex& s)
+        {
+            vec3 res(0.0f);
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                res = mad(res, s.v[n].w, s.bary[n]);
+            }
+            return res;
+        }
+
+        void keep(simplex& out, const vertex& a, const float& ba)
+        {
+            out.count = 1;
+            out.v[0] = a;
+            out.bary[0] = ba;
+        }
+
+        void keep(simplex& out, const vertex& a, const vertex& b, const float& ba, const float& bb)
+        {
+            out.count = 2;
+            out.v[0] = a;
+            out.v[1] = b;
+            out.bary[0] = ba;
+            out.bary[1] = bb;
+        }
+
+        //Real-Time Collision Detection, Ericson, 5.1.2 - 5.1.6, all with the origin as the query point
+        void segment(const vertex& a, const vertex& b, simplex& out)
+        {
+            vec3 ab = sub(b.w, a.w);
+            float t = -dot(a.w, ab);
+            float length = dot(ab, ab);
+
+            if(t <= 0.0f)
+                keep(out, a, 1.0f);
+            else if(t >= length)
+                keep(out, b, 1.0f);
+            else
+                keep(out, a, b, 1.0f - t / length, t / length);
+        }
+
+        void triangle(const vertex& a, const vertex& b, const vertex& c, simplex& out)
+        {
+            vec3 ab = sub(b.w, a.w);
+            vec3 ac = sub(c.w, a.w);
+
+            float d1 = -dot(ab, a.w);
+            float d2 = -dot(ac, a.w);
+            if(d1 <= 0.0f && d2 <= 0.0f)
+                return keep(out, a, 1.0f);
+
+            float d3 = -dot(ab, b.w);
+            float d4 = -dot(ac, b.w);
+            if(d3 >= 0.0f && d4 <= d3)
+                return keep(out, b, 1.0f);
+
+            float vc = d1 * d4 - d3 * d2;
+            if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            {
+                float v = d1 / (d1 - d3);
+                return keep(out, a, b, 1.0f - v, v);
+            }
+
+            float d5 = -dot(ab, c.w);
+            float d6 = -dot(ac, c.w);
+            if(d6 >= 0.0f && d5 <= d6)
+                return keep(out, c, 1.0f);
+
+            float vb = d5 * d2 - d1 * d6;
+            if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            {
+                float w = d2 / (d2 - d6);
+                return keep(out, a, c, 1.0f - w, w);
+            }
+
+            float va = d3 * d6 - d5 * d4;
+            if(va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+            {
+                float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+                return keep(out, b, c, 1.0f - w, w);
+            }
+
+            float denom = 1.0f / (va + vb + vc);
+            out.count = 3;
+            out.v[0] = a;
+            out.v[1] = b;
+            out.v[2] = c;
+            out.bary[1] = vb * denom;
+            out.bary[2] = vc * denom;
+            out.bary[0] = 1.0f - out.bary[1] - out.bary[2];
+        }
+
+        // returns true when the origin is inside, otherwise out is the closest face, edge or vertex
+        bool tetrahedron(const simplex& in, simplex& out)
+        {
+            // each face with the vertex opposite of it
+            const unsigned faces[4][4] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+
+            bool outside = false;
+            float best = FLT_MAX;
+            for(int f = 0; f < 4; f++)
+            {
+                const vec3& a = in.v[faces[f][0]].w;
+                vec3 n = cross(sub(in.v[faces[f][1]].w, a), sub(in.v[faces[f][2]].w, a));
+                vec3 ad = sub(in.v[faces[f][3]].w, a);
+                float origin = -dot(n, a);
+                float opposite = dot(n, ad);
+
+                // a flat tetrahedron has no inside and the sign of opposite is noise, all of its faces are tested
+                bool flat = opposite * opposite <= FLAT_TOLERANCE * FLAT_TOLERANCE * dot(n, n) * dot(ad, ad);
+                if(!flat && origin * opposite >= 0.0f)
+                    continue;
+
+                outside = true;
+                simplex candidate;
+                triangle(in.v[faces[f][0]], in.v[faces[f][1]], in.v[faces[f][2]], candidate);
+
+                vec3 p = combine(candidate);
+                float distance = dot(p, p);
+                if(distance < best)
+                {
+                    best = distance;
+                    out = candidate;
+                }
+            }
+
+            return !outside;
+        }
+
+        // moves v to the point of the simplex closest to the origin and drops the vertices it does not need,
+        // returns true when the simplex is a tetrahedron around the origin
+        bool closest(simplex& s, vec3& v)
+        {
+            simplex out;
+            switch(s.count)
+            {
+            case 1:
+                s.bary[0] = 1.0f;
+                v = s.v[0].w;
+                return false;
+            case 2:
+                segment(s.v[0], s.v[1], out);
+                break;
+            case 3:
+                triangle(s.v[0], s.v[1], s.v[2], out);
+                break;
+            default:
+                if(tetrahedron(s, out))
+                {
+                    v = vec3(0.0f);
+                    return true;
+                }
+                break;
+            }
+
+            s = out;
+            v = combine(s);
+            return false;
+        }
+
+        //http://realtimecollisiondetection.net/pubs/SIGGRAPH04_Ericson_GJK_notes.pdf
+        // returns true when the cores overlap or touch. earlyOut stops once a direction proves the shapes,
+        // radii included, are apart, s and v are then not the closest
+        bool solve(const query& q, simplex& s, vec3& v, unsigned& iterations, const bool& earlyOut)
+        {
+            if(s.count == 0)
+            {
+                vec3 d = dot(q.relative.t, q.relative.t) > 0.0f ? q.relative.t : vec3(1.0f, 0.0f, 0.0f);
+                s.v[0] = q.support(d);
+                s.count = 1;
+            }
+
+            float radii = q.margin ? 0.0f : q.a->radius + q.b->radius;
+            float scale = 0.0f;
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                scale = fmaxf(scale, dot(s.v[n].w, s.v[n].w));
+            }
+
+            simplex previous;
+            vec3 previousV;
+            float last = FLT_MAX;
+            for(iterations = 0; iterations < GJK_ITERATIONS; iterations++)
+            {
+                if(closest(s, v))
+                    return true;
+
+                float vv = dot(v, v);
+                if(vv <= TOUCH_TOLERANCE * TOUCH_TOLERANCE * scale)
+                    return true;
+
+                // v has to get shorter every step, when rounding stops that the step before is the answer
+                if(vv >= last)
+                {
+                    s = previous;
+                    v = previousV;
+                    return false;
+                }
+
+                vertex w = q.support(vec3(-v.x, -v.y, -v.z));
+                float vw = dot(v, w.w);
+                scale = fmaxf(scale, dot(w.w, w.w));
+
+                if(earlyOut && vw > 0.0f && vw * vw > radii * radii * vv)
+                    return false;
+
+                // no progress along v, v is the closest point
+                if(vv - vw <= GJK_TOLERANCE * vv)
+                    return false;
+
+                for(unsigned n = 0; n < s.count; n++)
+                {
+                    if(s.v[n].w == w.w)
+                        return false;
+                }
+
+                previous = s;
+                previousV = v;
+                last = vv;
+                s.v[s.count++] = w;
+            }
+
+            return false;
+        }
+
+        // grows a simplex that touches the origin into a tetrahedron, false when the difference is flat there
+        bool expand(const query& q, simplex& s)
+        {
+            const vec3 axes[6] = { vec3(1.0f, 0.0f, 0.0f), vec3(-1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f),
+                                   vec3(0.0f, -1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f) };
+
+            float scale = 0.0f;
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                scale = fmaxf(scale, sqrtf(dot(s.v[n].w, s.v[n].w)));
+            }
+            float epsilon = TOUCH_TOLERANCE * fmaxf(scale, 1.0f);
+
+            if(s.count == 1)
+            {
+                for(int n = 0; n < 6 && s.count == 1; n++)
+                {
+                    vertex w = q.support(axes[n]);
+                    vec3 d = sub(w.w, s.v[0].w);
+                    if(dot(d, d) > epsilon * epsilon)
+                        s.v[s.count++] = w;
+                }
+            }
+
+            if(s.count == 2)
+            {
+                vec3 ab = sub(s.v[1].w, s.v[0].w);
+                vec3 e = fabsf(ab.x) < fabsf(ab.y) ? (fabsf(ab.x) < fabsf(ab.z) ? axes[0] : axes[4]) : (fabsf(ab.y) < fabsf(ab.z) ? axes[2] : axes[4]);
+                vec3 p = cross(ab, e);
+                vec3 directions[4] = { p, vec3(-p.x, -p.y, -p.z), cross(ab, p), cross(p, ab) };
+
+                float length = sqrtf(dot(ab, ab));
+                for(int n = 0; n < 4 && s.count == 2; n++)
+                {
+                    vertex w = q.support(directions[n]);
+                    vec3 c = cross(ab, sub(w.w, s.v[0].w));
+                    if(dot(c, c) > epsilon * epsilon * length * length)
+                        s.v[s.count++] = w;
+                }
+            }
+
+            if(s.count == 3)
+            {
+                vec3 n = cross(sub(s.v[1].w, s.v[0].w), sub(s.v[2].w, s.v[0].w));
+                float length = sqrtf(dot(n, n));
+                vec3 directions[2] = { n, vec3(-n.x, -n.y, -n.z) };
+
+                for(int k = 0; k < 2 && s.count == 3; k++)
+                {
+                    vertex w = q.support(directions[k]);
+                    if(fabsf(dot(n, sub(w.w, s.v[0].w))) > epsilon * length)
+                        s.v[s.count++] = w;
+                }
+            }
+
+            return s.count == 4;
+        }
+
+        struct epaFace
+        {
+            unsigned v[3];
+            vec3 normal;
+            float distance;
+        };
+
+        void addFace(const vertex* vertices, epaFace* faces, unsigned& faceCount, const unsigned& a, const unsigned& b, const unsigned& c)
+        {
+            epaFace& f = faces[faceCount++];
+            f.v[0] = a;
+            f.v[1] = b;
+            f.v[2] = c;
+
+            vec3 n = cross(sub(vertices[b].w, vertices[a].w), sub(vertices[c].w, vertices[a].w));
+            float length = sqrtf(dot(n, n));
+
+            // a sliver is never picked or seen, it stays until its neighbours close around it
+            if(length > 0.0f)
+            {
+                f.normal = vec3(n.x / length, n.y / length, n.z / length);
+                f.distance = dot(f.normal, vertices[a].w);
+            }
+            else
+            {
+                f.normal = vec3(0.0f);
+                f.distance = FLT_MAX;
+            }
+        }
+
+        //http://www.dtecta.com/papers/gdc2001depth.pdf
+        // the face of the difference closest to the origin, its normal points from a to b
+        unsigned epa(const query& q, const simplex& s, vertex* vertices, epaFace* faces, unsigned& iterations)
+        {
+            for(int n = 0; n < 4; n++)
+            {
+                vertices[n] = s.v[n];
+            }
+
+            if(dot(cross(sub(vertices[1].w, vertices[0].w), sub(vertices[2].w, vertices[0].w)), sub(vertices[3].w, vertices[0].w)) > 0.0f)
+            {
+                vertex t = vertices[1];
+                vertices[1] = vertices[2];
+                vertices[2] = t;
+            }
+
+            unsigned vertexCount = 4;
+            unsigned faceCount = 0;
+            addFace(vertices, faces, faceCount, 0, 1, 2);
+            addFace(vertices, faces, faceCount, 0, 3, 1);
+            addFace(vertices, faces, faceCount, 0, 2, 3);
+            addFace(vertices, faces, faceCount, 1, 3, 2);
+
+            float scale = 0.0f;
+            for(int n = 0; n < 4; n++)
+            {
+                scale = fmaxf(scale, sqrtf(dot(vertices[n].w, vertices[n].w)));
+            }
+
+            unsigned edges[EPA_EDGES][2];
+            bool visible[EPA_FACES];
+            unsigned best = 0;
+            for(iterations = 0; iterations < EPA_ITERATIONS; iterations++)
+            {
+                best = 0;
+                for(unsigned f = 1; f < faceCount; f++)
+                {
+                    if(faces[f].distance < faces[best].distance)
+                        best = f;
+                }
+
+                vertex w = q.support(faces[best].normal);
+                if(dot(faces[best].normal, w.w) - faces[best].distance <= EPA_TOLERANCE * scale)
+                    break;
+
+                // faces the new point sees go, the edges only one of them has are the horizon
+                unsigned edgeCount = 0;
+                unsigned seen = 0;
+                for(unsigned f = 0; f < faceCount; f++)
+                {
+                    visible[f] = dot(faces[f].normal, sub(w.w, vertices[faces[f].v[0]].w)) > 0.0f;
+                    if(!visible[f])
+                        continue;
+
+                    seen++;
+                    for(int k = 0; k < 3 && edgeCount < EPA_EDGES; k++)
+                    {
+                        unsigned a = faces[f].v[k];
+                        unsigned b = faces[f].v[(k + 1) % 3];
+
+                        unsigned shared = edgeCount;
+                        for(unsigned e = 0; e < edgeCount; e++)
+                        {
+                            if(edges[e][0] == b && edges[e][1] == a)
+                                shared = e;
+                        }
+
+                        if(shared < edgeCount)
+                        {
+                            edgeCount--;
+                            edges[shared][0] = edges[edgeCount][0];
+                            edges[shared][1] = edges[edgeCount][1];
+                        }
+                        else
+                        {
+                            edges[edgeCount][0] = a;
+                            edges[edgeCount][1] = b;
+                            edgeCount++;
+                        }
+                    }
+                }
+
+                // rounding can make the visible faces a ragged patch, stop with the polytope as it is
+                if(faceCount - seen + edgeCount > EPA_FACES)
+                    break;
+
+                unsigned kept = 0;
+                for(unsigned f = 0; f < faceCount; f++)
+                {
+                    if(!visible[f])
+                        faces[kept++] = faces[f];
+                }
+                faceCount = kept;
+
+                vertices[vertexCount] = w;
+                for(unsigned e = 0; e < edgeCount; e++)
+                {
+                    addFace(vertices, faces, faceCount, edges[e][0], edges[e][1], vertexCount);
+                }
+                vertexCount++;
+
+                if(vertexCount == EPA_VERTICES)
+                    break;
+            }
+
+            best = 0;
+            for(unsigned f = 1; f < faceCount; f++)
+            {
+                if(faces[f].distance < faces[best].distance)
+                    best = f;
+            }
+
+            return best;
+        }
+
+        void store(gjkCache* cache, const simplex& s)
+        {
+            if(cache == nullptr)
+                return;
+
+            cache->count = s.count;
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                cache->a[n] = s.v[n].a;
+                cache->b[n] = s.v[n].b;
+            }
+        }
+
+        void restore(const query& q, const gjkCache* cache, simplex& s)
+        {
+            s.count = 0;
+            if(cache == nullptr)
+                return;
+
+            s.count = cache->count;
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                s.v[n].a = cache->a[n];
+                s.v[n].b = cache->b[n];
+                s.v[n].w = sub(s.v[n].a, q.relative.apply(s.v[n].b));
+            }
+        }
+
+        // closest points from the simplex gjk ended with, in the space of a
+        void separated(const query& q, const simplex& s, const vec3& v, gjkResult& result)
+        {
+            vec3 pa(0.0f), pb(0.0f);
+            for(unsigned n = 0; n < s.count; n++)
+            {
+                pa = mad(pa, s.v[n].a, s.bary[n]);
+                pb = mad(pb, q.relative.apply(s.v[n].b), s.bary[n]);
+            }
+
+            float length = sqrtf(dot(v, v));
+            vec3 normal = vec3(-v.x / length, -v.y / length, -v.z / length);
+            pa = mad(pa, normal, q.a->radius);
+            pb = mad(pb, normal, -q.b->radius);
+
+            result.distance = length - q.a->radius - q.b->radius;
+            result.pointA = q.world.apply(pa);
+            result.pointB = q.world.apply(pb);
+            result.normal = q.world.rotate(normal);
+            result.intersecting = result.distance <= 0.0f;
+        }
+
+        void overlapping(const query& q, gjkResult& result)
+        {
+            result.distance = 0.0f;
+            result.pointA = q.world.t;
+            result.pointB = q.world.t;
+            result.normal = q.world.rotate(vec3(0.0f, 1.0f, 0.0f));
+            result.intersecting = true;
+        }
+    }
+
+    ///////////////////////////////////////
+    //              SHAPES               //
+    ///////////////////////////////////////
+
+    convexShape convexShape::sphere(const float& radius)
+    {
+        convexShape res;
+        res.type = SPHERE;
+        res.radius = radius;
+        res.extents = vec3(0.0f);
+        res.hull = nullptr;
+        return res;
+    }
+
+    convexShape convexShape::capsule(const float& radius, const float& halfHeight)
+    {
+        convexShape res;
+        res.type = CAPSULE;
+        res.radius = radius;
+        res.extents = vec3(0.0f, halfHeight, 0.0f);
+        res.hull = nullptr;
+        return res;
+    }
+
+    convexShape convexShape::box(const vec3& halfExtents, const float& radius)
+    {
+        convexShape res;
+        res.type = BOX;
+        res.radius = radius;
+        res.extents = halfExtents;
+        res.hull = nullptr;
+        return res;
+    }
+
+    convexShape convexShape::convex(const convexHull& hull, const float& radius)
+    {
+        convexShape res;
+        res.type = HULL;
+        res.radius = radius;
+        res.extents = vec3(0.0f);
+        res.hull = &hull;
+        return res;
+    }
+
+    vec3 convexShape::support(const convexShape& shape, const vec3& direction)
+    {
+        switch(shape.type)
+        {
+        case CAPSULE:
+            return vec3(0.0f, direction.y >= 0.0f ? shape.extents.y : -shape.extents.y, 0.0f);
+        case BOX:
+            return vec3(direction.x >= 0.0f ? shape.extents.x : -shape.extents.x,
+                        direction.y >= 0.0f ? shape.extents.y : -shape.extents.y,
+                        direction.z >= 0.0f ? shape.extents.z : -shape.extents.z);
+        case HULL:
+        {
+            const std::vector<vec3>& vertices = shape.hull->vertices;
+            unsigned best = 0;
+            float bestDot = -FLT_MAX;
+            for(unsigned n = 0; n < vertices.size(); n++)
+            {
+                float d = dot(vertices[n], direction);
+                if(d > bestDot)
+                {
+                    bestDot = d;
+                    best = n;
+                }
+            }
+            return vertices.empty() ? vec3(0.0f) : vertices[best];
+        }
+        default:
+            return vec3(0.0f);
+        }
+    }
+
+    ///////////////////////////////////////
+    //              QUERIES              //
+    ///////////////////////////////////////
+
+    bool gjk::intersect(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                        const convexShape& b, const vec3& positionB, const quat& rotationB, gjkCache* cache)
+    {
+        M3D_PROFILE("gjk::intersect");
+
+        query q;
+        q.setup(a, positionA, rotationA, b, positionB, rotationB);
+
+        simplex s;
+        vec3 v;
+        unsigned iterations;
+        restore(q, cache, s);
+        bool overlap = solve(q, s, v, iterations, true);
+        store(cache, s);
+
+        float radii = a.radius + b.radius;
+        return overlap || dot(v, v) <= radii * radii;
+    }
+
+    bool gjk::distance(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                       const convexShape& b, const vec3& positionB, const quat& rotationB, gjkResult& result, gjkCache* cache)
+    {
+        M3D_PROFILE("gjk::distance");
+
+        query q;
+        q.setup(a, positionA, rotationA, b, positionB, rotationB);
+
+        simplex s;
+        vec3 v;
+        restore(q, cache, s);
+        bool overlap = solve(q, s, v, result.iterations, false);
+        store(cache, s);
+
+        if(overlap)
+            overlapping(q, result);
+        else
+            separated(q, s, v, result);
+
+        return result.intersecting;
+    }
+
+    bool gjk::penetration(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                          const convexShape& b, const vec3& positionB, const quat& rotationB, gjkResult& result, gjkCache* cache)
+    {
+        M3D_PROFILE("gjk::penetration");
+
+        query q;
+        q.setup(a, positionA, rotationA, b, positionB, rotationB);
+
+        simplex s;
+        vec3 v;
+        restore(q, cache, s);
+        bool overlap = solve(q, s, v, result.iterations, false);
+        store(cache, s);
+
+        if(!overlap)
+        {
+            separated(q, s, v, result);
+            return result.intersecting;
+        }
+
+        // the cores overlap, epa needs a simplex around the origin built from the full shapes
+        if(a.radius > 0.0f || b.radius > 0.0f)
+        {
+            unsigned iterations;
+            q.margin = true;
+            s.count = 0;
+            solve(q, s, v, iterations, false);
+            result.iterations += iterations;
+        }
+
+        if(!expand(q, s))
+        {
+            overlapping(q, result);
+            return true;
+        }
+
+        vertex vertices[EPA_VERTICES];
+        epaFace faces[EPA_FACES];
+        unsigned iterations;
+        unsigned best = epa(q, s, vertices, faces, iterations);
+        result.iterations += iterations;
+
+        const epaFace& f = faces[best];
+        if(f.distance == FLT_MAX)
+        {
+            overlapping(q, result);
+            return true;
+        }
+
+        //Real-Time Collision Detection, Ericson, 3.4
+        const vertex& va = vertices[f.v[0]];
+        const vertex& vb = vertices[f.v[1]];
+        const vertex& vc = vertices[f.v[2]];
+        vec3 p(f.normal.x * f.distance, f.normal.y * f.distance, f.normal.z * f.distance);
+        vec3 e0 = sub(vb.w, va.w), e1 = sub(vc.w, va.w), e2 = sub(p, va.w);
+        float d00 = dot(e0, e0), d01 = dot(e0, e1), d11 = dot(e1, e1), d20 = dot(e2, e0), d21 = dot(e2, e1);
+        float denom = d00 * d11 - d01 * d01;
+        float bv = denom != 0.0f ? (d11 * d20 - d01 * d21) / denom : 0.0f;
+        float bw = denom != 0.0f ? (d00 * d21 - d01 * d20) / denom : 0.0f;
+        float bu = 1.0f - bv - bw;
+
+        vec3 pa = mad(mad(vec3(va.a.x * bu, va.a.y * bu, va.a.z * bu), vb.a, bv), vc.a, bw);
+        vec3 pb = mad(mad(q.relative.apply(va.b) * bu, q.relative.apply(vb.b), bv), q.relative.apply(vc.b), bw);
+
+        result.distance = -f.distance;
+        result.pointA = q.world.apply(pa);
+        result.pointB = q.world.apply(pb);
+        result.normal = q.world.rotate(f.normal);
+        result.intersecting = true;
+        return true;
+    }
+
+    void gjk::penetration(const gjkPair* pairs, gjkResult* results, gjkCache* caches, const unsigned& count)
+    {
+        M3D_PROFILE("gjk::penetration(batch)");
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            const gjkPair& p = pairs[n];
+            penetration(*p.a, p.positionA, p.rotationA, *p.b, p.positionB, p.rotationB, results[n], caches ? caches + n : nullptr);
+        }
+    }
+
+    void gjk::penetrationParallel(const gjkPair* pairs, gjkResult* results, gjkCache* caches, const unsigned& count)
+    {
+        M3D_PROFILE("gjk::penetrationParallel");
+
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            penetration(pairs + begin, results + begin, caches ? caches + begin : nullptr, end - begin);
+        });
+    }
+}
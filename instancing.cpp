@@ -0,0 +1,176 @@
+#include "m3d/instancing.h"
+#include "m3d/mat3x3.h"
+#include "m3d/mat4x4.h"
+#include "m3d/affine.h"
+#include "m3d/parallel.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 4096;
+
+#ifdef M3D_COLUMN_MAJOR
+        // storage is m[col][row], column j of the result is the viewProj columns weighted by column j of the model
+        inline void mulColumn(const mat4x4& a, const float& b0, const float& b1, const float& b2, const float& b3, float* res)
+        {
+#ifdef __SSE__
+            __m128 r = _mm_mul_ps(_mm_loadu_ps(a.m[0]), _mm_set1_ps(b0));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m[1]), _mm_set1_ps(b1)));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m[2]), _mm_set1_ps(b2)));
+            r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(a.m[3]), _mm_set1_ps(b3)));
+            _mm_storeu_ps(res, r);
+#else
+            for(int i = 0; i < 4; i++)
+            {
+                res[i] = a.m[0][i] * b0 + a.m[1][i] * b1 + a.m[2][i] * b2 + a.m[3][i] * b3;
+            }
+#endif // __SSE__
+        }
+
+        inline void mul(const mat4x4& a, const mat4x4& b, mat4x4& res)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                mulColumn(a, b.m[j][0], b.m[j][1], b.m[j][2], b.m[j][3], res.m[j]);
+            }
+        }
+
+        inline void mul(const mat4x4& a, const affine& b, mat4x4& res)
+        {
+            for(int j = 0; j < 4; j++)
+            {
+                mulColumn(a, b.m[0][j], b.m[1][j], b.m[2][j], j == 3 ? 1.0f : 0.0f, res.m[j]);
+            }
+        }
+#else
+        // storage is m[row][col], row i of the result is the model rows weighted by row i of viewProj,
+        // the model rows are loaded once and reused for all four output rows
+        inline void mulRows(const mat4x4& a, const float (*b)[4], const bool& affineB, float (*res)[4])
+        {
+#ifdef __SSE__
+            __m128 b0 = _mm_loadu_ps(b[0]);
+            __m128 b1 = _mm_loadu_ps(b[1]);
+            __m128 b2 = _mm_loadu_ps(b[2]);
+            __m128 b3 = affineB ? _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f) : _mm_loadu_ps(b[3]);
+
+            for(int i = 0; i < 4; i++)
+            {
+                __m128 r = _mm_mul_ps(_mm_set1_ps(a.m[i][0]), b0);
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.m[i][1]), b1));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.m[i][2]), b2));
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a.m[i][3]), b3));
+                _mm_storeu_ps(res[i], r);
+            }
+#else
+            const float last[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            const float* b3 = affineB ? last : b[3];
+
+            for(int i = 0; i < 4; i++)
+            {
+                for(int j = 0; j < 4; j++)
+                {
+                    res[i][j] = a.m[i][0] * b[0][j] + a.m[i][1] * b[1][j] + a.m[i][2] * b[2][j] + a.m[i][3] * b3[j];
+                }
+            }
+#endif // __SSE__
+        }
+
+        inline void mul(const mat4x4& a, const mat4x4& b, mat4x4& res)
+        {
+            mulRows(a, b.m, false, res.m);
+        }
+
+        inline void mul(const mat4x4& a, const affine& b, mat4x4& res)
+        {
+            mulRows(a, b.m, true, res.m);
+        }
+#endif // M3D_COLUMN_MAJOR
+
+        // inverse transpose through the cofactors, rows r0 r1 r2 give r1 x r2, r2 x r0, r0 x r1 over the determinant
+        template<class T>
+        inline void cofactors(const T& m, mat3x3& res)
+        {
+            float c[3][3];
+
+            c[0][0] = m.at(1, 1) * m.at(2, 2) - m.at(1, 2) * m.at(2, 1);
+            c[0][1] = m.at(1, 2) * m.at(2, 0) - m.at(1, 0) * m.at(2, 2);
+            c[0][2] = m.at(1, 0) * m.at(2, 1) - m.at(1, 1) * m.at(2, 0);
+
+            c[1][0] = m.at(2, 1) * m.at(0, 2) - m.at(2, 2) * m.at(0, 1);
+            c[1][1] = m.at(2, 2) * m.at(0, 0) - m.at(2, 0) * m.at(0, 2);
+            c[1][2] = m.at(2, 0) * m.at(0, 1) - m.at(2, 1) * m.at(0, 0);
+
+            c[2][0] = m.at(0, 1) * m.at(1, 2) - m.at(0, 2) * m.at(1, 1);
+            c[2][1] = m.at(0, 2) * m.at(1, 0) - m.at(0, 0) * m.at(1, 2);
+            c[2][2] = m.at(0, 0) * m.at(1, 1) - m.at(0, 1) * m.at(1, 0);
+
+            float det = m.at(0, 0) * c[0][0] + m.at(0, 1) * c[0][1] + m.at(0, 2) * c[0][2];
+            float invDet = det != 0.0f ? 1.0f / det : 1.0f;
+
+            for(int i = 0; i < 3; i++)
+            {
+                for(int j = 0; j < 3; j++)
+                {
+                    res.at(i, j) = c[i][j] * invDet;
+                }
+            }
+        }
+    }
+
+    void instancing::mvp(const mat4x4& viewProj, const mat4x4* models, mat4x4* mvps, mat3x3* normals, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+        {
+            mul(viewProj, models[n], mvps[n]);
+
+            if(normals)
+                cofactors(models[n], normals[n]);
+        }
+    }
+
+    void instancing::mvp(const mat4x4& viewProj, const affine* models, mat4x4* mvps, mat3x3* normals, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+        {
+            mul(viewProj, models[n], mvps[n]);
+
+            if(normals)
+                cofactors(models[n], normals[n]);
+        }
+    }
+
+    void instancing::mvpParallel(const mat4x4& viewProj, const mat4x4* models, mat4x4* mvps, mat3x3* normals, const unsigned& count)
+    {
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            instancing::mvp(viewProj, models + begin, mvps + begin, normals ? normals + begin : nullptr, end - begin);
+        });
+    }
+
+    void instancing::mvpParallel(const mat4x4& viewProj, const affine* models, mat4x4* mvps, mat3x3* normals, const unsigned& count)
+    {
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            instancing::mvp(viewProj, models + begin, mvps + begin, normals ? normals + begin : nullptr, end - begin);
+        });
+    }
+
+    mat3x3 instancing::normalMatrix(const mat4x4& model)
+    {
+        mat3x3 res;
+        cofactors(model, res);
+        return res;
+    }
+
+    mat3x3 instancing::normalMatrix(const affine& model)
+    {
+        mat3x3 res;
+        cofactors(model, res);
+        return res;
+    }
+}
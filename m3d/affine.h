@@ -0,0 +1,35 @@
+#pragma once
+
+namespace m3d
+{
+    class vec3;
+    class mat3x3;
+    class mat4x4;
+    class transform;
+    // the top three rows of a mat4x4, the last row is always 0 0 0 1
+    // always stored m[row][col], with M3D_COLUMN_MAJOR too, so it uploads as a row_major mat4x3
+    class affine
+    {
+    public:
+        float m[3][4] = {0};
+
+        float& at(const int& row, const int& col) { return m[row][col]; }
+        const float& at(const int& row, const int& col) const { return m[row][col]; }
+
+        affine();
+        affine(const float& diagonal);
+
+        static affine fromMat4x4(const mat4x4& m);
+        static affine fromTransform(const transform& t);
+
+        static affine mul(const affine& a, const affine& b);
+        static vec3 mulPoint(const affine& a, const vec3& b);
+        static vec3 mulDirection(const affine& a, const vec3& b);
+
+        mat3x3 toMat3x3() const;
+        mat4x4 toMat4x4() const;
+    };
+}
+
+m3d::affine operator*(const m3d::affine& a, const m3d::affine& b);
+m3d::affine& operator*=(m3d::affine& a, const m3d::affine& b);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>
+#include <new>
+
+/** ------------- frame arena
+    linear allocator for transient batch buffers. the memory is reserved and touched once up front,
+    allocations are a pointer bump and reset() frees everything at the end of the frame.
+    allocations return uninitialized memory, the batch functions only write into it.
+
+    the batch apis take caller owned pointers for everything they write, so their outputs can come straight from
+    an arena. kernels that need scratch (particles::compactParallel, triangleBVH::build, meshNormals) keep it in
+    members that only grow, and parallelFor takes a non owning rangeFunction on a persistent pool, so a steady
+    state frame does no heap allocation */
+
+namespace m3d
+{
+    class arena
+    {
+    public:
+        static const size_t ALIGNMENT = 64;
+
+        arena(const size_t& capacity);
+        ~arena();
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        // returns null when the arena is full
+        void* allocate(const size_t& size, const size_t& alignment = ALIGNMENT);
+
+        template <typename T> T* allocate(const size_t& count)
+        {
+            return (T*)allocate(sizeof(T) * count, alignof(T) > ALIGNMENT ? alignof(T) : ALIGNMENT);
+        }
+
+        void reset();
+
+        // rewind to an earlier point for scoped scratch memory
+        size_t mark() const;
+        void rewind(const size_t& marker);
+
+        size_t used() const;
+        size_t capacity() const;
+        // largest used() since construction, for sizing the arena
+        size_t highWater() const;
+
+    private:
+        char* m_memory;
+        char* m_base;
+        size_t m_capacity;
+        size_t m_offset;
+        size_t m_highWater;
+    };
+
+    // adapts an arena for standard containers, deallocation is a no-op until the arena is reset
+    template <typename T> class arenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        arenaAllocator(arena& memory) : memory(&memory) {};
+        template <typename U> arenaAllocator(const arenaAllocator<U>& other) : memory(other.memory) {};
+
+        T* allocate(size_t count)
+        {
+            T* res = memory->allocate<T>(count);
+            if(res == nullptr)
+                throw std::bad_alloc();
+            return res;
+        }
+
+        void deallocate(T*, size_t) {};
+
+        arena* memory;
+    };
+
+    template <typename T, typename U> bool operator==(const arenaAllocator<T>& a, const arenaAllocator<U>& b)
+    {
+        return a.memory == b.memory;
+    }
+
+    template <typename T, typename U> bool operator!=(const arenaAllocator<T>& a, const arenaAllocator<U>& b)
+    {
+        return a.memory != b.memory;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/** ------------- binary animation clips
+    a clip is a header, an index of tracks and 16 byte aligned key data.
+    keys are stored with the in memory layout of vec3 / quat / transform so a clip
+    can be memory mapped and used in place, nothing is copied or allocated on load.
+    the format is little endian */
+
+namespace m3d
+{
+    class vec3;
+    class quat;
+    class transform;
+    class clip
+    {
+    public:
+        static const uint32_t VERSION = 1;
+
+        enum trackType
+        {
+            TRACK_VEC3 = 0,
+            TRACK_QUAT = 1,
+            TRACK_TRANSFORM = 2
+        };
+
+        clip();
+        ~clip();
+
+        clip(const clip&) = delete;
+        clip& operator=(const clip&) = delete;
+
+        // use a clip image already in memory, the memory must outlive the clip.
+        // false for empty tracks, unsorted or repeated ids, descending key times and data past the end
+        bool load(const void* data, const size_t& size);
+        // memory maps the file
+        bool open(const char* path);
+        void close();
+
+        unsigned trackCount() const;
+        float duration() const;
+        // tracks are sorted by id, returns -1 when not found
+        int findTrack(const uint32_t& id) const;
+
+        uint32_t trackId(const unsigned& track) const;
+        trackType type(const unsigned& track) const;
+        unsigned keyCount(const unsigned& track) const;
+        const float* times(const unsigned& track) const;
+
+        // null when the track holds a different type
+        const vec3* vec3Keys(const unsigned& track) const;
+        const quat* quatKeys(const unsigned& track) const;
+        const transform* transformKeys(const unsigned& track) const;
+
+        vec3 sampleVec3(const unsigned& track, const float& time) const;
+        quat sampleQuat(const unsigned& track, const float& time) const;
+        transform sampleTransform(const unsigned& track, const float& time) const;
+
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        void* m_mapping;
+
+        const void* entry(const unsigned& track) const;
+        unsigned findKey(const unsigned& track, const float& time, float& t) const;
+    };
+
+    class clipWriter
+    {
+    public:
+        // tracks without keys are skipped, a track with an id already added replaces it
+        void addTrack(const uint32_t& id, const float* times, const vec3* keys, const unsigned& count);
+        void addTrack(const uint32_t& id, const float* times, const quat* keys, const unsigned& count);
+        void addTrack(const uint32_t& id, const float* times, const transform* keys, const unsigned& count);
+
+        size_t size() const;
+        // dst must hold size() bytes
+        void write(void* dst) const;
+        bool save(const char* path) const;
+
+    private:
+        struct track
+        {
+            uint32_t id;
+            uint32_t type;
+            uint32_t keyCount;
+            std::vector<float> times;
+            std::vector<uint8_t> keys;
+        };
+
+        std::vector<track> m_tracks;
+
+        void addTrack(const uint32_t& id, const uint32_t& type, const float* times, const void* keys, const size_t& keySize, const unsigned& count);
+    };
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <float.h>
+#include <stdint.h>
+#include <vector>
+
+/** ------------- closest points
+    closest points on segments, triangles and boxes, for a single point or for structure of arrays point streams.
+    triangles use the voronoi region walk from real-time collision detection 5.1.5, the stream versions evaluate
+    every region for four points at once and keep the one the walk would have stopped at.
+
+    triangleBVH answers the same question against a whole mesh, a bounding volume tree whose leaves are packets
+    of four triangles tested together */
+
+namespace m3d
+{
+    class vec3;
+    class quat;
+
+    struct pointStreams
+    {
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+
+    struct closestStreams
+    {
+        float* x;
+        float* y;
+        float* z;
+        // squared distance to the closest point, null to skip
+        float* distanceSqr;
+    };
+
+    struct triangleStreams
+    {
+        const float* ax;
+        const float* ay;
+        const float* az;
+        const float* bx;
+        const float* by;
+        const float* bz;
+        const float* cx;
+        const float* cy;
+        const float* cz;
+    };
+
+    class closestPoint
+    {
+    public:
+        static vec3 segment(const vec3& p, const vec3& a, const vec3& b);
+        static vec3 triangle(const vec3& p, const vec3& a, const vec3& b, const vec3& c);
+        static vec3 box(const vec3& p, const vec3& min, const vec3& max);
+        static vec3 box(const vec3& p, const vec3& center, const vec3& halfExtents, const quat& rotation);
+
+        // every point against one shape
+        static void segment(const pointStreams& points, const unsigned& count, const vec3& a, const vec3& b, const closestStreams& res);
+        static void triangle(const pointStreams& points, const unsigned& count, const vec3& a, const vec3& b, const vec3& c, const closestStreams& res);
+        static void box(const pointStreams& points, const unsigned& count, const vec3& min, const vec3& max, const closestStreams& res);
+        static void box(const pointStreams& points, const unsigned& count, const vec3& center, const vec3& halfExtents, const quat& rotation, const closestStreams& res);
+
+        // point n against triangle n
+        static void triangles(const pointStreams& points, const triangleStreams& triangles, const unsigned& count, const closestStreams& res);
+    };
+
+    class triangleBVH
+    {
+    public:
+        static const unsigned NONE = 0xffffffffu;
+
+        triangleBVH();
+
+        // positions as structure of arrays, three indices per triangle
+        void build(const float* x, const float* y, const float* z, const uint32_t* indices, const unsigned& triangleCount);
+
+        unsigned triangleCount() const;
+        unsigned nodeCount() const;
+
+        /** ------------- closest
+            the closest point on the mesh for every point. a point with nothing within maxDistance gets triangle NONE,
+            itself as the closest point and maxDistance squared as the distance.
+            triangles can be null, a small maxDistance makes the search a lot cheaper */
+        void closest(const pointStreams& points, const unsigned& count, const closestStreams& res, unsigned* triangles, const float& maxDistance = FLT_MAX) const;
+        void closestParallel(const pointStreams& points, const unsigned& count, const closestStreams& res, unsigned* triangles, const float& maxDistance = FLT_MAX) const;
+
+    private:
+        struct node
+        {
+            float min[3];
+            // first of the two children, or the packet of a leaf
+            unsigned index;
+            float max[3];
+            // triangles in a leaf, 0 for inner nodes
+            unsigned count;
+        };
+
+        std::vector<node> m_nodes;
+        // four triangles per packet stored as ax[4] ay[4] az[4] bx[4] .. cz[4], short leaves repeat their last triangle
+        std::vector<float> m_packets;
+        // the mesh triangle in each packet lane
+        std::vector<unsigned> m_lanes;
+        // build scratch, kept so rebuilding every frame does not allocate
+        std::vector<float> m_centroids;
+        std::vector<unsigned> m_order;
+        unsigned m_triangleCount;
+
+        void buildNode(const unsigned& index, unsigned* order, const unsigned& begin, const unsigned& end,
+                       const float* x, const float* y, const float* z, const uint32_t* indices, const float* centroids);
+        void query(const float* p, const float& maxDistanceSqr, float* res, unsigned& triangle) const;
+    };
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "vec3.h"
+
+#include <vector>
+
+/** ------------- quickhull
+    convex hulls of 3d point sets. the hull starts as a tetrahedron and grows by adding the point farthest outside
+    any face. points closer to a face than the tolerance count as on it, so nearly coplanar input does not
+    produce slivers or flipped faces, and coplanar triangles are merged into polygons at the end.
+
+    a hullBuilder keeps its faces, edges and conflict lists between builds,
+    so building thousands of hulls with one builder stops allocating after the first few */
+
+namespace m3d
+{
+    struct hullEdge
+    {
+        // origin vertex, the destination is the origin of next
+        unsigned vertex;
+        unsigned twin;
+        unsigned next;
+        unsigned face;
+    };
+
+    struct hullFace
+    {
+        // any edge of the face, following next walks the face counter clockwise seen from outside
+        unsigned edge;
+        vec3 normal;
+        // dot(normal, p) for every p on the face
+        float distance;
+    };
+
+    class convexHull
+    {
+    public:
+        std::vector<vec3> vertices;
+        std::vector<hullEdge> edges;
+        std::vector<hullFace> faces;
+
+        void clear();
+
+        static bool contains(const convexHull& hull, const vec3& p, const float& tolerance = 0.0f);
+    };
+
+    class hullBuilder
+    {
+    public:
+        static const unsigned NONE = 0xffffffffu;
+
+        /** ------------- build
+            maxVertices stops the hull growing at that many vertices, 0 for no limit. because the farthest point
+            is always added next, a limited hull is a good simplification of the full one.
+            returns false and clears the hull when the points are flat, on a line or fewer than four */
+        bool build(const vec3* points, const unsigned& count, convexHull& hull, const unsigned& maxVertices = 0);
+
+        // the distance tolerance of the last build, scaled by the extent of the points
+        float tolerance() const;
+
+    private:
+        struct face
+        {
+            unsigned edge;
+            vec3 normal;
+            float distance;
+            // points outside this face linked through m_nextConflict, every point is on at most one list
+            unsigned conflicts;
+            unsigned farthest;
+            float farthestDistance;
+            // counts reuses of the slot so old heap entries can be told apart
+            unsigned generation;
+            bool alive;
+            bool visible;
+        };
+
+        struct pending
+        {
+            float distance;
+            unsigned face;
+            unsigned generation;
+
+            bool operator<(const pending& other) const
+            {
+                return distance < other.distance;
+            }
+        };
+
+        struct visit
+        {
+            unsigned face;
+            unsigned edge;
+            unsigned remaining;
+        };
+
+        const vec3* m_points;
+        float m_tolerance;
+
+        std::vector<face> m_faces;
+        std::vector<hullEdge> m_edges;
+        std::vector<unsigned> m_freeFaces;
+        std::vector<unsigned> m_freeEdges;
+        std::vector<unsigned> m_nextConflict;
+
+        std::vector<visit> m_stack;
+        std::vector<unsigned> m_visible;
+        std::vector<unsigned> m_horizon;
+        std::vector<unsigned> m_created;
+        std::vector<pending> m_pending;
+        std::vector<unsigned> m_group;
+        std::vector<unsigned> m_vertexMap;
+        std::vector<unsigned> m_edgeMap;
+        std::vector<unsigned> m_nextBoundary;
+        std::vector<unsigned> m_faceMap;
+
+        bool initialSimplex(const unsigned& count);
+        unsigned addFace(const unsigned& a, const unsigned& b, const unsigned& c);
+        unsigned allocateEdge();
+        void addConflict(const unsigned& f, const unsigned& point, const float& distance);
+        float distance(const unsigned& f, const unsigned& point) const;
+        void addPoint(const unsigned& eye, const unsigned& eyeFace);
+        void output(convexHull& hull);
+        unsigned findGroup(unsigned f);
+        bool onPlane(const unsigned& plane, const unsigned& f) const;
+        bool kept(const unsigned& e);
+    };
+}
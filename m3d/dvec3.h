@@ -0,0 +1,61 @@
+#pragma once
+
+namespace m3d
+{
+    class vec3;
+    // double precision position for large worlds, convert to vec3 relative to a nearby origin before rendering
+    class dvec3
+    {
+    public:
+
+        double x, y, z;
+
+        dvec3();
+        dvec3(const double& v);
+        dvec3(const vec3& v);
+        dvec3(const double& x, const double& y, const double& z);
+
+        static double distance(const dvec3& a, const dvec3& b);
+        static double distanceSqr(const dvec3& a, const dvec3& b);
+        static double dot(const dvec3& a, const dvec3& b);
+        static double length(const dvec3& v);
+        static double lengthSqr(const dvec3& v);
+        static dvec3 lerp(const dvec3& a, const dvec3& b, const double& t);
+
+        // a - origin in float, the subtraction is done in double
+        static vec3 relative(const dvec3& a, const dvec3& origin);
+
+        static dvec3 add(const dvec3& a, const dvec3& b);
+        static dvec3 add(const dvec3& a, const vec3& b);
+        static dvec3 sub(const dvec3& a, const dvec3& b);
+        static dvec3 sub(const dvec3& a, const vec3& b);
+        static dvec3 mul(const dvec3& a, const double& b);
+        static dvec3 div(const dvec3& a, const double& b);
+
+        static bool equals(const dvec3& a, const dvec3& b);
+
+        double length() const;
+        double lengthSqr() const;
+
+        vec3 toVec3() const;
+    };
+}
+
+bool operator==(const m3d::dvec3& a, const m3d::dvec3&b);
+bool operator!=(const m3d::dvec3& a, const m3d::dvec3&b);
+
+m3d::dvec3 operator-(const m3d::dvec3& a);
+
+m3d::dvec3 operator+(const m3d::dvec3& a, const m3d::dvec3& b);
+m3d::dvec3 operator+(const m3d::dvec3& a, const m3d::vec3& b);
+m3d::dvec3 operator-(const m3d::dvec3& a, const m3d::dvec3& b);
+m3d::dvec3 operator-(const m3d::dvec3& a, const m3d::vec3& b);
+m3d::dvec3 operator*(const m3d::dvec3& a, const double& b);
+m3d::dvec3 operator/(const m3d::dvec3& a, const double& b);
+
+m3d::dvec3& operator+=(m3d::dvec3& a, const m3d::dvec3& b);
+m3d::dvec3& operator+=(m3d::dvec3& a, const m3d::vec3& b);
+m3d::dvec3& operator-=(m3d::dvec3& a, const m3d::dvec3& b);
+m3d::dvec3& operator-=(m3d::dvec3& a, const m3d::vec3& b);
+m3d::dvec3& operator*=(m3d::dvec3& a, const double& b);
+m3d::dvec3& operator/=(m3d::dvec3& a, const double& b);
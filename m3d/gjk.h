@@ -0,0 +1,99 @@
+#pragma once
+
+#include "vec3.h"
+#include "quat.h"
+
+/** ------------- gjk and epa
+    distance, intersection and penetration queries between convex shapes placed with a position and rotation.
+    gjk finds the distance, epa the penetration depth and normal once the shapes overlap.
+
+    every shape is a core grown by its radius, a sphere is a point and a capsule a segment. gjk runs on the cores
+    and subtracts the radii, so rounded shapes that only overlap in their margins never need epa.
+
+    a gjkCache per pair keeps the simplex a query ended with. the next query starts from it, for pairs that
+    barely moved since the last step that is usually the answer after one support call */
+
+namespace m3d
+{
+    class convexHull;
+
+    class convexShape
+    {
+    public:
+        enum kind
+        {
+            SPHERE = 0,
+            CAPSULE = 1,
+            BOX = 2,
+            HULL = 3
+        };
+
+        kind type;
+        float radius;
+        // box half extents, a capsule is the segment from -extents.y to extents.y on the y axis
+        vec3 extents;
+        const convexHull* hull;
+
+        static convexShape sphere(const float& radius);
+        static convexShape capsule(const float& radius, const float& halfHeight);
+        static convexShape box(const vec3& halfExtents, const float& radius = 0.0f);
+        // the hull has to outlive the shape
+        static convexShape convex(const convexHull& hull, const float& radius = 0.0f);
+
+        // farthest point of the core along a local direction, the direction does not have to be normalized
+        static vec3 support(const convexShape& shape, const vec3& direction);
+    };
+
+    struct gjkCache
+    {
+        // support points on each core in their local space, count 0 starts a query from scratch
+        unsigned count;
+        vec3 a[4];
+        vec3 b[4];
+
+        gjkCache() : count(0) {};
+    };
+
+    struct gjkResult
+    {
+        // negative when the shapes overlap and the query computed the depth
+        float distance;
+        // world space closest points, or the deepest points when overlapping
+        vec3 pointA;
+        vec3 pointB;
+        // unit world normal from a towards b
+        vec3 normal;
+        unsigned iterations;
+        bool intersecting;
+    };
+
+    struct gjkPair
+    {
+        const convexShape* a;
+        const convexShape* b;
+        vec3 positionA;
+        quat rotationA;
+        vec3 positionB;
+        quat rotationB;
+    };
+
+    class gjk
+    {
+    public:
+        // stops at the first separating direction, cheaper than distance when only the answer is needed
+        static bool intersect(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                              const convexShape& b, const vec3& positionB, const quat& rotationB, gjkCache* cache = nullptr);
+
+        // distance and closest points. when the cores overlap intersecting is set and distance is 0, penetration finds the depth
+        static bool distance(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                             const convexShape& b, const vec3& positionB, const quat& rotationB, gjkResult& result, gjkCache* cache = nullptr);
+
+        // distance like above, but overlapping shapes get the epa depth as a negative distance
+        static bool penetration(const convexShape& a, const vec3& positionA, const quat& rotationA,
+                                const convexShape& b, const vec3& positionB, const quat& rotationB, gjkResult& result, gjkCache* cache = nullptr);
+
+        // caches can be null, otherwise one per pair
+        static void penetration(const gjkPair* pairs, gjkResult* results, gjkCache* caches, const unsigned& count);
+        static void penetrationParallel(const gjkPair* pairs, gjkResult* results, gjkCache* caches, const unsigned& count);
+    };
+}
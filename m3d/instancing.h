@@ -0,0 +1,25 @@
+#pragma once
+
+/** ------------- instanced transforms
+    mvp[n] = viewProj * models[n], written straight into the output arrays.
+    normals[n] is the inverse transpose of the model's upper 3x3 and is skipped when normals is null */
+
+namespace m3d
+{
+    class mat3x3;
+    class mat4x4;
+    class affine;
+    class instancing
+    {
+    public:
+        static void mvp(const mat4x4& viewProj, const mat4x4* models, mat4x4* mvps, mat3x3* normals, const unsigned& count);
+        static void mvp(const mat4x4& viewProj, const affine* models, mat4x4* mvps, mat3x3* normals, const unsigned& count);
+
+        // split over parallelFor
+        static void mvpParallel(const mat4x4& viewProj, const mat4x4* models, mat4x4* mvps, mat3x3* normals, const unsigned& count);
+        static void mvpParallel(const mat4x4& viewProj, const affine* models, mat4x4* mvps, mat3x3* normals, const unsigned& count);
+
+        static mat3x3 normalMatrix(const mat4x4& model);
+        static mat3x3 normalMatrix(const affine& model);
+    };
+}
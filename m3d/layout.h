@@ -0,0 +1,22 @@
+#pragma once
+
+/** ------------- matrix storage order
+    mat3x3 and mat4x4 store m[row][col] by default.
+    define M3D_COLUMN_MAJOR for the whole build to store m[col][row] instead, which is the order
+    glsl/hlsl buffers expect, so matrices can be copied to the gpu without a transpose.
+    at(row, col) reads the same element with either order, m is only the raw storage */
+
+#ifdef M3D_COLUMN_MAJOR
+#define M3D_ELEMENT(m, row, col) m[col][row]
+#else
+#define M3D_ELEMENT(m, row, col) m[row][col]
+#endif // M3D_COLUMN_MAJOR
+
+namespace m3d
+{
+#ifdef M3D_COLUMN_MAJOR
+    const bool COLUMN_MAJOR = true;
+#else
+    const bool COLUMN_MAJOR = false;
+#endif // M3D_COLUMN_MAJOR
+}
@@ -2,9 +2,36 @@
 
 
 #include "math1D.h"
+#include "layout.h"
+#include "arena.h"
+#include "profile.h"
 #include "vec2.h"
 #include "vec3.h"
+#include "dvec3.h"
 #include "vec4.h"
 #include "quat.h"
 #include "mat3x3.h"
 #include "mat4x4.h"
+#include "transform.h"
+#include "affine.h"
+#include "ray.h"
+#include "rebase.h"
+#include "quantize.h"
+#include "packed.h"
+#include "clip.h"
+#include "pointCloud.h"
+#include "parallel.h"
+#include "instancing.h"
+#include "sprites.h"
+#include "rigidBodies.h"
+#include "particles.h"
+#include "meshNormals.h"
+#include "convexHull.h"
+#include "gjk.h"
+#include "closestPoint.h"
+#include "spline.h"
+#include "quatSpline.h"
+#include "noise.h"
+#include "philox.h"
+#include "transformStore.h"
+#include "upload.h"
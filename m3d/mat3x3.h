@@ -1,5 +1,7 @@
 #pragma once
 
+#include "layout.h"
+
 namespace m3d
 {
     class vec2;
@@ -11,6 +13,9 @@ namespace m3d
     public:
         float m[3][3] = {0};
 
+        float& at(const int& row, const int& col) { return M3D_ELEMENT(m, row, col); }
+        const float& at(const int& row, const int& col) const { return M3D_ELEMENT(m, row, col); }
+
         mat3x3();
         mat3x3(const float& diagonal);
 
@@ -23,6 +28,17 @@ namespace m3d
 
         static mat3x3 fromMat4x4(const mat4x4& m);
 
+        static float determinant(const mat3x3& m);
+        static mat3x3 transpose(const mat3x3& m);
+        // all zero when m is singular
+        static mat3x3 inverse(const mat3x3& m);
+
+        /** ------------- polar decomposition
+            m = rotation * stretch with rotation orthonormal and stretch symmetric, the stretch holds scale and shear.
+            scaled newton iteration (Higham), false when m is singular or it does not converge.
+            rotation is a reflection when m has a negative determinant */
+        static bool polarDecompose(const mat3x3& m, mat3x3& rotation, mat3x3& stretch);
+
         mat3x3& rotate(const float& radians);
         mat3x3& scale(const vec2& scale);
         mat3x3& translate(const vec2& translation);
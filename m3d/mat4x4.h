@@ -1,5 +1,7 @@
 #pragma once
 
+#include "layout.h"
+
 namespace m3d
 {
     class vec3;
@@ -11,12 +13,21 @@ namespace m3d
     public:
         float m[4][4] = {0};
 
+        float& at(const int& row, const int& col) { return M3D_ELEMENT(m, row, col); }
+        const float& at(const int& row, const int& col) const { return M3D_ELEMENT(m, row, col); }
+
         mat4x4();
         mat4x4(const float& diagonal);
 
         static mat4x4 initOrtho(const float& r, const float& l, const float& t, const float& b, const float& n, const float& f);
         static mat4x4 initOrthoCentered(const float& w, const float& h, const float& n, const float& f);
         static mat4x4 initPerspective(const float& w, const float& h, const float& fov, const float& n, const float& f);
+        // depth 1 at the near plane and 0 at the far plane, for a [0, 1] depth range with a greater depth test
+        static mat4x4 initPerspectiveReverseZ(const float& w, const float& h, const float& fov, const float& n, const float& f);
+        // initPerspective with the far plane at infinity
+        static mat4x4 initPerspectiveInfinite(const float& w, const float& h, const float& fov, const float& n);
+        // initPerspectiveReverseZ with the far plane at infinity, depth n / -z
+        static mat4x4 initPerspectiveInfiniteReverseZ(const float& w, const float& h, const float& fov, const float& n);
 
         static mat4x4 lookat(const vec3& from, const vec3& to, const vec3& up);
 
@@ -25,7 +36,12 @@ namespace m3d
 
         static mat4x4 fromMat3x3(const mat3x3& m);
 
+        // general inverse, all zero when mat is singular
+        static mat4x4 inverse(const mat4x4& mat);
+        // inverse of a matrix whose last row is 0 0 0 1
         static mat4x4 inverseHomogeneous(const mat4x4& mat);
+        // closed form inverse of any of the initPerspective matrices
+        static mat4x4 inversePerspective(const mat4x4& mat);
 
         mat4x4& rotateX(const float& rotation);
         mat4x4& rotateY(const float& rotation);
@@ -1,5 +1,17 @@
 #pragma once
 
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
 #define PI 3.1415926535897
 #define TO_RADS (PI / 180.0)
 #define TO_DEGS (180.0 / PI)
@@ -14,4 +26,123 @@ namespace m3d
     {
         return (T(0) < val) - (val < T(0));
     }
+
+    /** ------------- fast approximations
+        branch free so batch loops can inline and vectorize them.
+        see bench/accuracy.cpp for their measured error */
+
+    // cephes style polynomials after a Cody-Waite reduction by pi/2, a few ulp for |x| < 8192
+    inline void fastSincos(const float& x, float& s, float& c)
+    {
+        // round to the nearest quadrant, truncation avoids a call to floorf
+        int quadrant = (int)(x * 0.63661977f + copysignf(0.5f, x));
+        float q = (float)quadrant;
+
+        float r = x - q * 1.5703125f;
+        r = r - q * 4.837512969970703125e-4f;
+        r = r - q * 7.54978995489188216e-8f;
+        float r2 = r * r;
+
+        float sr = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        float cr = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+        // swap on odd quadrants and flip the signs through the sign bit
+        uint32_t srBits, crBits;
+        memcpy(&srBits, &sr, sizeof(srBits));
+        memcpy(&crBits, &cr, sizeof(crBits));
+
+        uint32_t swap = 0u - (uint32_t)(quadrant & 1);
+        uint32_t sBits = (srBits & ~swap) | (crBits & swap);
+        uint32_t cBits = (crBits & ~swap) | (srBits & swap);
+        sBits ^= (uint32_t)(quadrant & 2) << 30;
+        cBits ^= (uint32_t)((quadrant + 1) & 2) << 30;
+
+        memcpy(&s, &sBits, sizeof(s));
+        memcpy(&c, &cBits, sizeof(c));
+    }
+
+#ifdef __SSE2__
+    // fastSincos on four values, same steps lane for lane
+    inline void fastSincos4(const __m128& x, __m128& s, __m128& c)
+    {
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+
+        __m128 half = _mm_or_ps(_mm_and_ps(x, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+        __m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(0.63661977f)), half));
+        __m128 q = _mm_cvtepi32_ps(quadrant);
+
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(q, _mm_set1_ps(1.5703125f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(4.837512969970703125e-4f)));
+        r = _mm_sub_ps(r, _mm_mul_ps(q, _mm_set1_ps(7.54978995489188216e-8f)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 sp = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+        sp = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, sp));
+        __m128 sr = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), sp));
+
+        __m128 cp = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+        cp = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, cp));
+        __m128 cr = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2));
+        cr = _mm_add_ps(cr, _mm_mul_ps(_mm_mul_ps(r2, r2), cp));
+
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sv = _mm_or_ps(_mm_andnot_ps(swap, sr), _mm_and_ps(swap, cr));
+        __m128 cv = _mm_or_ps(_mm_andnot_ps(swap, cr), _mm_and_ps(swap, sr));
+
+        s = _mm_xor_ps(sv, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30)));
+        c = _mm_xor_ps(cv, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30)));
+    }
+#endif // __SSE2__
+
+    inline float fastSin(const float& x)
+    {
+        float s, c;
+        fastSincos(x, s, c);
+        return s;
+    }
+
+    inline float fastCos(const float& x)
+    {
+        float s, c;
+        fastSincos(x, s, c);
+        return c;
+    }
+
+    // Abramowitz and Stegun 4.4.46, |error| < 2e-8 radians before rounding
+    inline float fastAcos(const float& x)
+    {
+        float a = fminf(fabsf(x), 1.0f);
+        float p = -0.0012624911f;
+        p = p * a + 0.0066700901f;
+        p = p * a - 0.0170881256f;
+        p = p * a + 0.0308918810f;
+        p = p * a - 0.0501743046f;
+        p = p * a + 0.0889789874f;
+        p = p * a - 0.2145988016f;
+        p = p * a + 1.5707963050f;
+        float res = sqrtf(1.0f - a) * p;
+        return x < 0.0f ? 3.14159265f - res : res;
+    }
+
+    // hardware estimate plus one newton step, the portable bit trick needs three
+    inline float fastRsqrt(const float& x)
+    {
+#ifdef __SSE__
+        float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+        return y * (1.5f - 0.5f * x * y * y);
+#else
+        uint32_t i;
+        memcpy(&i, &x, sizeof(i));
+        i = 0x5f375a86 - (i >> 1);
+        float y;
+        memcpy(&y, &i, sizeof(y));
+
+        float half = 0.5f * x;
+        y = y * (1.5f - half * y * y);
+        y = y * (1.5f - half * y * y);
+        y = y * (1.5f - half * y * y);
+        return y;
+#endif // __SSE__
+    }
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/** ------------- mesh normals and tangents
+    vertex normals and tangents over an index buffer and structure of arrays vertex streams.
+    instead of scattering every triangle into its three vertices, each triangle first writes its own face values,
+    then each vertex gathers the faces around it through a vertex to corner list built once per topology.
+    both passes write only their own entries, so the parallel versions need no atomics or locks.
+
+    tangents follow the order of operations of mikktspace.c: the unit face tangent from the uv derivatives is
+    projected onto the plane of the vertex normal, weighted by the corner angle between the projected edges and
+    summed, then normalized. faces are grouped by uv winding as in MikkTSpace and w is the sign of the group, so
+    bitangent = w * cross(normal, tangent). faces with no uv area do not contribute.
+
+    MikkTSpace gives a vertex shared by both windings (a mirror seam) one tangent per group, a single index can
+    only hold one. such vertices take the group with the larger angle sum and are reported, split them in the
+    index buffer to match baked normal maps exactly. vertices that share a position but not an index are not merged */
+
+namespace m3d
+{
+    class meshNormals
+    {
+    public:
+        enum weighting
+        {
+            WEIGHT_AREA = 0,
+            WEIGHT_ANGLE = 1
+        };
+
+        // builds the vertex to corner lists, again only when the topology changes
+        void build(const uint32_t* indices, const unsigned& triangleCount, const unsigned& vertexCount);
+
+        unsigned triangleCount() const;
+        unsigned vertexCount() const;
+
+        void normals(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting);
+        void normalsParallel(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting);
+
+        // n are the vertex normals, from normals or the mesh, tw is +1 or -1. returns the number of vertices whose
+        // faces mix both uv windings, mixed gets 1 for them and 0 for the rest when not null
+        unsigned tangents(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                          const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed = nullptr);
+        unsigned tangentsParallel(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                                  const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed = nullptr);
+
+    private:
+        std::vector<uint32_t> m_indices;
+        // corners of vertex n are m_corners[m_offsets[n]] to m_corners[m_offsets[n + 1]], corner = triangle * 3 + k
+        std::vector<unsigned> m_offsets;
+        std::vector<unsigned> m_corners;
+
+        // per triangle scratch, xyz of the face vector and one weight per corner (the uv winding for tangents)
+        std::vector<float> m_faceA;
+        std::vector<float> m_weights;
+
+        void computeNormals(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting, const bool& parallel);
+        unsigned computeTangents(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                                 const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed, const bool& parallel);
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+/** ------------- noise
+    perlin gradient noise and simplex noise in 2d, 3d and 4d, with analytic derivatives and fbm.
+    every kernel is written once over a lane type, a float for single points and four sse2 lanes for the batches,
+    with the same operations in the same order, so the scalar and vector paths return the same bits as long as
+    the compiler does not contract them into fma.
+
+    lattice points are hashed with integer arithmetic, no permutation table, so there is no gather and the
+    pattern repeats every 2^32 cells. values are roughly in [-1, 1], 4d perlin is scaled to its bound so it stays
+    inside and peaks near 0.9 in practice. fbm divides by the sum of its amplitudes */
+
+namespace m3d
+{
+    class vec2;
+    class vec3;
+    class vec4;
+
+    // structure of arrays sample positions, the coordinates past the dimension are not read
+    struct noiseStreams
+    {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* w;
+    };
+
+    // gradient streams past the dimension, or all of them, can be null
+    struct noiseOutput
+    {
+        float* value;
+        float* dx;
+        float* dy;
+        float* dz;
+        float* dw;
+    };
+
+    struct fbmSettings
+    {
+        unsigned octaves;
+        float frequency;
+        float lacunarity;
+        float gain;
+
+        // a single octave, plain noise
+        fbmSettings();
+        fbmSettings(const unsigned& octaves, const float& frequency = 1.0f, const float& lacunarity = 2.0f, const float& gain = 0.5f);
+    };
+
+    class noise
+    {
+    public:
+        enum type
+        {
+            PERLIN = 0,
+            SIMPLEX = 1
+        };
+
+        static float perlin(const vec2& p, vec2* gradient = nullptr, const uint32_t& seed = 0);
+        static float perlin(const vec3& p, vec3* gradient = nullptr, const uint32_t& seed = 0);
+        static float perlin(const vec4& p, vec4* gradient = nullptr, const uint32_t& seed = 0);
+        static float simplex(const vec2& p, vec2* gradient = nullptr, const uint32_t& seed = 0);
+        static float simplex(const vec3& p, vec3* gradient = nullptr, const uint32_t& seed = 0);
+        static float simplex(const vec4& p, vec4* gradient = nullptr, const uint32_t& seed = 0);
+
+        static float fbm(const type& kind, const vec2& p, const fbmSettings& settings, vec2* gradient = nullptr, const uint32_t& seed = 0);
+        static float fbm(const type& kind, const vec3& p, const fbmSettings& settings, vec3* gradient = nullptr, const uint32_t& seed = 0);
+
+        // dimensions is 2, 3 or 4. false and nothing written for anything else
+        static bool evaluate(const type& kind, const unsigned& dimensions, const noiseStreams& points, const unsigned& count,
+                             const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+        static bool evaluateParallel(const type& kind, const unsigned& dimensions, const noiseStreams& points, const unsigned& count,
+                                     const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+
+        // samples at origin + (column, row, slice) * step, row major, res holds width * height (* depth) values
+        static void grid(const type& kind, const vec2& origin, const vec2& step, const unsigned& width, const unsigned& height,
+                         const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+        static void grid(const type& kind, const vec3& origin, const vec3& step, const unsigned& width, const unsigned& height, const unsigned& depth,
+                         const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+        static void gridParallel(const type& kind, const vec2& origin, const vec2& step, const unsigned& width, const unsigned& height,
+                                 const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+        static void gridParallel(const type& kind, const vec3& origin, const vec3& step, const unsigned& width, const unsigned& height, const unsigned& depth,
+                                 const noiseOutput& res, const fbmSettings& settings = fbmSettings(), const uint32_t& seed = 0);
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+
+/** ------------- packed vertex attribute formats
+    octahedral unit vectors, IEEE half floats and 8/16 bit snorm/unorm.
+    the batch functions take vector streams and write count * components packed values. they run four or more
+    values at a time with sse2 and return the same bits as the single value functions */
+
+namespace m3d
+{
+    class vec2;
+    class vec3;
+    class vec4;
+    class packed
+    {
+    public:
+        static uint16_t floatToHalf(const float& v);
+        static float halfToFloat(const uint16_t& v);
+
+        // unit vector -> point in the [-1, 1] square
+        static vec2 octahedralEncode(const vec3& v);
+        static vec3 octahedralDecode(const vec2& v);
+        // octahedral square stored as 2 x snorm16, x in the low bits
+        static uint32_t packOctahedral(const vec3& v);
+        static vec3 unpackOctahedral(const uint32_t& v);
+
+        static int8_t packSnorm8(const float& v);
+        static float unpackSnorm8(const int8_t& v);
+        static uint8_t packUnorm8(const float& v);
+        static float unpackUnorm8(const uint8_t& v);
+        static int16_t packSnorm16(const float& v);
+        static float unpackSnorm16(const int16_t& v);
+        static uint16_t packUnorm16(const float& v);
+        static float unpackUnorm16(const uint16_t& v);
+
+        static void packOctahedral(const vec3* in, uint32_t* out, const unsigned& count);
+        static void unpackOctahedral(const uint32_t* in, vec3* out, const unsigned& count);
+
+        // uses F16C when the compiler targets it (-mf16c, not set by m3d.cbp), sse2 otherwise. with F16C a nan can
+        // come out with another payload than floatToHalf / halfToFloat give, every other value matches
+        static void packHalf(const float* in, uint16_t* out, const unsigned& count);
+        static void packHalf(const vec2* in, uint16_t* out, const unsigned& count);
+        static void packHalf(const vec3* in, uint16_t* out, const unsigned& count);
+        static void packHalf(const vec4* in, uint16_t* out, const unsigned& count);
+        static void unpackHalf(const uint16_t* in, float* out, const unsigned& count);
+        static void unpackHalf(const uint16_t* in, vec2* out, const unsigned& count);
+        static void unpackHalf(const uint16_t* in, vec3* out, const unsigned& count);
+        static void unpackHalf(const uint16_t* in, vec4* out, const unsigned& count);
+
+        static void packSnorm8(const float* in, int8_t* out, const unsigned& count);
+        static void packSnorm8(const vec2* in, int8_t* out, const unsigned& count);
+        static void packSnorm8(const vec3* in, int8_t* out, const unsigned& count);
+        static void packSnorm8(const vec4* in, int8_t* out, const unsigned& count);
+        static void unpackSnorm8(const int8_t* in, float* out, const unsigned& count);
+        static void unpackSnorm8(const int8_t* in, vec2* out, const unsigned& count);
+        static void unpackSnorm8(const int8_t* in, vec3* out, const unsigned& count);
+        static void unpackSnorm8(const int8_t* in, vec4* out, const unsigned& count);
+
+        static void packUnorm8(const float* in, uint8_t* out, const unsigned& count);
+        static void packUnorm8(const vec2* in, uint8_t* out, const unsigned& count);
+        static void packUnorm8(const vec3* in, uint8_t* out, const unsigned& count);
+        static void packUnorm8(const vec4* in, uint8_t* out, const unsigned& count);
+        static void unpackUnorm8(const uint8_t* in, float* out, const unsigned& count);
+        static void unpackUnorm8(const uint8_t* in, vec2* out, const unsigned& count);
+        static void unpackUnorm8(const uint8_t* in, vec3* out, const unsigned& count);
+        static void unpackUnorm8(const uint8_t* in, vec4* out, const unsigned& count);
+
+        static void packSnorm16(const float* in, int16_t* out, const unsigned& count);
+        static void packSnorm16(const vec2* in, int16_t* out, const unsigned& count);
+        static void packSnorm16(const vec3* in, int16_t* out, const unsigned& count);
+        static void packSnorm16(const vec4* in, int16_t* out, const unsigned& count);
+        static void unpackSnorm16(const int16_t* in, float* out, const unsigned& count);
+        static void unpackSnorm16(const int16_t* in, vec2* out, const unsigned& count);
+        static void unpackSnorm16(const int16_t* in, vec3* out, const unsigned& count);
+        static void unpackSnorm16(const int16_t* in, vec4* out, const unsigned& count);
+
+        static void packUnorm16(const float* in, uint16_t* out, const unsigned& count);
+        static void packUnorm16(const vec2* in, uint16_t* out, const unsigned& count);
+        static void packUnorm16(const vec3* in, uint16_t* out, const unsigned& count);
+        static void packUnorm16(const vec4* in, uint16_t* out, const unsigned& count);
+        static void unpackUnorm16(const uint16_t* in, float* out, const unsigned& count);
+        static void unpackUnorm16(const uint16_t* in, vec2* out, const unsigned& count);
+        static void unpackUnorm16(const uint16_t* in, vec3* out, const unsigned& count);
+        static void unpackUnorm16(const uint16_t* in, vec4* out, const unsigned& count);
+    };
+}
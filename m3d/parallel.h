@@ -0,0 +1,41 @@
+#pragma once
+
+#include <type_traits>
+
+/** ------------- parallel ranges
+    the batch kernels take plain [begin, end) ranges so they can run on any job system.
+    parallelFor is the simple default, it splits a range over a pool of hardware threads started on first use
+    and kept until exit, the calling thread takes ranges too. a parallelFor called from inside another one, or
+    while another thread's call owns the pool, runs its whole range inline */
+
+namespace m3d
+{
+    // non owning reference to anything callable with (begin, end). unlike std::function it never allocates,
+    // so passing a lambda to parallelFor costs nothing. it must not outlive the callable
+    class rangeFunction
+    {
+    public:
+        template <typename F, typename = typename std::enable_if<!std::is_same<F, rangeFunction>::value>::type>
+        rangeFunction(const F& fn) : m_object(&fn), m_call(&call<F>) {};
+
+        void operator()(const unsigned& begin, const unsigned& end) const
+        {
+            m_call(m_object, begin, end);
+        }
+
+    private:
+        const void* m_object;
+        void (*m_call)(const void*, const unsigned&, const unsigned&);
+
+        template <typename F> static void call(const void* fn, const unsigned& begin, const unsigned& end)
+        {
+            (*(const F*)fn)(begin, end);
+        }
+    };
+
+    unsigned threadCount();
+
+    // ranges are at least grain elements long, small counts run inline. when fn throws, the ranges not started yet
+    // are skipped and the first exception is rethrown on the calling thread once every running range returned
+    void parallelFor(const unsigned& count, const unsigned& grain, const rangeFunction& fn);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+/** ------------- particles
+    particle state as structure of arrays. update applies gravity, drag, plane collisions and ageing
+    in a single pass, four particles per instruction. particles whose life has run out stay in place
+    until compact moves the living ones down so the arrays stay dense and in their original order.
+    the parallel versions split into fixed chunks, each chunk writes only its own range so no locks are needed */
+
+namespace m3d
+{
+    class vec3;
+    class vec4;
+
+    struct particleForces
+    {
+        float gravity[3];
+        // fraction of the velocity lost per second
+        float drag;
+        // (normal, distance) with dot(normal, p) + distance >= 0 on the open side, null for none
+        const vec4* planes;
+        unsigned planeCount;
+        // kept fraction of the normal velocity after a bounce
+        float restitution;
+    };
+
+    class particles
+    {
+    public:
+        std::vector<float> x, y, z;
+        std::vector<float> vx, vy, vz;
+        // seconds left, dead at or below 0
+        std::vector<float> life;
+
+        unsigned add(const vec3& position, const vec3& velocity, const float& life);
+        void resize(const unsigned& count);
+        void clear();
+        unsigned count() const;
+
+        void update(const float& dt, const particleForces& forces);
+        // particles [begin, end) only, for running on a job system
+        void update(const unsigned& begin, const unsigned& end, const float& dt, const particleForces& forces);
+        void updateParallel(const float& dt, const particleForces& forces);
+
+        // removes dead particles in place, returns the new count
+        unsigned compact();
+        // per chunk survivor lists, a prefix sum for the offsets, then every chunk copies its survivors into a second set of arrays
+        unsigned compactParallel();
+
+    private:
+        std::vector<float> m_x, m_y, m_z;
+        std::vector<float> m_vx, m_vy, m_vz;
+        std::vector<float> m_life;
+        std::vector<unsigned> m_index;
+        // survivor offsets per chunk for compactParallel, kept so steady state compaction does not allocate
+        std::vector<unsigned> m_offsets;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+
+/** ------------- counter based random numbers
+    philox4x32-10 from "parallel random numbers: as easy as 1, 2, 3" (salmon et al.). every output is a pure function
+    of the key, made of the seed and a stream id, and a 64 bit counter. element n of a batch uses counter first + n,
+    so results do not depend on how a batch is split across threads and any range can be generated on its own.
+
+    batches run four counters per instruction with sse2. every distribution takes the words of a single counter
+    and angles go through fastSincos, so the scalar and vector paths give the same values. directions are
+    around +z, rotate them into the frame they are needed in */
+
+namespace m3d
+{
+    class vec2;
+    class vec3;
+    class quat;
+
+    // components past the ones a distribution produces are not written and can be null
+    struct randomStreams
+    {
+        float* x;
+        float* y;
+        float* z;
+        float* w;
+    };
+
+    class philox
+    {
+    public:
+        enum distribution
+        {
+            // x in [0, 1)
+            UNIFORM = 0,
+            // xyz on the unit sphere
+            UNIT_VECTOR = 1,
+            // xyz on the unit hemisphere with z > 0
+            HEMISPHERE = 2,
+            // xyz on the hemisphere, density proportional to z
+            COSINE_HEMISPHERE = 3,
+            // xy in the unit disc
+            DISC = 4,
+            // xyzw the i j k w of a uniformly distributed rotation
+            ROTATION = 5
+        };
+
+        philox(const uint64_t& seed, const uint32_t& stream = 0);
+
+        // the four raw words of one counter
+        void words(const uint64_t& counter, uint32_t* res) const;
+
+        float uniform(const uint64_t& counter) const;
+        vec3 unitVector(const uint64_t& counter) const;
+        vec3 hemisphere(const uint64_t& counter) const;
+        vec3 cosineHemisphere(const uint64_t& counter) const;
+        vec2 disc(const uint64_t& counter) const;
+        quat rotation(const uint64_t& counter) const;
+
+        // element n uses counter first + n
+        void generate(const distribution& kind, const randomStreams& res, const unsigned& count, const uint64_t& first = 0) const;
+        void generateParallel(const distribution& kind, const randomStreams& res, const unsigned& count, const uint64_t& first = 0) const;
+
+    private:
+        uint32_t m_key[2];
+        uint32_t m_stream;
+    };
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+/** ------------- streamed point clouds
+    point clouds are read as fixed size structure of arrays chunks so they never have to fit in memory.
+    the next chunk is read on a background thread while the current one is processed.
+
+    binary layout, little endian:
+        header  magic "M3DP", version, flags (1 = normals), chunk size, point count (uint64)
+        chunks  uint32 count, then x[count] y[count] z[count] and nx[count] ny[count] nz[count] with normals
+
+    chunk sizes are limited to 4m points (2^22), files and importers asking for more fail to open */
+
+namespace m3d
+{
+    class vec3;
+
+    struct pointChunk
+    {
+        unsigned count;
+        float* x;
+        float* y;
+        float* z;
+        // null without normals
+        float* nx;
+        float* ny;
+        float* nz;
+    };
+
+    class pointStream
+    {
+    public:
+        pointStream();
+        virtual ~pointStream();
+
+        pointStream(const pointStream&) = delete;
+        pointStream& operator=(const pointStream&) = delete;
+
+        // the chunk stays valid until the next call, returns null at the end of the stream or on a read error
+        const pointChunk* next();
+        void close();
+
+        unsigned chunkSize() const;
+        bool hasNormals() const;
+        // true once next() returned null because the source was truncated or malformed
+        bool failed() const;
+
+    protected:
+        // allocates both buffers and starts the read ahead thread
+        void start(const unsigned& chunkSize, const bool& normals);
+        // called on the read ahead thread, returns the number of points read, 0 at the end.
+        // an error is reported with fail() before returning 0
+        virtual unsigned fill(pointChunk& chunk) = 0;
+        virtual void closeSource() = 0;
+        void fail();
+
+    private:
+        struct slot
+        {
+            pointChunk chunk;
+            std::vector<float> storage;
+            bool ready;
+        };
+
+        slot m_slots[2];
+        unsigned m_current;
+        bool m_consuming;
+        bool m_stop;
+        unsigned m_chunkSize;
+        bool m_normals;
+        // set on the read ahead thread
+        std::atomic<bool> m_failed;
+
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_cond;
+
+        void readAhead();
+    };
+
+    class pointCloudReader : public pointStream
+    {
+    public:
+        pointCloudReader();
+        ~pointCloudReader();
+
+        bool open(const char* path);
+        uint64_t pointCount() const;
+
+    protected:
+        unsigned fill(pointChunk& chunk);
+        void closeSource();
+
+    private:
+        FILE* m_file;
+        uint64_t m_pointCount;
+        uint64_t m_read;
+    };
+
+    // ascii xyz (x y z [nx ny nz] per line) and ascii ply
+    class pointCloudImporter : public pointStream
+    {
+    public:
+        pointCloudImporter();
+        ~pointCloudImporter();
+
+        bool open(const char* path, const unsigned& chunkSize = 65536);
+
+    protected:
+        unsigned fill(pointChunk& chunk);
+        void closeSource();
+
+    private:
+        FILE* m_file;
+        uint64_t m_remaining;
+        int m_columns[6];
+        unsigned m_columnCount;
+        // values a line needs for its position
+        unsigned m_required;
+    };
+
+    class pointCloudWriter
+    {
+    public:
+        pointCloudWriter();
+        ~pointCloudWriter();
+
+        pointCloudWriter(const pointCloudWriter&) = delete;
+        pointCloudWriter& operator=(const pointCloudWriter&) = delete;
+
+        bool open(const char* path, const unsigned& chunkSize, const bool& normals);
+        // normals may be null when the file has none
+        void write(const vec3* points, const vec3* normals, const unsigned& count);
+        void write(const pointChunk& chunk);
+        // flushes the last chunk and patches the point count
+        bool close();
+
+    private:
+        FILE* m_file;
+        unsigned m_chunkSize;
+        bool m_normals;
+        uint64_t m_pointCount;
+        unsigned m_buffered;
+        std::vector<float> m_buffer;
+        bool m_failed;
+
+        void flush();
+    };
+}
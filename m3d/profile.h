@@ -0,0 +1,94 @@
+#pragma once
+
+/** ------------- call counters
+    build the library with M3D_INSTRUMENT to count calls of the hot functions per thread,
+    M3D_INSTRUMENT_CYCLES also samples rdtsc cycles every M3D_INSTRUMENT_SAMPLE_RATE calls (power of two, default 1).
+    cycles are inclusive of nested instrumented calls.
+    without M3D_INSTRUMENT the macro expands to nothing and nothing is compiled in */
+
+#ifdef M3D_INSTRUMENT
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+
+#ifndef M3D_INSTRUMENT_SAMPLE_RATE
+#define M3D_INSTRUMENT_SAMPLE_RATE 1
+#endif // M3D_INSTRUMENT_SAMPLE_RATE
+
+namespace m3d
+{
+    class profile
+    {
+    public:
+        static const unsigned MAX_COUNTERS = 128;
+
+        // only the owning thread writes, relaxed atomics let report() read them safely
+        struct counter
+        {
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> samples;
+            std::atomic<uint64_t> cycles;
+        };
+
+        struct totals
+        {
+            const char* name;
+            uint64_t calls;
+            uint64_t samples;
+            uint64_t cycles;
+        };
+
+        static unsigned registerCounter(const char* name);
+        // this thread's counters
+        static counter* local();
+        static uint64_t timestamp();
+
+        // sums the counters of every thread that has run instrumented code, returns the counter count
+        static unsigned merge(totals* out);
+        // sorted by call count
+        static void report(FILE* file);
+        static void reset();
+    };
+
+    class profileScope
+    {
+    public:
+        profileScope(const unsigned& id) : m_counter(profile::local() + id)
+        {
+            uint64_t calls = m_counter->calls.load(std::memory_order_relaxed);
+            m_counter->calls.store(calls + 1, std::memory_order_relaxed);
+#ifdef M3D_INSTRUMENT_CYCLES
+            m_start = (calls & (M3D_INSTRUMENT_SAMPLE_RATE - 1)) == 0 ? profile::timestamp() : 0;
+#endif // M3D_INSTRUMENT_CYCLES
+        }
+
+#ifdef M3D_INSTRUMENT_CYCLES
+        ~profileScope()
+        {
+            if(m_start != 0)
+            {
+                uint64_t cycles = profile::timestamp() - m_start;
+                m_counter->samples.store(m_counter->samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                m_counter->cycles.store(m_counter->cycles.load(std::memory_order_relaxed) + cycles, std::memory_order_relaxed);
+            }
+        }
+#endif // M3D_INSTRUMENT_CYCLES
+
+    private:
+        profile::counter* m_counter;
+#ifdef M3D_INSTRUMENT_CYCLES
+        uint64_t m_start;
+#endif // M3D_INSTRUMENT_CYCLES
+    };
+}
+
+#define M3D_PROFILE(name) \
+    static const unsigned m3dProfileCounter = m3d::profile::registerCounter(name); \
+    m3d::profileScope m3dProfileScope(m3dProfileCounter)
+
+#else
+
+#define M3D_PROFILE(name)
+
+#endif // M3D_INSTRUMENT
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+/** ------------- quantization codecs
+    compact encodings of rotations and positions for networking and storage.
+    quaternions use the smallest three encoding, the largest component is dropped
+    and rebuilt from the unit length, the other three are stored in the range +-1/sqrt(2) */
+
+namespace m3d
+{
+    class vec3;
+    class quat;
+    class transform;
+    class quantize
+    {
+    public:
+        // 2 bit index + 3 x 9 bits
+        static uint32_t packQuat29(const quat& v);
+        static quat unpackQuat29(const uint32_t& v);
+        // 2 bit index + 3 x 10 bits
+        static uint32_t packQuat32(const quat& v);
+        static quat unpackQuat32(const uint32_t& v);
+        // 2 bit index + 3 x 15 bits, stored in the low 48 bits
+        static uint64_t packQuat48(const quat& v);
+        static quat unpackQuat48(const uint64_t& v);
+
+        // each axis is mapped from [min, max] to bits (at most 21) bits, x in the lowest bits
+        static uint64_t packVec3(const vec3& v, const vec3& min, const vec3& max, const unsigned& bits);
+        static vec3 unpackVec3(const uint64_t& v, const vec3& min, const vec3& max, const unsigned& bits);
+
+        static void packQuats29(const quat* in, uint32_t* out, const unsigned& count);
+        static void unpackQuats29(const uint32_t* in, quat* out, const unsigned& count);
+        static void packQuats32(const quat* in, uint32_t* out, const unsigned& count);
+        static void unpackQuats32(const uint32_t* in, quat* out, const unsigned& count);
+        static void packQuats48(const quat* in, uint64_t* out, const unsigned& count);
+        static void unpackQuats48(const uint64_t* in, quat* out, const unsigned& count);
+
+        static void packVec3s(const vec3* in, uint64_t* out, const unsigned& count, const vec3& min, const vec3& max, const unsigned& bits);
+        static void unpackVec3s(const uint64_t* in, vec3* out, const unsigned& count, const vec3& min, const vec3& max, const unsigned& bits);
+
+        // position and rotation only, scale is not sent
+        static void packTransforms(const transform* in, uint64_t* positions, uint32_t* rotations, const unsigned& count,
+                                   const vec3& min, const vec3& max, const unsigned& bits);
+        static void unpackTransforms(const uint64_t* positions, const uint32_t* rotations, transform* out, const unsigned& count,
+                                     const vec3& min, const vec3& max, const unsigned& bits);
+
+        // xor against a reference snapshot, unchanged values become 0 and compress well.
+        // encoding and decoding are the same operation
+        static void delta(const uint32_t* values, const uint32_t* reference, uint32_t* out, const unsigned& count);
+        static void delta(const uint64_t* values, const uint64_t* reference, uint64_t* out, const unsigned& count);
+    };
+}
@@ -3,6 +3,7 @@
 namespace m3d
 {
     class vec3;
+    class mat3x3;
     class mat4x4;
     class quat
     {
@@ -14,6 +15,7 @@ namespace m3d
         quat(const float& i, const float& j, const float& k, const float& w);
 
         static float angle(const quat& a, const quat& b);
+        static quat angleAxisFast(const float& angle, const vec3& axis);
         static quat angleVec3(const vec3& a, const vec3& b, const vec3& up);
         static quat conjugate(const quat& v);
         static float dot(const quat& a, const quat& b);
@@ -24,10 +26,22 @@ namespace m3d
         static quat lerp(const quat& a, const quat& b, const float& t);
         static quat lookat(const vec3& from, const vec3& target, const vec3& up);
         static quat normalized(const quat& v);
+        static quat normalizedFast(const quat& v);
         static vec3 rotateVec3(const quat& a, const vec3& b);
         static quat slerp(const quat& a, const quat& b, const float& t);
+        static quat slerpFast(const quat& a, const quat& b, const float& t);
+
+        // log of a unit quaternion and exp of a pure one, w is 0 on the pure side
+        static quat log(const quat& v);
+        static quat exp(const quat& v);
+        // shoemake's squad between a and b, aControl and bControl come from squadControl.
+        // neighbouring keys must share a hemisphere, see quatSpline
+        static quat squad(const quat& a, const quat& aControl, const quat& bControl, const quat& b, const float& t);
+        static quat squadControl(const quat& previous, const quat& current, const quat& next);
 
         static quat fromMat4x4(const mat4x4& mat);
+        // the inverse of mat3x3::initRotationFromQuat, mat must be a rotation
+        static quat fromRotation(const mat3x3& mat);
 
         static quat add(const quat& a, const quat& b);
         static quat sub(const quat& a, const quat& b);
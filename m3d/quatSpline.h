@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+/** ------------- quaternion splines
+    squad orientation tracks, many of them kept together so a frame evaluates all of them in one call.
+    on addTrack every key is flipped into the hemisphere of the one before it and its inner control point
+    is computed once with quat::squadControl, evaluation is then a key search and three slerps.
+
+    the batch versions use quat::slerpFast, four tracks at a time with sse. times before the first key or
+    after the last clamp to that key */
+
+namespace m3d
+{
+    class quat;
+
+    class quatSpline
+    {
+    public:
+        // times must increase, returns the index of the new track
+        unsigned addTrack(const float* times, const quat* keys, const unsigned& count);
+        void clear();
+
+        unsigned trackCount() const;
+
+        // exact, through quat::squad
+        quat evaluate(const unsigned& track, const float& time) const;
+
+        // every track at its own time, res has trackCount() entries
+        void evaluate(const float* times, quat* res) const;
+        void evaluateParallel(const float* times, quat* res) const;
+        // every track at the same time
+        void evaluate(const float& time, quat* res) const;
+
+    private:
+        struct track
+        {
+            unsigned first;
+            unsigned count;
+        };
+
+        std::vector<track> m_tracks;
+        std::vector<float> m_times;
+        std::vector<quat> m_keys;
+        std::vector<quat> m_controls;
+
+        // key before time and the parameter to the one after it
+        unsigned segment(const track& current, const float& time, float& t) const;
+        void evaluate(const unsigned& begin, const unsigned& end, const float* times, const unsigned& timeStride, quat* res) const;
+    };
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "vec3.h"
+
+namespace m3d
+{
+    class vec2;
+    class mat4x4;
+    class ray
+    {
+    public:
+        vec3 origin;
+        vec3 direction;
+
+        ray();
+        ray(const vec3& origin, const vec3& direction);
+
+        static vec3 point(const ray& r, const float& t);
+
+        /** ------------- unproject
+            ndc points to world space rays through the inverse view projection.
+            the origin is on the near plane and the direction is normalized, an infinite far plane works too.
+            nearZ and farZ are the ndc depths of the planes, -1 and 1 for initPerspective, 1 and 0 for the reverse z ones */
+        static ray unproject(const mat4x4& invViewProj, const vec2& ndc, const float& nearZ = -1.0f, const float& farZ = 1.0f);
+        static void unproject(const mat4x4& invViewProj, const vec2* ndc, ray* rays, const unsigned& count, const float& nearZ = -1.0f, const float& farZ = 1.0f);
+
+        // one ray through each pixel center, row 0 is the top of the screen, rays[y * width + x]
+        static void unprojectGrid(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, ray* rays, const float& nearZ = -1.0f, const float& farZ = 1.0f);
+        // rows [rowBegin, rowEnd) of the grid only, for running on a job system
+        static void unprojectRows(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, const unsigned& rowBegin, const unsigned& rowEnd,
+                                  ray* rays, const float& nearZ = -1.0f, const float& farZ = 1.0f);
+        // rows split over parallelFor
+        static void unprojectGridParallel(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, ray* rays, const float& nearZ = -1.0f, const float& farZ = 1.0f);
+
+        vec3 point(const float& t) const;
+    };
+}
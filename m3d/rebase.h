@@ -0,0 +1,27 @@
+#pragma once
+
+/** ------------- camera relative rebasing
+    large world positions are kept split in two floats, hi = (float)p and lo = (float)(p - hi), which together hold ~48 bits.
+    the per frame rebase is then (hi - origin.hi) + (lo - origin.lo) in float only, exact for positions near the origin
+    where the precision matters, and done on the flat float arrays four lanes at a time.
+    split again only when positions move */
+
+namespace m3d
+{
+    class vec3;
+    class dvec3;
+    class affine;
+    class rebase
+    {
+    public:
+        static void split(const dvec3& v, vec3& hi, vec3& lo);
+        static void split(const dvec3* v, vec3* hi, vec3* lo, const unsigned& count);
+
+        // positions relative to origin
+        static void relative(const dvec3& origin, const vec3* hi, const vec3* lo, vec3* res, const unsigned& count);
+        // models with their translation replaced by the position relative to origin, the rotation and scale are copied
+        static void relative(const dvec3& origin, const vec3* hi, const vec3* lo, const affine* models, affine* res, const unsigned& count);
+        // the same from unsplit positions, with the subtraction in double
+        static void relative(const dvec3& origin, const dvec3* positions, vec3* res, const unsigned& count);
+    };
+}
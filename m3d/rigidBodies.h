@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+/** ------------- rigid bodies
+    body state as structure of arrays, one float stream per component so the step runs four bodies per instruction.
+    integrate is semi implicit euler: velocities first from the accelerations, then positions from the new velocities.
+    orientations are advanced by the exponential map of the world space angular velocity, q = exp(w * dt / 2) * q,
+    and only renormalized once their length drifts past a bound */
+
+namespace m3d
+{
+    class vec3;
+    class quat;
+    class rigidBodies
+    {
+    public:
+        std::vector<float> x, y, z;
+        std::vector<float> vx, vy, vz;
+        std::vector<float> qi, qj, qk, qw;
+        // angular velocity in world space, radians per second
+        std::vector<float> wx, wy, wz;
+        // linear and angular accelerations, kept between steps, gravity is added on top
+        std::vector<float> ax, ay, az;
+        std::vector<float> alphaX, alphaY, alphaZ;
+
+        unsigned add(const vec3& position, const quat& orientation);
+        unsigned add(const vec3& position, const quat& orientation, const vec3& velocity, const vec3& angularVelocity);
+        void resize(const unsigned& count);
+        void clear();
+        unsigned count() const;
+
+        vec3 position(const unsigned& n) const;
+        quat orientation(const unsigned& n) const;
+
+        void integrate(const float& dt, const vec3& gravity);
+        // bodies [begin, end) only, for running on a job system
+        void integrate(const unsigned& begin, const unsigned& end, const float& dt, const vec3& gravity);
+        // split over parallelFor
+        void integrateParallel(const float& dt, const vec3& gravity);
+    };
+}
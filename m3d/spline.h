@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+/** ------------- splines
+    cubic bezier, catmull-rom and uniform b-spline curves over vec2 or vec3. every segment is turned into power
+    basis coefficients once on build, so evaluation and derivatives are a horner step and uniform steps along a
+    segment are forward differences, three adds per point.
+
+    curve parameters run from 0 to segmentCount(), segment i covers [i, i + 1]. an arc length table sampled on
+    build maps distances to parameters for constant speed traversal, its accuracy depends on samplesPerSegment.
+
+    bezier takes 3n + 1 points, every third one is on the curve. catmull-rom passes through all its points, the
+    ends are mirrored. the b-spline approximates its points and needs at least four */
+
+namespace m3d
+{
+    class vec2;
+    class vec3;
+
+    template <typename T> class spline
+    {
+    public:
+        enum type
+        {
+            BEZIER = 0,
+            CATMULL_ROM = 1,
+            BSPLINE = 2
+        };
+
+        spline();
+
+        // false when count does not fit the type, the spline is then empty
+        bool build(const T* points, const unsigned& count, const type& kind, const unsigned& samplesPerSegment = 16);
+
+        unsigned segmentCount() const;
+        float length() const;
+
+        T evaluate(const float& t) const;
+        T derivative(const float& t) const;
+        T secondDerivative(const float& t) const;
+
+        float parameterAtDistance(const float& distance) const;
+        T evaluateAtDistance(const float& distance) const;
+
+        // parameter of the point on the curve closest to p, its position in point when not null
+        float closest(const T& p, T* point = nullptr) const;
+
+        void evaluate(const float* t, const unsigned& count, T* res) const;
+        void evaluateAtDistance(const float* distances, const unsigned& count, T* res) const;
+        void closest(const T* points, const unsigned& count, float* t, T* res) const;
+
+        // count points evenly spaced in t over the whole curve, by forward differencing
+        void evaluateUniform(const unsigned& count, T* res) const;
+        // count points evenly spaced in distance, walking the arc length table once
+        void evaluateUniformDistance(const unsigned& count, T* res) const;
+
+    private:
+        // a b c d of a + b s + c s^2 + d s^3, one T each, per segment
+        std::vector<float> m_coefficients;
+        // cumulative length at every sample, samplesPerSegment per segment plus the end
+        std::vector<float> m_lengths;
+        // curve position at every sample, for the coarse closest point search
+        std::vector<float> m_samples;
+        unsigned m_segmentCount;
+        unsigned m_samplesPerSegment;
+
+        // segment of t and the local parameter within it
+        const float* segment(const float& t, float& s) const;
+        // steps + 1 points from s0 in steps of h within one segment
+        void forward(const float* c, const float& s0, const float& h, const unsigned& steps, float* res) const;
+        float sampleParameter(const unsigned& sample, const float& distance) const;
+        float refine(const float* p, float t, const float& lo, const float& hi) const;
+    };
+
+    typedef spline<vec2> spline2;
+    typedef spline<vec3> spline3;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+/** ------------- 2d sprite quads
+    builds the four corners of each sprite straight from structure of arrays streams, the same
+    result as mat3x3 translate * rotate * scale applied to the unit quad moved by -origin, without the matrices.
+    corners are written 4 per sprite in the order (0, 0) (1, 0) (1, 1) (0, 1) of the unit quad */
+
+namespace m3d
+{
+    class vec2;
+
+    struct spriteStreams
+    {
+        const float* x;
+        const float* y;
+        // radians, counter clockwise
+        const float* rotation;
+        // the size of the quad
+        const float* scaleX;
+        const float* scaleY;
+        // pivot in scaled units, rotation and position are around it, null for (0, 0)
+        const float* originX;
+        const float* originY;
+    };
+
+    class sprites
+    {
+    public:
+        // vertices must hold count * 4 entries
+        static void quads(const spriteStreams& sprites, vec2* vertices, const unsigned& count);
+        // split over parallelFor
+        static void quadsParallel(const spriteStreams& sprites, vec2* vertices, const unsigned& count);
+    };
+}
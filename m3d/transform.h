@@ -0,0 +1,42 @@
+#pragma once
+
+#include "vec3.h"
+#include "quat.h"
+
+namespace m3d
+{
+    class mat3x3;
+    class mat4x4;
+    class transform
+    {
+    public:
+        vec3 position;
+        quat rotation;
+        vec3 scale;
+
+        transform();
+        transform(const vec3& position, const quat& rotation);
+        transform(const vec3& position, const quat& rotation, const vec3& scale);
+
+        static transform lerp(const transform& a, const transform& b, const float& t);
+        static mat4x4 toMat4x4(const transform& v);
+
+        /** ------------- decompose
+            recovers translation, rotation and scale from a translation * rotation * scale matrix.
+            matrices without shear take a direct path, the rest go through mat3x3::polarDecompose
+            and keep only the diagonal of the stretch. a negative determinant shows up as a negative scale.x.
+            one zero scale keeps its rotation, the missing axis is rebuilt from the other two. with two or three
+            zero axes the rotation can't be recovered, the result then has the identity rotation and the column lengths as scale */
+        static transform decompose(const mat4x4& m);
+        static void decompose(const mat4x4* m, transform* res, const unsigned& count);
+        // m = translation * rotation * stretch exactly, the stretch holds scale and shear, false when m is singular
+        static bool decompose(const mat4x4& m, vec3& translation, quat& rotation, mat3x3& stretch);
+
+        static bool equals(const transform& a, const transform& b);
+
+        mat4x4 toMat4x4() const;
+    };
+}
+
+bool operator==(const m3d::transform& a, const m3d::transform&b);
+bool operator!=(const m3d::transform& a, const m3d::transform&b);
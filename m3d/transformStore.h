@@ -0,0 +1,87 @@
+#pragma once
+
+#include "transform.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+/** ------------- transform store
+    hands transforms from a simulation thread to a render thread without locks or copies. the store holds four
+    snapshots, the writer owns one, the reader owns two (previous and current) and the last one is the exchange
+    slot. publish and acquire each swap a snapshot with the exchange slot in a single atomic exchange, so neither
+    side ever waits for the other and the reader always sees a complete frame.
+
+    one writer thread and one reader thread. the pointer from write() stays valid until publish(), the pointers
+    from previous() and current() until the next acquire(). the snapshot handed back to the writer holds an older
+    frame, every element has to be written before each publish. when the writer publishes faster than the reader
+    acquires, the frames in between are dropped */
+
+namespace m3d
+{
+    class mat4x4;
+    class transformStore
+    {
+    public:
+        explicit transformStore(const unsigned& count);
+
+        unsigned count() const;
+
+        // writer thread, fill every element then publish it stamped with its simulation time
+        transform* write();
+        void publish(const double& time);
+
+        // reader thread, takes the newest published frame, false when nothing was published since the last call
+        bool acquire();
+        // the frame before current, current itself until a second frame was acquired. null before the first acquire
+        const transform* previous() const;
+        const transform* current() const;
+        double previousTime() const;
+        double currentTime() const;
+
+        // where time falls between previousTime and currentTime, clamped to [0, 1]
+        float factor(const double& time) const;
+
+        // lerp of position and scale, slerp of rotation, from previous at t = 0 to current at t = 1. nothing before the first acquire
+        void interpolate(const float& t, transform* res) const;
+        void interpolate(const float& t, mat4x4* res) const;
+        // split over parallelFor
+        void interpolateParallel(const float& t, transform* res) const;
+        void interpolateParallel(const float& t, mat4x4* res) const;
+
+    private:
+        static const unsigned SLOTS = 4;
+        // set in the exchange slot by publish, cleared by acquire
+        static const unsigned FRESH = 0x80000000u;
+
+        struct snapshot
+        {
+            double time;
+            // 0 until the snapshot is first published
+            uint64_t frame;
+        };
+
+        std::vector<transform> m_transforms;
+        snapshot m_snapshots[SLOTS];
+        unsigned m_count;
+
+        // a cache line between the writer's, the reader's and the shared members, alignas would need an aligned new
+        char m_writerPadding[64];
+        unsigned m_write;
+        uint64_t m_frame;
+
+        char m_readerPadding[64];
+        unsigned m_previous;
+        unsigned m_current;
+
+        char m_exchangePadding[64];
+        // slot index of the exchange snapshot, with FRESH
+        std::atomic<unsigned> m_exchange;
+        char m_endPadding[64];
+
+        const transform* slot(const unsigned& index) const;
+        void interpolateRange(const float& t, const unsigned& begin, const unsigned& end, transform* res) const;
+        void interpolateRange(const float& t, const unsigned& begin, const unsigned& end, mat4x4* res) const;
+    };
+}
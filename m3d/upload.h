@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** ------------- gpu upload
+    writes values into caller provided (usually mapped) buffer memory using the std140 or std430 rules.
+    matrices are written column-major, mat3x3 as three vec4 padded columns, affine as a row_major mat4x3.
+    aligned 16 byte chunks use non-temporal stores so large uploads do not evict the cache,
+    call flush() before the gpu reads the buffer */
+
+namespace m3d
+{
+    class vec2;
+    class vec3;
+    class vec4;
+    class mat3x3;
+    class mat4x4;
+    class affine;
+    class uploadWriter
+    {
+    public:
+        enum layout
+        {
+            STD140 = 0,
+            STD430 = 1
+        };
+
+        uploadWriter(void* dst, const size_t& capacity, const layout& layout);
+
+        size_t offset() const;
+        size_t capacity() const;
+
+        // skips to the next multiple of alignment, returns false when that is past the end
+        bool align(const size_t& alignment);
+
+        // single members at their base alignment, writes nothing and returns false when out of space
+        bool write(const float& v);
+        bool write(const vec2& v);
+        bool write(const vec3& v);
+        bool write(const vec4& v);
+        bool write(const mat3x3& v);
+        bool write(const mat4x4& v);
+        bool write(const affine& v);
+
+        // arrays, elements at the array stride of the layout including the padding of the last one
+        bool write(const float* v, const unsigned& count);
+        bool write(const vec2* v, const unsigned& count);
+        bool write(const vec3* v, const unsigned& count);
+        bool write(const vec4* v, const unsigned& count);
+        bool write(const mat3x3* v, const unsigned& count);
+        bool write(const mat4x4* v, const unsigned& count);
+        bool write(const affine* v, const unsigned& count);
+
+        // orders the non-temporal stores before anything written after it
+        void flush();
+
+        static size_t arrayStride(const layout& layout, const size_t& size, const size_t& alignment);
+
+    private:
+        uint8_t* m_dst;
+        size_t m_capacity;
+        size_t m_offset;
+        layout m_layout;
+
+        uint8_t* reserve(const size_t& alignment, const size_t& size);
+    };
+}
@@ -34,6 +34,7 @@ namespace m3d
         static vec3 max(const vec3& a, const vec3& b);
         static vec3 min(const vec3& a, const vec3& b);
         static vec3 normalized(const vec3& v);
+        static vec3 normalizedFast(const vec3& v);
         static vec3 reflect(const vec3& v, const vec3& normal);
         static vec3 slerp(const vec3& a, const vec3& b, const float& t);
 
@@ -3,6 +3,7 @@
 #include "m3d/vec2.h"
 #include "m3d/vec3.h"
 #include "m3d/quat.h"
+#include "m3d/profile.h"
 
 #include <math.h>
 
@@ -12,9 +13,9 @@ namespace m3d
 
     mat3x3::mat3x3(const float& diagonal)
     {
-        m[0][0] = diagonal;
-        m[1][1] = diagonal;
-        m[2][2] = diagonal;
+        at(0, 0) = diagonal;
+        at(1, 1) = diagonal;
+        at(2, 2) = diagonal;
     }
 
     mat3x3 mat3x3::initOrtho(const float& r, const float& l, const float& t, const float& b)
@@ -24,11 +25,11 @@ namespace m3d
         float rml = 1.0f / (r - l);
         float tmb = 1.0f / (t - b);
 
-        res.m[0][0] = 2.0f * rml;
-        res.m[1][1] = 2.0f * tmb;
-        res.m[2][2] = 1.0f;
-        res.m[0][2] = -(r + l) * rml;
-        res.m[1][2] = -(t + b) * tmb;
+        res.at(0, 0) = 2.0f * rml;
+        res.at(1, 1) = 2.0f * tmb;
+        res.at(2, 2) = 1.0f;
+        res.at(0, 2) = -(r + l) * rml;
+        res.at(1, 2) = -(t + b) * tmb;
 
         return res;
     }
@@ -37,15 +38,17 @@ namespace m3d
     {
         mat3x3 res;
 
-        res.m[0][0] = 2.0f / w;
-        res.m[1][1] = 2.0f / h;
-        res.m[2][2] = 1.0f;
+        res.at(0, 0) = 2.0f / w;
+        res.at(1, 1) = 2.0f / h;
+        res.at(2, 2) = 1.0f;
 
         return res;
     }
 
     mat3x3 mat3x3::initRotationFromQuat(const quat& quat)
     {
+        M3D_PROFILE("mat3x3::initRotationFromQuat");
+
         mat3x3 res;
 
         // precalc most parts
@@ -61,15 +64,17 @@ namespace m3d
         float jw = quat.j * quat.w * 2.0f;
         float kw = quat.k * quat.w * 2.0f;
 
-        res.m[0][0] = 1.0f - j2 - k2;   res.m[0][1] = ij - kw;          res.m[0][2] = ik + jw;
-        res.m[1][0] = ij + kw;          res.m[1][1] = 1.0f - i2 - k2;   res.m[1][2] = jk - iw;
-        res.m[2][0] = ik - jw;          res.m[2][1] = jk + iw;          res.m[2][2] = 1.0f - i2 - j2;
+        res.at(0, 0) = 1.0f - j2 - k2;   res.at(0, 1) = ij - kw;          res.at(0, 2) = ik + jw;
+        res.at(1, 0) = ij + kw;          res.at(1, 1) = 1.0f - i2 - k2;   res.at(1, 2) = jk - iw;
+        res.at(2, 0) = ik - jw;          res.at(2, 1) = jk + iw;          res.at(2, 2) = 1.0f - i2 - j2;
 
         return res;
     }
 
     mat3x3 mat3x3::mul(const mat3x3& a, const mat3x3& b)
     {
+        M3D_PROFILE("mat3x3::mul");
+
         mat3x3 res;
 
         for (unsigned i = 0 ; i < 3 ; i++ )
@@ -79,10 +84,10 @@ namespace m3d
                 float sum = 0;
                 for (unsigned k = 0 ; k < 3 ; k++ )
                 {
-                    sum += a.m[i][k] * b.m[k][j];
+                    sum += a.at(i, k) * b.at(k, j);
                 }
 
-                res.m[i][j] = sum;
+                res.at(i, j) = sum;
             }
         }
 
@@ -91,11 +96,13 @@ namespace m3d
 
     vec3 mat3x3::mul(const mat3x3& a, const vec3& b)
     {
+        M3D_PROFILE("mat3x3::mul(vec3)");
+
         vec3 res;
 
-        res.x = a.m[0][0] * b.x + a.m[0][1] * b.y + a.m[0][2] * b.z;
-        res.y = a.m[1][0] * b.x + a.m[1][1] * b.y + a.m[1][2] * b.z;
-        res.z = a.m[2][0] * b.x + a.m[2][1] * b.y + a.m[2][2] * b.z;
+        res.x = a.at(0, 0) * b.x + a.at(0, 1) * b.y + a.at(0, 2) * b.z;
+        res.y = a.at(1, 0) * b.x + a.at(1, 1) * b.y + a.at(1, 2) * b.z;
+        res.z = a.at(2, 0) * b.x + a.at(2, 1) * b.y + a.at(2, 2) * b.z;
 
         return res;
     }
@@ -108,38 +115,158 @@ namespace m3d
         {
             for(int j = 0; j < 3; j++)
             {
-                res.m[i][j] = m.m[i][j];
+                res.at(i, j) = m.at(i, j);
             }
         }
 
         return res;
     }
 
+    float mat3x3::determinant(const mat3x3& m)
+    {
+        return m.at(0, 0) * (m.at(1, 1) * m.at(2, 2) - m.at(1, 2) * m.at(2, 1))
+             - m.at(0, 1) * (m.at(1, 0) * m.at(2, 2) - m.at(1, 2) * m.at(2, 0))
+             + m.at(0, 2) * (m.at(1, 0) * m.at(2, 1) - m.at(1, 1) * m.at(2, 0));
+    }
+
+    mat3x3 mat3x3::transpose(const mat3x3& m)
+    {
+        mat3x3 res;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                res.at(i, j) = m.at(j, i);
+            }
+        }
+
+        return res;
+    }
+
+    mat3x3 mat3x3::inverse(const mat3x3& m)
+    {
+        mat3x3 res;
+
+        res.at(0, 0) = m.at(1, 1) * m.at(2, 2) - m.at(1, 2) * m.at(2, 1);
+        res.at(0, 1) = m.at(0, 2) * m.at(2, 1) - m.at(0, 1) * m.at(2, 2);
+        res.at(0, 2) = m.at(0, 1) * m.at(1, 2) - m.at(0, 2) * m.at(1, 1);
+        res.at(1, 0) = m.at(1, 2) * m.at(2, 0) - m.at(1, 0) * m.at(2, 2);
+        res.at(1, 1) = m.at(0, 0) * m.at(2, 2) - m.at(0, 2) * m.at(2, 0);
+        res.at(1, 2) = m.at(0, 2) * m.at(1, 0) - m.at(0, 0) * m.at(1, 2);
+        res.at(2, 0) = m.at(1, 0) * m.at(2, 1) - m.at(1, 1) * m.at(2, 0);
+        res.at(2, 1) = m.at(0, 1) * m.at(2, 0) - m.at(0, 0) * m.at(2, 1);
+        res.at(2, 2) = m.at(0, 0) * m.at(1, 1) - m.at(0, 1) * m.at(1, 0);
+
+        float det = m.at(0, 0) * res.at(0, 0) + m.at(0, 1) * res.at(1, 0) + m.at(0, 2) * res.at(2, 0);
+        if(det == 0.0f)
+            return mat3x3();
+
+        float invDet = 1.0f / det;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                res.at(i, j) *= invDet;
+            }
+        }
+
+        return res;
+    }
+
+    //https://www.cs.cornell.edu/courses/cs4620/2014fa/lectures/polarnotes.pdf
+    // q = (g * q + inverse(q)^T / g) / 2 with g = sqrt(|inverse(q)| / |q|) converges quadratically to the rotation
+    bool mat3x3::polarDecompose(const mat3x3& m, mat3x3& rotation, mat3x3& stretch)
+    {
+        M3D_PROFILE("mat3x3::polarDecompose");
+
+        const int MAX_ITERATIONS = 20;
+        const float TOLERANCE = 1e-6f;
+
+        mat3x3 q = m;
+        bool converged = false;
+
+        for(int n = 0; n < MAX_ITERATIONS && !converged; n++)
+        {
+            mat3x3 inv = mat3x3::inverse(q);
+
+            float qNorm = 0.0f, invNorm = 0.0f;
+            for(int i = 0; i < 3; i++)
+            {
+                for(int j = 0; j < 3; j++)
+                {
+                    qNorm += q.at(i, j) * q.at(i, j);
+                    invNorm += inv.at(i, j) * inv.at(i, j);
+                }
+            }
+
+            if(invNorm == 0.0f)
+                return false;
+
+            float g = sqrtf(sqrtf(invNorm / qNorm));
+            float a = 0.5f * g;
+            float b = 0.5f / g;
+
+            float change = 0.0f;
+            for(int i = 0; i < 3; i++)
+            {
+                for(int j = 0; j < 3; j++)
+                {
+                    float v = a * q.at(i, j) + b * inv.at(j, i);
+                    change = fmaxf(change, fabsf(v - q.at(i, j)));
+                    q.at(i, j) = v;
+                }
+            }
+
+            converged = change <= TOLERANCE;
+        }
+
+        if(!converged)
+            return false;
+
+        rotation = q;
+        stretch = mat3x3::transpose(q) * m;
+
+        // symmetric by construction, averaging removes the rounding error
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = i + 1; j < 3; j++)
+            {
+                float v = 0.5f * (stretch.at(i, j) + stretch.at(j, i));
+                stretch.at(i, j) = v;
+                stretch.at(j, i) = v;
+            }
+        }
+
+        return true;
+    }
+
     mat3x3& mat3x3::rotate(const float& radians)
     {
         float cosTheta = cosf(radians);
         float sinTheta = sinf(radians);
 
-        m[0][0] = cosTheta;
-        m[0][1] = -sinTheta;
-        m[1][0] = sinTheta;
-        m[1][1] = cosTheta;
+        at(0, 0) = cosTheta;
+        at(0, 1) = -sinTheta;
+        at(1, 0) = sinTheta;
+        at(1, 1) = cosTheta;
 
         return *this;
     }
 
     mat3x3& mat3x3::scale(const vec2& scale)
     {
-        m[0][0] = scale.x;
-        m[1][1] = scale.y;
+        at(0, 0) = scale.x;
+        at(1, 1) = scale.y;
 
         return *this;
     }
 
     mat3x3& mat3x3::translate(const vec2& translation)
     {
-        m[0][2] = translation.x;
-        m[1][2] = translation.y;
+        at(0, 2) = translation.x;
+        at(1, 2) = translation.y;
 
         return *this;
     }
@@ -3,6 +3,7 @@
 #include "m3d/vec3.h"
 #include "m3d/vec4.h"
 #include "m3d/quat.h"
+#include "m3d/profile.h"
 
 #include <math.h>
 
@@ -14,10 +15,10 @@ namespace m3d
 
     mat4x4::mat4x4(const float& diagonal)
     {
-        m[0][0] = diagonal;
-        m[1][1] = diagonal;
-        m[2][2] = diagonal;
-        m[3][3] = diagonal;
+        at(0, 0) = diagonal;
+        at(1, 1) = diagonal;
+        at(2, 2) = diagonal;
+        at(3, 3) = diagonal;
     }
 
     mat4x4 mat4x4::initOrtho(const float& r, const float& l, const float& t, const float& b, const float& n, const float& f)
@@ -28,13 +29,13 @@ namespace m3d
         float tmb = 1.0f / (t - b);
         float fmn = 1.0f / (f - n);
 
-        res.m[0][0] = 2.0f * rml;
-        res.m[1][1] = 2.0f * tmb;
-        res.m[2][2] = 2.0f * fmn;
-        res.m[3][3] = 1.0f;
-        res.m[0][3] = -(r + l) * rml;
-        res.m[1][3] = -(t + b) * tmb;
-        res.m[2][3] = -(f + n) * fmn;
+        res.at(0, 0) = 2.0f * rml;
+        res.at(1, 1) = 2.0f * tmb;
+        res.at(2, 2) = 2.0f * fmn;
+        res.at(3, 3) = 1.0f;
+        res.at(0, 3) = -(r + l) * rml;
+        res.at(1, 3) = -(t + b) * tmb;
+        res.at(2, 3) = -(f + n) * fmn;
 
         return res;
     }
@@ -45,16 +46,36 @@ namespace m3d
 
         float fmn = 1.0f / (f - n);
 
-        res.m[0][0] = 2.0f / w;
-        res.m[1][1] = 2.0f / h;
-        res.m[2][2] = 2.0f * fmn;
-        res.m[3][3] = 1.0f;
-        res.m[2][3] = -(f + n) * fmn;
+        res.at(0, 0) = 2.0f / w;
+        res.at(1, 1) = 2.0f / h;
+        res.at(2, 2) = 2.0f * fmn;
+        res.at(3, 3) = 1.0f;
+        res.at(2, 3) = -(f + n) * fmn;
 
         return res;
     }
 
     mat4x4 mat4x4::initPerspective(const float& w, const float& h, const float& fov, const float& n, const float& f)
+    {
+        M3D_PROFILE("mat4x4::initPerspective");
+
+        mat4x4 res;
+
+        float cotFov = 1.0f / tanf(fov / 2.0f);
+        float fmn = 1.0f / (f - n);
+        float aspect = w / h;
+
+        res.at(0, 0) = cotFov / aspect;
+        res.at(1, 1) = cotFov;
+        res.at(2, 2) = -(f + n) * fmn;
+        res.at(2, 3) = -2.0f * (f * n) * fmn;
+        res.at(3, 2) = -1.0f;
+
+        return res;
+    }
+
+    //https://developer.nvidia.com/content/depth-precision-visualized
+    mat4x4 mat4x4::initPerspectiveReverseZ(const float& w, const float& h, const float& fov, const float& n, const float& f)
     {
         mat4x4 res;
 
@@ -62,17 +83,50 @@ namespace m3d
         float fmn = 1.0f / (f - n);
         float aspect = w / h;
 
-        res.m[0][0] = cotFov / aspect;
-        res.m[1][1] = cotFov;
-        res.m[2][2] = -(f + n) * fmn;
-        res.m[2][3] = -2.0f * (f * n) * fmn;
-        res.m[3][2] = -1.0f;
+        res.at(0, 0) = cotFov / aspect;
+        res.at(1, 1) = cotFov;
+        res.at(2, 2) = n * fmn;
+        res.at(2, 3) = f * n * fmn;
+        res.at(3, 2) = -1.0f;
+
+        return res;
+    }
+
+    mat4x4 mat4x4::initPerspectiveInfinite(const float& w, const float& h, const float& fov, const float& n)
+    {
+        mat4x4 res;
+
+        float cotFov = 1.0f / tanf(fov / 2.0f);
+        float aspect = w / h;
+
+        res.at(0, 0) = cotFov / aspect;
+        res.at(1, 1) = cotFov;
+        res.at(2, 2) = -1.0f;
+        res.at(2, 3) = -2.0f * n;
+        res.at(3, 2) = -1.0f;
+
+        return res;
+    }
+
+    mat4x4 mat4x4::initPerspectiveInfiniteReverseZ(const float& w, const float& h, const float& fov, const float& n)
+    {
+        mat4x4 res;
+
+        float cotFov = 1.0f / tanf(fov / 2.0f);
+        float aspect = w / h;
+
+        res.at(0, 0) = cotFov / aspect;
+        res.at(1, 1) = cotFov;
+        res.at(2, 3) = n;
+        res.at(3, 2) = -1.0f;
 
         return res;
     }
 
     mat4x4 mat4x4::lookat(const vec3& from, const vec3& to, const vec3& up)
     {
+        M3D_PROFILE("mat4x4::lookat");
+
         mat4x4 res;
 
         vec3 f = (from - to).normalized();
@@ -81,21 +135,23 @@ namespace m3d
 
         //printf("%f, %f, %f\n", right.x, right.y, right.z);
 
-        res.m[0][0] = r.x;   res.m[0][1] = r.y;   res.m[0][2] = r.z;   res.m[0][3] = 0;
-        res.m[1][0] = u.x;   res.m[1][1] = u.y;   res.m[1][2] = u.z;   res.m[1][3] = 0;
-        res.m[2][0] = f.x;   res.m[2][1] = f.y;   res.m[2][2] = f.z;   res.m[2][3] = 0;
-        res.m[3][0] = 0;     res.m[3][1] = 0;     res.m[3][2] = 0;     res.m[3][3] = 1;
+        res.at(0, 0) = r.x;   res.at(0, 1) = r.y;   res.at(0, 2) = r.z;   res.at(0, 3) = 0;
+        res.at(1, 0) = u.x;   res.at(1, 1) = u.y;   res.at(1, 2) = u.z;   res.at(1, 3) = 0;
+        res.at(2, 0) = f.x;   res.at(2, 1) = f.y;   res.at(2, 2) = f.z;   res.at(2, 3) = 0;
+        res.at(3, 0) = 0;     res.at(3, 1) = 0;     res.at(3, 2) = 0;     res.at(3, 3) = 1;
 
-        /*res.m[0][0] = r.x;   res.m[0][1] = u.x;   res.m[0][2] = f.x;   res.m[0][3] = 0;
-        res.m[1][0] = r.y;   res.m[1][1] = u.y;   res.m[1][2] = f.y;   res.m[1][3] = 0;
-        res.m[2][0] = r.z;   res.m[2][1] = u.z;   res.m[2][2] = f.z;   res.m[2][3] = 0;
-        res.m[3][0] = 0;     res.m[3][1] = 0;     res.m[3][2] = 0;     res.m[3][3] = 1;*/
+        /*res.at(0, 0) = r.x;   res.at(0, 1) = u.x;   res.at(0, 2) = f.x;   res.at(0, 3) = 0;
+        res.at(1, 0) = r.y;   res.at(1, 1) = u.y;   res.at(1, 2) = f.y;   res.at(1, 3) = 0;
+        res.at(2, 0) = r.z;   res.at(2, 1) = u.z;   res.at(2, 2) = f.z;   res.at(2, 3) = 0;
+        res.at(3, 0) = 0;     res.at(3, 1) = 0;     res.at(3, 2) = 0;     res.at(3, 3) = 1;*/
 
         return res;
     }
 
     mat4x4 mat4x4::mul(const mat4x4& a, const mat4x4& b)
     {
+        M3D_PROFILE("mat4x4::mul");
+
         mat4x4 res;
 
         for (unsigned i = 0 ; i < 4 ; i++ )
@@ -105,10 +161,10 @@ namespace m3d
                 float sum = 0.0f;
                 for (unsigned k = 0 ; k < 4 ; k++ )
                 {
-                    sum += a.m[i][k] * b.m[k][j];
+                    sum += a.at(i, k) * b.at(k, j);
                 }
 
-                res.m[i][j] = sum;
+                res.at(i, j) = sum;
             }
         }
 
@@ -118,12 +174,14 @@ namespace m3d
 
     vec4 mat4x4::mul(const mat4x4& a, const vec4& b)
     {
+        M3D_PROFILE("mat4x4::mul(vec4)");
+
         vec4 res;
 
-        res.x = a.m[0][0] * b.x + a.m[0][1] * b.y + a.m[0][2] * b.z + a.m[0][3] * b.w;
-        res.y = a.m[1][0] * b.x + a.m[1][1] * b.y + a.m[1][2] * b.z + a.m[1][3] * b.w;
-        res.z = a.m[2][0] * b.x + a.m[2][1] * b.y + a.m[2][2] * b.z + a.m[2][3] * b.w;
-        res.w = a.m[3][0] * b.x + a.m[3][1] * b.y + a.m[3][2] * b.z + a.m[3][3] * b.w;
+        res.x = a.at(0, 0) * b.x + a.at(0, 1) * b.y + a.at(0, 2) * b.z + a.at(0, 3) * b.w;
+        res.y = a.at(1, 0) * b.x + a.at(1, 1) * b.y + a.at(1, 2) * b.z + a.at(1, 3) * b.w;
+        res.z = a.at(2, 0) * b.x + a.at(2, 1) * b.y + a.at(2, 2) * b.z + a.at(2, 3) * b.w;
+        res.w = a.at(3, 0) * b.x + a.at(3, 1) * b.y + a.at(3, 2) * b.z + a.at(3, 3) * b.w;
 
         return res;
     }
@@ -136,22 +194,127 @@ namespace m3d
         {
             for(int j = 0; j < 3; j++)
             {
-                res.m[i][j] = m.m[i][j];
+                res.at(i, j) = m.at(i, j);
             }
 
-            res.m[3][i] = 0.0f;
-            res.m[i][3] = 0.0f;
+            res.at(3, i) = 0.0f;
+            res.at(i, 3) = 0.0f;
         }
 
-        res.m[3][3] = 1.0f;
+        res.at(3, 3) = 1.0f;
 
         return res;
     }
 
 
+    //https://www.geometrictools.com/Documentation/LaplaceExpansionTheorem.pdf
+    mat4x4 mat4x4::inverse(const mat4x4& mat)
+    {
+        M3D_PROFILE("mat4x4::inverse");
+
+        mat4x4 res;
+
+        float s0 = mat.at(0, 0) * mat.at(1, 1) - mat.at(1, 0) * mat.at(0, 1);
+        float s1 = mat.at(0, 0) * mat.at(1, 2) - mat.at(1, 0) * mat.at(0, 2);
+        float s2 = mat.at(0, 0) * mat.at(1, 3) - mat.at(1, 0) * mat.at(0, 3);
+        float s3 = mat.at(0, 1) * mat.at(1, 2) - mat.at(1, 1) * mat.at(0, 2);
+        float s4 = mat.at(0, 1) * mat.at(1, 3) - mat.at(1, 1) * mat.at(0, 3);
+        float s5 = mat.at(0, 2) * mat.at(1, 3) - mat.at(1, 2) * mat.at(0, 3);
+
+        float c5 = mat.at(2, 2) * mat.at(3, 3) - mat.at(3, 2) * mat.at(2, 3);
+        float c4 = mat.at(2, 1) * mat.at(3, 3) - mat.at(3, 1) * mat.at(2, 3);
+        float c3 = mat.at(2, 1) * mat.at(3, 2) - mat.at(3, 1) * mat.at(2, 2);
+        float c2 = mat.at(2, 0) * mat.at(3, 3) - mat.at(3, 0) * mat.at(2, 3);
+        float c1 = mat.at(2, 0) * mat.at(3, 2) - mat.at(3, 0) * mat.at(2, 2);
+        float c0 = mat.at(2, 0) * mat.at(3, 1) - mat.at(3, 0) * mat.at(2, 1);
+
+        float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if(det == 0.0f)
+            return res;
+
+        float invDet = 1.0f / det;
+
+        res.at(0, 0) = ( mat.at(1, 1) * c5 - mat.at(1, 2) * c4 + mat.at(1, 3) * c3) * invDet;
+        res.at(0, 1) = (-mat.at(0, 1) * c5 + mat.at(0, 2) * c4 - mat.at(0, 3) * c3) * invDet;
+        res.at(0, 2) = ( mat.at(3, 1) * s5 - mat.at(3, 2) * s4 + mat.at(3, 3) * s3) * invDet;
+        res.at(0, 3) = (-mat.at(2, 1) * s5 + mat.at(2, 2) * s4 - mat.at(2, 3) * s3) * invDet;
+
+        res.at(1, 0) = (-mat.at(1, 0) * c5 + mat.at(1, 2) * c2 - mat.at(1, 3) * c1) * invDet;
+        res.at(1, 1) = ( mat.at(0, 0) * c5 - mat.at(0, 2) * c2 + mat.at(0, 3) * c1) * invDet;
+        res.at(1, 2) = (-mat.at(3, 0) * s5 + mat.at(3, 2) * s2 - mat.at(3, 3) * s1) * invDet;
+        res.at(1, 3) = ( mat.at(2, 0) * s5 - mat.at(2, 2) * s2 + mat.at(2, 3) * s1) * invDet;
+
+        res.at(2, 0) = ( mat.at(1, 0) * c4 - mat.at(1, 1) * c2 + mat.at(1, 3) * c0) * invDet;
+        res.at(2, 1) = (-mat.at(0, 0) * c4 + mat.at(0, 1) * c2 - mat.at(0, 3) * c0) * invDet;
+        res.at(2, 2) = ( mat.at(3, 0) * s4 - mat.at(3, 1) * s2 + mat.at(3, 3) * s0) * invDet;
+        res.at(2, 3) = (-mat.at(2, 0) * s4 + mat.at(2, 1) * s2 - mat.at(2, 3) * s0) * invDet;
+
+        res.at(3, 0) = (-mat.at(1, 0) * c3 + mat.at(1, 1) * c1 - mat.at(1, 2) * c0) * invDet;
+        res.at(3, 1) = ( mat.at(0, 0) * c3 - mat.at(0, 1) * c1 + mat.at(0, 2) * c0) * invDet;
+        res.at(3, 2) = (-mat.at(3, 0) * s3 + mat.at(3, 1) * s1 - mat.at(3, 2) * s0) * invDet;
+        res.at(3, 3) = ( mat.at(2, 0) * s3 - mat.at(2, 1) * s1 + mat.at(2, 2) * s0) * invDet;
+
+        return res;
+    }
+
+    // the upper 3x3 through its cofactors, translation -inverse(r) * t
     mat4x4 mat4x4::inverseHomogeneous(const mat4x4& mat)
     {
-        return mat4x4();
+        M3D_PROFILE("mat4x4::inverseHomogeneous");
+
+        mat4x4 res;
+
+        res.at(0, 0) = mat.at(1, 1) * mat.at(2, 2) - mat.at(1, 2) * mat.at(2, 1);
+        res.at(0, 1) = mat.at(0, 2) * mat.at(2, 1) - mat.at(0, 1) * mat.at(2, 2);
+        res.at(0, 2) = mat.at(0, 1) * mat.at(1, 2) - mat.at(0, 2) * mat.at(1, 1);
+        res.at(1, 0) = mat.at(1, 2) * mat.at(2, 0) - mat.at(1, 0) * mat.at(2, 2);
+        res.at(1, 1) = mat.at(0, 0) * mat.at(2, 2) - mat.at(0, 2) * mat.at(2, 0);
+        res.at(1, 2) = mat.at(0, 2) * mat.at(1, 0) - mat.at(0, 0) * mat.at(1, 2);
+        res.at(2, 0) = mat.at(1, 0) * mat.at(2, 1) - mat.at(1, 1) * mat.at(2, 0);
+        res.at(2, 1) = mat.at(0, 1) * mat.at(2, 0) - mat.at(0, 0) * mat.at(2, 1);
+        res.at(2, 2) = mat.at(0, 0) * mat.at(1, 1) - mat.at(0, 1) * mat.at(1, 0);
+
+        float det = mat.at(0, 0) * res.at(0, 0) + mat.at(0, 1) * res.at(1, 0) + mat.at(0, 2) * res.at(2, 0);
+        if(det == 0.0f)
+            return mat4x4();
+
+        float invDet = 1.0f / det;
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                res.at(i, j) *= invDet;
+            }
+        }
+
+        for(int i = 0; i < 3; i++)
+        {
+            res.at(i, 3) = -(res.at(i, 0) * mat.at(0, 3) + res.at(i, 1) * mat.at(1, 3) + res.at(i, 2) * mat.at(2, 3));
+        }
+
+        res.at(3, 3) = 1.0f;
+
+        return res;
+    }
+
+    // the projections are | a 0 0 0 |  with inverse | 1/a 0    0   0  |
+    //                     | 0 b 0 0 |               | 0   1/b  0   0  |
+    //                     | 0 0 c d |               | 0   0    0   -1 |
+    //                     | 0 0 -1 0|               | 0   0   1/d c/d |
+    mat4x4 mat4x4::inversePerspective(const mat4x4& mat)
+    {
+        mat4x4 res;
+
+        float invD = 1.0f / mat.at(2, 3);
+
+        res.at(0, 0) = 1.0f / mat.at(0, 0);
+        res.at(1, 1) = 1.0f / mat.at(1, 1);
+        res.at(2, 3) = -1.0f;
+        res.at(3, 2) = invD;
+        res.at(3, 3) = mat.at(2, 2) * invD;
+
+        return res;
     }
 
     mat4x4& mat4x4::rotateX(const float& r)
@@ -159,10 +322,10 @@ namespace m3d
         float sinTheta = sinf(r);
         float cosTheta = cosf(r);
 
-        m[1][1] = cosTheta;
-        m[1][2] = -sinTheta;
-        m[2][1] = sinTheta;
-        m[2][2] = cosTheta;
+        at(1, 1) = cosTheta;
+        at(1, 2) = -sinTheta;
+        at(2, 1) = sinTheta;
+        at(2, 2) = cosTheta;
 
         return *this;
     }
@@ -172,10 +335,10 @@ namespace m3d
         float sinTheta = sinf(r);
         float cosTheta = cosf(r);
 
-        m[0][0] = cosTheta;
-        m[0][2] = sinTheta;
-        m[2][0] = -sinTheta;
-        m[2][2] = cosTheta;
+        at(0, 0) = cosTheta;
+        at(0, 2) = sinTheta;
+        at(2, 0) = -sinTheta;
+        at(2, 2) = cosTheta;
 
         return *this;
     }
@@ -185,16 +348,18 @@ namespace m3d
         float cosTheta = cosf(r);
         float sinTheta = sinf(r);
 
-        m[0][0] = cosTheta;
-        m[0][1] = -sinTheta;
-        m[1][0] = sinTheta;
-        m[1][1] = cosTheta;
+        at(0, 0) = cosTheta;
+        at(0, 1) = -sinTheta;
+        at(1, 0) = sinTheta;
+        at(1, 1) = cosTheta;
 
         return *this;
     }
 
     mat4x4& mat4x4::rotate(const quat& r)
     {
+        M3D_PROFILE("mat4x4::rotate");
+
         // precalc most parts
         /*float i2 = r.i * r.i * 2.0f;
         float j2 = r.j * r.j * 2.0f;
@@ -208,35 +373,35 @@ namespace m3d
         float jw = r.j * r.w * 2.0f;
         float kw = r.k * r.w * 2.0f;
 
-        m[0][0] = 1.0f - j2 - k2;    m[0][1] = ij - kw;           m[0][2] = ik + jw;
-        m[1][0] = ij + kw;           m[1][1] = 1.0f - i2 - k2;    m[1][2] = jk - iw;
-        m[2][0] = ik - jw;           m[2][1] = jk + iw;           m[2][2] = 1.0f - i2 - j2;*/
+        at(0, 0) = 1.0f - j2 - k2;    at(0, 1) = ij - kw;           at(0, 2) = ik + jw;
+        at(1, 0) = ij + kw;           at(1, 1) = 1.0f - i2 - k2;    at(1, 2) = jk - iw;
+        at(2, 0) = ik - jw;           at(2, 1) = jk + iw;           at(2, 2) = 1.0f - i2 - j2;*/
 
         vec3 forward = vec3(2.0f * (r.i * r.k - r.w * r.j), 2.0f * (r.j * r.k + r.w * r.i), 1.0f - 2.0f * (r.i * r.i + r.j * r.j));
 		vec3 up = vec3(2.0f * (r.i * r.j + r.w * r.k), 1.0f - 2.0f * (r.i * r.i + r.k * r.k), 2.0f * (r.j * r.k - r.w * r.i));
 		vec3 right = vec3(1.0f - 2.0f * (r.j * r.j + r.k * r.k), 2.0f * (r.i * r.j - r.w * r.k), 2.0f * (r.i * r.k + r.w * r.j));
 
-        m[0][0] = right.x;      m[0][1] = right.y;      m[0][2] = right.z;
-        m[1][0] = up.x;         m[1][1] = up.y;         m[1][2] = up.z;
-        m[2][0] = forward.x;    m[2][1] = forward.y;    m[2][2] = forward.z;
+        at(0, 0) = right.x;      at(0, 1) = right.y;      at(0, 2) = right.z;
+        at(1, 0) = up.x;         at(1, 1) = up.y;         at(1, 2) = up.z;
+        at(2, 0) = forward.x;    at(2, 1) = forward.y;    at(2, 2) = forward.z;
 
         return *this;
     }
 
     mat4x4& mat4x4::scale(const vec3& scale)
     {
-        m[0][0] = scale.x;
-        m[1][1] = scale.y;
-        m[2][2] = scale.z;
+        at(0, 0) = scale.x;
+        at(1, 1) = scale.y;
+        at(2, 2) = scale.z;
 
         return *this;
     }
 
     mat4x4& mat4x4::translate(const vec3& translation)
     {
-        m[0][3] = translation.x;
-        m[1][3] = translation.y;
-        m[2][3] = translation.z;
+        at(0, 3) = translation.x;
+        at(1, 3) = translation.y;
+        at(2, 3) = translation.z;
 
         return *this;
     }
@@ -0,0 +1,311 @@
+#include "m3d/meshNormals.h"
+#include "m3d/math1D.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <math.h>
+#include <atomic>
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned TRIANGLE_GRAIN = 8192;
+        const unsigned VERTEX_GRAIN = 8192;
+
+        template<class F>
+        void run(const unsigned& count, const unsigned& grain, const bool& parallel, const F& fn)
+        {
+            if(parallel)
+                parallelFor(count, grain, fn);
+            else if(count > 0)
+                fn(0, count);
+        }
+
+        inline void sub(const float* x, const float* y, const float* z, const uint32_t& a, const uint32_t& b, float* res)
+        {
+            res[0] = x[a] - x[b];
+            res[1] = y[a] - y[b];
+            res[2] = z[a] - z[b];
+        }
+
+        inline float dot(const float* a, const float* b)
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        inline void cross(const float* a, const float* b, float* res)
+        {
+            res[0] = a[1] * b[2] - a[2] * b[1];
+            res[1] = a[2] * b[0] - a[0] * b[2];
+            res[2] = a[0] * b[1] - a[1] * b[0];
+        }
+
+        // scales v to unit length, zero vectors stay zero
+        inline void normalize(float* v)
+        {
+            float l2 = dot(v, v);
+            float inv = l2 > 0.0f ? 1.0f / sqrtf(l2) : 0.0f;
+            v[0] *= inv;
+            v[1] *= inv;
+            v[2] *= inv;
+        }
+
+        // interior angles at the three corners from the edge vectors
+        inline void cornerAngles(const float* e01, const float* e02, const float* e12, float* res)
+        {
+            float l01 = sqrtf(dot(e01, e01));
+            float l02 = sqrtf(dot(e02, e02));
+            float l12 = sqrtf(dot(e12, e12));
+
+            float d0 = l01 * l02;
+            float d1 = l01 * l12;
+            float d2 = l02 * l12;
+
+            res[0] = d0 > 0.0f ? fastAcos(dot(e01, e02) / d0) : 0.0f;
+            res[1] = d1 > 0.0f ? fastAcos(-dot(e01, e12) / d1) : 0.0f;
+            res[2] = d2 > 0.0f ? fastAcos(dot(e02, e12) / d2) : 0.0f;
+        }
+    }
+
+    void meshNormals::build(const uint32_t* indices, const unsigned& triangleCount, const unsigned& vertexCount)
+    {
+        M3D_PROFILE("meshNormals::build");
+
+        unsigned corners = triangleCount * 3;
+        m_indices.assign(indices, indices + corners);
+
+        m_offsets.assign(vertexCount + 1, 0);
+        for(unsigned c = 0; c < corners; c++)
+        {
+            m_offsets[indices[c] + 1]++;
+        }
+
+        for(unsigned n = 0; n < vertexCount; n++)
+        {
+            m_offsets[n + 1] += m_offsets[n];
+        }
+
+        // corners are added in order, so every vertex lists its triangles ascending. the offsets serve as the
+        // write cursors and end up one vertex ahead, shifting them back avoids a scratch array
+        m_corners.resize(corners);
+        for(unsigned c = 0; c < corners; c++)
+        {
+            m_corners[m_offsets[indices[c]]++] = c;
+        }
+
+        for(unsigned n = vertexCount; n > 0; n--)
+        {
+            m_offsets[n] = m_offsets[n - 1];
+        }
+        m_offsets[0] = 0;
+
+        m_faceA.resize(corners);
+        m_weights.resize(corners);
+    }
+
+    unsigned meshNormals::triangleCount() const
+    {
+        return (unsigned)m_indices.size() / 3;
+    }
+
+    unsigned meshNormals::vertexCount() const
+    {
+        return m_offsets.empty() ? 0 : (unsigned)m_offsets.size() - 1;
+    }
+
+    void meshNormals::normals(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting)
+    {
+        computeNormals(x, y, z, nx, ny, nz, weighting, false);
+    }
+
+    void meshNormals::normalsParallel(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting)
+    {
+        computeNormals(x, y, z, nx, ny, nz, weighting, true);
+    }
+
+    unsigned meshNormals::tangents(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                                   const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed)
+    {
+        return computeTangents(x, y, z, nx, ny, nz, u, v, tx, ty, tz, tw, mixed, false);
+    }
+
+    unsigned meshNormals::tangentsParallel(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                                           const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed)
+    {
+        return computeTangents(x, y, z, nx, ny, nz, u, v, tx, ty, tz, tw, mixed, true);
+    }
+
+    // the cross product of two edges has twice the triangle area as its length, so summing it is area weighting,
+    // angle weighting sums the unit face normal times the corner angle
+    void meshNormals::computeNormals(const float* x, const float* y, const float* z, float* nx, float* ny, float* nz, const weighting& weighting, const bool& parallel)
+    {
+        M3D_PROFILE("meshNormals::normals");
+
+        const uint32_t* indices = m_indices.data();
+        float* face = m_faceA.data();
+        float* weights = m_weights.data();
+        bool angle = weighting == WEIGHT_ANGLE;
+
+        run(triangleCount(), TRIANGLE_GRAIN, parallel, [&](unsigned begin, unsigned end)
+        {
+            for(unsigned t = begin; t < end; t++)
+            {
+                const uint32_t* tri = indices + t * 3;
+                float e01[3], e02[3], e12[3];
+                sub(x, y, z, tri[1], tri[0], e01);
+                sub(x, y, z, tri[2], tri[0], e02);
+
+                float* n = face + t * 3;
+                cross(e01, e02, n);
+
+                float* w = weights + t * 3;
+                if(angle)
+                {
+                    sub(x, y, z, tri[2], tri[1], e12);
+                    normalize(n);
+                    cornerAngles(e01, e02, e12, w);
+                }
+                else
+                {
+                    w[0] = w[1] = w[2] = 1.0f;
+                }
+            }
+        });
+
+        const unsigned* offsets = m_offsets.data();
+        const unsigned* corners = m_corners.data();
+
+        run(vertexCount(), VERTEX_GRAIN, parallel, [&](unsigned begin, unsigned end)
+        {
+            for(unsigned n = begin; n < end; n++)
+            {
+                float sum[3] = { 0.0f, 0.0f, 0.0f };
+                for(unsigned i = offsets[n]; i < offsets[n + 1]; i++)
+                {
+                    unsigned c = corners[i];
+                    const float* f = face + (c / 3) * 3;
+                    sum[0] += f[0] * weights[c];
+                    sum[1] += f[1] * weights[c];
+                    sum[2] += f[2] * weights[c];
+                }
+
+                normalize(sum);
+                nx[n] = sum[0];
+                ny[n] = sum[1];
+                nz[n] = sum[2];
+            }
+        });
+    }
+
+    //http://www.mikktspace.com/, InitTriInfo and EvalTspace in mikktspace.c
+    unsigned meshNormals::computeTangents(const float* x, const float* y, const float* z, const float* nx, const float* ny, const float* nz,
+                                          const float* u, const float* v, float* tx, float* ty, float* tz, float* tw, uint8_t* mixed, const bool& parallel)
+    {
+        M3D_PROFILE("meshNormals::tangents");
+
+        const uint32_t* indices = m_indices.data();
+        float* faceT = m_faceA.data();
+        float* winding = m_weights.data();
+
+        run(triangleCount(), TRIANGLE_GRAIN, parallel, [&](unsigned begin, unsigned end)
+        {
+            for(unsigned t = begin; t < end; t++)
+            {
+                const uint32_t* tri = indices + t * 3;
+                float e01[3], e02[3];
+                sub(x, y, z, tri[1], tri[0], e01);
+                sub(x, y, z, tri[2], tri[0], e02);
+
+                float du1 = u[tri[1]] - u[tri[0]], dv1 = v[tri[1]] - v[tri[0]];
+                float du2 = u[tri[2]] - u[tri[0]], dv2 = v[tri[2]] - v[tri[0]];
+
+                // the sign of the uv area is enough, the vector is normalized after
+                float area = du1 * dv2 - du2 * dv1;
+                float s = area > 0.0f ? 1.0f : (area < 0.0f ? -1.0f : 0.0f);
+
+                float* ft = faceT + t * 3;
+                for(int k = 0; k < 3; k++)
+                {
+                    ft[k] = (e01[k] * dv2 - e02[k] * dv1) * s;
+                }
+
+                normalize(ft);
+                winding[t * 3] = s;
+            }
+        });
+
+        const unsigned* offsets = m_offsets.data();
+        const unsigned* corners = m_corners.data();
+        std::atomic<unsigned> mixedCount(0);
+
+        run(vertexCount(), VERTEX_GRAIN, parallel, [&](unsigned begin, unsigned end)
+        {
+            unsigned count = 0;
+            for(unsigned n = begin; n < end; n++)
+            {
+                float normal[3] = { nx[n], ny[n], nz[n] };
+
+                // one sum and angle total per uv winding, [0] for positive
+                float sums[2][3] = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+                float totals[2] = { 0.0f, 0.0f };
+
+                for(unsigned i = offsets[n]; i < offsets[n + 1]; i++)
+                {
+                    unsigned c = corners[i];
+                    unsigned t = c / 3;
+                    float s = winding[t * 3];
+                    if(s == 0.0f)
+                        continue;
+
+                    // tangent and both edges leaving the corner, projected onto the plane of the normal
+                    const uint32_t* tri = indices + t * 3;
+                    unsigned k = c - t * 3;
+                    float dir[3], e0[3], e1[3];
+                    const float* ft = faceT + t * 3;
+                    float d = dot(normal, ft);
+                    for(int j = 0; j < 3; j++)
+                    {
+                        dir[j] = ft[j] - normal[j] * d;
+                    }
+                    normalize(dir);
+
+                    sub(x, y, z, tri[(k + 2) % 3], tri[k], e0);
+                    sub(x, y, z, tri[(k + 1) % 3], tri[k], e1);
+                    float d0 = dot(normal, e0), d1 = dot(normal, e1);
+                    for(int j = 0; j < 3; j++)
+                    {
+                        e0[j] -= normal[j] * d0;
+                        e1[j] -= normal[j] * d1;
+                    }
+                    normalize(e0);
+                    normalize(e1);
+
+                    float angle = fastAcos(fmaxf(-1.0f, fminf(1.0f, dot(e0, e1))));
+                    unsigned g = s > 0.0f ? 0 : 1;
+                    for(int j = 0; j < 3; j++)
+                    {
+                        sums[g][j] += dir[j] * angle;
+                    }
+                    totals[g] += angle;
+                }
+
+                unsigned g = totals[1] > totals[0] ? 1 : 0;
+                bool both = totals[0] > 0.0f && totals[1] > 0.0f;
+                normalize(sums[g]);
+
+                tx[n] = sums[g][0];
+                ty[n] = sums[g][1];
+                tz[n] = sums[g][2];
+                tw[n] = g == 0 ? 1.0f : -1.0f;
+                if(mixed)
+                    mixed[n] = both ? 1 : 0;
+                count += both ? 1 : 0;
+            }
+
+            mixedCount.fetch_add(count, std::memory_order_relaxed);
+        });
+
+        return mixedCount.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,932 @@
+#include "m3d/noise.h"
+#include "m3d/vec2.h"
+#include "m3d/vec3.h"
+#include "m3d/vec4.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 1024;
+
+        //https://weber.itn.liu.se/~stegu/simplexnoise/simplexnoise.pdf
+        const float F2 = 0.366025404f;
+        const float G2 = 0.211324865f;
+        const float F3 = 1.0f / 3.0f;
+        const float G3 = 1.0f / 6.0f;
+        const float F4 = 0.309016994f;
+        const float G4 = 0.138196601f;
+
+        // bring the extremes of each kernel to about +-1, measured over a few million samples
+        const float PERLIN2_SCALE = 1.0f;
+        const float PERLIN3_SCALE = 1.0f;
+        // random samples miss the 4d peaks (1.24 over 200m samples, 1.36 climbing the gradient from the largest), so
+        // 4d perlin is divided by its bound over every arrangement of corner gradients, 1.537, and never leaves +-1
+        const float PERLIN4_SCALE = 0.65f;
+        const float SIMPLEX2_SCALE = 70.0f;
+        const float SIMPLEX3_SCALE = 76.0f;
+        const float SIMPLEX4_SCALE = 62.0f;
+
+        ///////////////////////////////////////
+        //               LANES               //
+        ///////////////////////////////////////
+
+        // the scalar lane, floor goes through a truncation like the sse one so even the sign of zero matches
+        inline float floorLane(const float& a)
+        {
+            float t = (float)(int32_t)a;
+            return t > a ? t - 1.0f : t;
+        }
+
+        inline uint32_t toInt(const float& a)
+        {
+            return (uint32_t)(int32_t)a;
+        }
+
+        inline float select(const bool& mask, const float& a, const float& b)
+        {
+            return mask ? a : b;
+        }
+
+        inline bool greater(const float& a, const float& b)
+        {
+            return a > b;
+        }
+
+        inline float maxLane(const float& a, const float& b)
+        {
+            return a > b ? a : b;
+        }
+
+        inline bool bits(const uint32_t& h, const uint32_t& mask, const uint32_t& value)
+        {
+            return (h & mask) == value;
+        }
+
+#ifdef __SSE2__
+        struct lane4
+        {
+            __m128 v;
+
+            lane4() {}
+            explicit lane4(const __m128& v) : v(v) {}
+            explicit lane4(const float& v) : v(_mm_set1_ps(v)) {}
+        };
+
+        struct ilane4
+        {
+            __m128i v;
+
+            ilane4() {}
+            explicit ilane4(const __m128i& v) : v(v) {}
+            explicit ilane4(const uint32_t& v) : v(_mm_set1_epi32((int)v)) {}
+        };
+
+        inline lane4 operator+(const lane4& a, const lane4& b) { return lane4(_mm_add_ps(a.v, b.v)); }
+        inline lane4 operator-(const lane4& a, const lane4& b) { return lane4(_mm_sub_ps(a.v, b.v)); }
+        inline lane4 operator*(const lane4& a, const lane4& b) { return lane4(_mm_mul_ps(a.v, b.v)); }
+        inline lane4 operator&(const lane4& a, const lane4& b) { return lane4(_mm_and_ps(a.v, b.v)); }
+
+        inline ilane4 operator+(const ilane4& a, const ilane4& b) { return ilane4(_mm_add_epi32(a.v, b.v)); }
+        inline ilane4 operator^(const ilane4& a, const ilane4& b) { return ilane4(_mm_xor_si128(a.v, b.v)); }
+        inline ilane4 operator>>(const ilane4& a, const int& b) { return ilane4(_mm_srli_epi32(a.v, b)); }
+
+        // sse2 has no 32 bit low multiply, even and odd lanes go through the 64 bit one
+        inline ilane4 operator*(const ilane4& a, const ilane4& b)
+        {
+            __m128i even = _mm_mul_epu32(a.v, b.v);
+            __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+            return ilane4(_mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))));
+        }
+
+        inline lane4 floorLane(const lane4& a)
+        {
+            __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+            return lane4(_mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a.v), _mm_set1_ps(1.0f))));
+        }
+
+        inline ilane4 toInt(const lane4& a)
+        {
+            return ilane4(_mm_cvttps_epi32(a.v));
+        }
+
+        inline lane4 select(const lane4& mask, const lane4& a, const lane4& b)
+        {
+            return lane4(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)));
+        }
+
+        inline lane4 greater(const lane4& a, const lane4& b)
+        {
+            return lane4(_mm_cmpgt_ps(a.v, b.v));
+        }
+
+        inline lane4 maxLane(const lane4& a, const lane4& b)
+        {
+            return lane4(_mm_max_ps(a.v, b.v));
+        }
+
+        inline lane4 bits(const ilane4& h, const uint32_t& mask, const uint32_t& value)
+        {
+            return lane4(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h.v, _mm_set1_epi32((int)mask)), _mm_set1_epi32((int)value))));
+        }
+#endif // __SSE2__
+
+        ///////////////////////////////////////
+        //             LATTICE               //
+        ///////////////////////////////////////
+
+        //https://nullprogram.com/blog/2018/07/31/, lowbias32 over the scrambled coordinates
+        template<class I> inline I mix(I h)
+        {
+            h = h ^ (h >> 16);
+            h = h * I(0x7feb352du);
+            h = h ^ (h >> 15);
+            h = h * I(0x846ca68bu);
+            return h ^ (h >> 16);
+        }
+
+        template<class I> inline I hash(const I& seed, const I& x, const I& y)
+        {
+            return mix(seed ^ (x * I(0x8da6b343u)) ^ (y * I(0xd8163841u)));
+        }
+
+        template<class I> inline I hash(const I& seed, const I& x, const I& y, const I& z)
+        {
+            return mix(seed ^ (x * I(0x8da6b343u)) ^ (y * I(0xd8163841u)) ^ (z * I(0xcb1ab31fu)));
+        }
+
+        template<class I> inline I hash(const I& seed, const I& x, const I& y, const I& z, const I& w)
+        {
+            return mix(seed ^ (x * I(0x8da6b343u)) ^ (y * I(0xd8163841u)) ^ (z * I(0xcb1ab31fu)) ^ (w * I(0x165667b1u)));
+        }
+
+        // (+-1, +-1), (+-1, 0) and (0, +-1) from the low bits, selects instead of a table lookup
+        template<class F, class I> inline void gradient2(const I& h, F* g)
+        {
+            F sx = select(bits(h, 1u, 1u), F(-1.0f), F(1.0f));
+            F sy = select(bits(h, 8u, 8u), F(-1.0f), F(1.0f));
+            g[0] = select(bits(h, 6u, 6u), F(0.0f), sx);
+            g[1] = select(bits(h, 6u, 4u), F(0.0f), sy);
+        }
+
+        //https://mrl.cs.nyu.edu/~perlin/noise/, the twelve cube edges of improved noise
+        template<class F, class I> inline void gradient3(const I& h, F* g)
+        {
+            F su = select(bits(h, 1u, 1u), F(-1.0f), F(1.0f));
+            F sv = select(bits(h, 2u, 2u), F(-1.0f), F(1.0f));
+            F zero(0.0f);
+
+            // u is x below 8 and y above, v is y below 4, x for 12 and 14 and z otherwise
+            auto uX = bits(h, 8u, 0u);
+            auto vY = bits(h, 12u, 0u);
+            auto vX = bits(h, 13u, 12u);
+            g[0] = select(uX, su, zero) + select(vX, sv, zero);
+            g[1] = select(uX, zero, su) + select(vY, sv, zero);
+            g[2] = select(vY, zero, select(vX, zero, sv));
+        }
+
+        // one axis zero, the others +-1
+        template<class F, class I> inline void gradient4(const I& h, F* g)
+        {
+            for(uint32_t a = 0; a < 4; a++)
+            {
+                g[a] = select(bits(h, 3u, a), F(0.0f), select(bits(h, 4u << a, 4u << a), F(-1.0f), F(1.0f)));
+            }
+        }
+
+        template<class F> inline F fade(const F& t)
+        {
+            return t * t * t * (t * (t * F(6.0f) - F(15.0f)) + F(10.0f));
+        }
+
+        template<class F> inline F fadeDerivative(const F& t)
+        {
+            return F(30.0f) * t * t * (t * (t - F(2.0f)) + F(1.0f));
+        }
+
+        ///////////////////////////////////////
+        //              PERLIN               //
+        ///////////////////////////////////////
+
+        //https://iquilezles.org/articles/gradientnoise/
+        template<class F, class I> F perlin2(const F* p, F* gradient, const I& seed)
+        {
+            F fx = floorLane(p[0]), fy = floorLane(p[1]);
+            I ix = toInt(fx), iy = toInt(fy);
+            I ix1 = ix + I(1u), iy1 = iy + I(1u);
+            F x = p[0] - fx, y = p[1] - fy;
+            F x1 = x - F(1.0f), y1 = y - F(1.0f);
+
+            F ga[2], gb[2], gc[2], gd[2];
+            gradient2(hash(seed, ix, iy), ga);
+            gradient2(hash(seed, ix1, iy), gb);
+            gradient2(hash(seed, ix, iy1), gc);
+            gradient2(hash(seed, ix1, iy1), gd);
+
+            F a = ga[0] * x + ga[1] * y;
+            F b = gb[0] * x1 + gb[1] * y;
+            F c = gc[0] * x + gc[1] * y1;
+            F d = gd[0] * x1 + gd[1] * y1;
+
+            F u = fade(x), v = fade(y);
+            F k1 = b - a, k2 = c - a, k3 = a - b - c + d;
+
+            if(gradient)
+            {
+                F du = fadeDerivative(x), dv = fadeDerivative(y);
+                F g[2];
+                for(int k = 0; k < 2; k++)
+                {
+                    g[k] = ga[k] + u * (gb[k] - ga[k]) + v * (gc[k] - ga[k]) + u * v * (ga[k] - gb[k] - gc[k] + gd[k]);
+                }
+                gradient[0] = (g[0] + du * (k1 + v * k3)) * F(PERLIN2_SCALE);
+                gradient[1] = (g[1] + dv * (k2 + u * k3)) * F(PERLIN2_SCALE);
+            }
+
+            return (a + u * k1 + v * k2 + u * v * k3) * F(PERLIN2_SCALE);
+        }
+
+        template<class F, class I> F perlin3(const F* p, F* gradient, const I& seed)
+        {
+            F fx = floorLane(p[0]), fy = floorLane(p[1]), fz = floorLane(p[2]);
+            I ix = toInt(fx), iy = toInt(fy), iz = toInt(fz);
+            I ix1 = ix + I(1u), iy1 = iy + I(1u), iz1 = iz + I(1u);
+            F x = p[0] - fx, y = p[1] - fy, z = p[2] - fz;
+            F x1 = x - F(1.0f), y1 = y - F(1.0f), z1 = z - F(1.0f);
+
+            // corners a b c d on the z = 0 face, e f g h above them
+            F ga[3], gb[3], gc[3], gd[3], ge[3], gf[3], gg[3], gh[3];
+            gradient3(hash(seed, ix, iy, iz), ga);
+            gradient3(hash(seed, ix1, iy, iz), gb);
+            gradient3(hash(seed, ix, iy1, iz), gc);
+            gradient3(hash(seed, ix1, iy1, iz), gd);
+            gradient3(hash(seed, ix, iy, iz1), ge);
+            gradient3(hash(seed, ix1, iy, iz1), gf);
+            gradient3(hash(seed, ix, iy1, iz1), gg);
+            gradient3(hash(seed, ix1, iy1, iz1), gh);
+
+            F a = ga[0] * x + ga[1] * y + ga[2] * z;
+            F b = gb[0] * x1 + gb[1] * y + gb[2] * z;
+            F c = gc[0] * x + gc[1] * y1 + gc[2] * z;
+            F d = gd[0] * x1 + gd[1] * y1 + gd[2] * z;
+            F e = ge[0] * x + ge[1] * y + ge[2] * z1;
+            F f = gf[0] * x1 + gf[1] * y + gf[2] * z1;
+            F g = gg[0] * x + gg[1] * y1 + gg[2] * z1;
+            F h = gh[0] * x1 + gh[1] * y1 + gh[2] * z1;
+
+            F u = fade(x), v = fade(y), w = fade(z);
+            F k1 = b - a, k2 = c - a, k3 = e - a;
+            F k4 = a - b - c + d, k5 = a - c - e + g, k6 = a - b - e + f;
+            F k7 = b + c - a - d + e - f - g + h;
+
+            if(gradient)
+            {
+                F du = fadeDerivative(x), dv = fadeDerivative(y), dw = fadeDerivative(z);
+                F n[3];
+                for(int k = 0; k < 3; k++)
+                {
+                    n[k] = ga[k] + u * (gb[k] - ga[k]) + v * (gc[k] - ga[k]) + w * (ge[k] - ga[k]) +
+                           u * v * (ga[k] - gb[k] - gc[k] + gd[k]) + v * w * (ga[k] - gc[k] - ge[k] + gg[k]) +
+                           w * u * (ga[k] - gb[k] - ge[k] + gf[k]) +
+                           u * v * w * (gb[k] + gc[k] - ga[k] - gd[k] + ge[k] - gf[k] - gg[k] + gh[k]);
+                }
+                gradient[0] = (n[0] + du * (k1 + k4 * v + k6 * w + k7 * v * w)) * F(PERLIN3_SCALE);
+                gradient[1] = (n[1] + dv * (k2 + k5 * w + k4 * u + k7 * w * u)) * F(PERLIN3_SCALE);
+                gradient[2] = (n[2] + dw * (k3 + k6 * u + k5 * v + k7 * u * v)) * F(PERLIN3_SCALE);
+            }
+
+            return (a + k1 * u + k2 * v + k3 * w + k4 * u * v + k5 * v * w + k6 * w * u + k7 * u * v * w) * F(PERLIN3_SCALE);
+        }
+
+        // sixteen corners, corner c is one step up on axis k where bit k of c is set. the corners are blended one
+        // axis at a time, each blend halves them and carries the gradient along, the fade derivative of that axis
+        // goes into its own component
+        template<class F, class I> F perlin4(const F* p, F* gradient, const I& seed)
+        {
+            F f[4], d[2][4];
+            I i[2][4];
+            for(int k = 0; k < 4; k++)
+            {
+                f[k] = floorLane(p[k]);
+                i[0][k] = toInt(f[k]);
+                i[1][k] = i[0][k] + I(1u);
+                d[0][k] = p[k] - f[k];
+                d[1][k] = d[0][k] - F(1.0f);
+            }
+
+            F v[16], g[16][4];
+            for(int c = 0; c < 16; c++)
+            {
+                int x = c & 1, y = (c >> 1) & 1, z = (c >> 2) & 1, w = c >> 3;
+                gradient4(hash(seed, i[x][0], i[y][1], i[z][2], i[w][3]), g[c]);
+                v[c] = g[c][0] * d[x][0] + g[c][1] * d[y][1] + g[c][2] * d[z][2] + g[c][3] * d[w][3];
+            }
+
+            for(int a = 0, corners = 16; a < 4; a++)
+            {
+                F u = fade(d[0][a]);
+                F du = gradient ? fadeDerivative(d[0][a]) : F(0.0f);
+                corners /= 2;
+                for(int c = 0; c < corners; c++)
+                {
+                    // the low half of the remaining corners is the lower side of axis a, the high half the upper
+                    F lo = v[c * 2], hi = v[c * 2 + 1];
+                    v[c] = lo + u * (hi - lo);
+                    if(gradient)
+                    {
+                        for(int k = 0; k < 4; k++)
+                        {
+                            g[c][k] = g[c * 2][k] + u * (g[c * 2 + 1][k] - g[c * 2][k]);
+                        }
+                        g[c][a] = g[c][a] + du * (hi - lo);
+                    }
+                }
+            }
+
+            if(gradient)
+            {
+                for(int k = 0; k < 4; k++)
+                {
+                    gradient[k] = g[0][k] * F(PERLIN4_SCALE);
+                }
+            }
+            return v[0] * F(PERLIN4_SCALE);
+        }
+
+        ///////////////////////////////////////
+        //              SIMPLEX              //
+        ///////////////////////////////////////
+
+        // (0.5 - |d|^2)^4 (g . d), a radius of 0.5 keeps the sum and its derivative continuous
+        template<unsigned D, class F> inline F corner(const F* d, const F* g, F* gradient)
+        {
+            F dd = d[0] * d[0], gd = g[0] * d[0];
+            for(unsigned k = 1; k < D; k++)
+            {
+                dd = dd + d[k] * d[k];
+                gd = gd + g[k] * d[k];
+            }
+
+            F t = maxLane(F(0.5f) - dd, F(0.0f));
+            F t2 = t * t;
+            F t4 = t2 * t2;
+
+            if(gradient)
+            {
+                F k = F(-8.0f) * t2 * t * gd;
+                for(unsigned n = 0; n < D; n++)
+                {
+                    gradient[n] = gradient[n] + t4 * g[n] + k * d[n];
+                }
+            }
+
+            return t4 * gd;
+        }
+
+        template<class F> inline F step(const F& mask)
+        {
+            return select(mask, F(1.0f), F(0.0f));
+        }
+
+        template<class F, class I> F simplex2(const F* p, F* gradient, const I& seed)
+        {
+            F s = (p[0] + p[1]) * F(F2);
+            F fi = floorLane(p[0] + s), fj = floorLane(p[1] + s);
+            F t = (fi + fj) * F(G2);
+            I i = toInt(fi), j = toInt(fj);
+
+            F d0[2] = { p[0] - (fi - t), p[1] - (fj - t) };
+            F i1 = step(greater(d0[0], d0[1]));
+            F j1 = F(1.0f) - i1;
+            F d1[2] = { d0[0] - i1 + F(G2), d0[1] - j1 + F(G2) };
+            F d2[2] = { d0[0] - F(1.0f - 2.0f * G2), d0[1] - F(1.0f - 2.0f * G2) };
+
+            F g0[2], g1[2], g2[2];
+            gradient2(hash(seed, i, j), g0);
+            gradient2(hash(seed, i + toInt(i1), j + toInt(j1)), g1);
+            gradient2(hash(seed, i + I(1u), j + I(1u)), g2);
+
+            if(gradient)
+                gradient[0] = gradient[1] = F(0.0f);
+
+            // one statement per corner, they all add to gradient and the order of operands is unspecified
+            F res = corner<2>(d0, g0, gradient);
+            res = res + corner<2>(d1, g1, gradient);
+            res = res + corner<2>(d2, g2, gradient);
+
+            if(gradient)
+            {
+                gradient[0] = gradient[0] * F(SIMPLEX2_SCALE);
+                gradient[1] = gradient[1] * F(SIMPLEX2_SCALE);
+            }
+            return res * F(SIMPLEX2_SCALE);
+        }
+
+        // every pair of axes gives one rank to the larger, ties to the later axis, so the ranks are always
+        // a permutation and the corners a proper path through the simplex
+        template<unsigned D, class F> inline void ranks(const F* d, F* rank)
+        {
+            for(unsigned a = 0; a < D; a++)
+            {
+                rank[a] = F(0.0f);
+            }
+
+            for(unsigned a = 0; a < D; a++)
+            {
+                for(unsigned b = a + 1; b < D; b++)
+                {
+                    F larger = step(greater(d[a], d[b]));
+                    rank[a] = rank[a] + larger;
+                    rank[b] = rank[b] + (F(1.0f) - larger);
+                }
+            }
+        }
+
+        template<class F, class I> F simplex3(const F* p, F* gradient, const I& seed)
+        {
+            F s = (p[0] + p[1] + p[2]) * F(F3);
+            F fi[3] = { floorLane(p[0] + s), floorLane(p[1] + s), floorLane(p[2] + s) };
+            F t = (fi[0] + fi[1] + fi[2]) * F(G3);
+            I i[3] = { toInt(fi[0]), toInt(fi[1]), toInt(fi[2]) };
+
+            F d[4][3], rank[3], offset[2][3];
+            for(int k = 0; k < 3; k++)
+            {
+                d[0][k] = p[k] - (fi[k] - t);
+            }
+
+            ranks<3>(d[0], rank);
+            for(int k = 0; k < 3; k++)
+            {
+                offset[0][k] = step(greater(rank[k], F(1.5f)));
+                offset[1][k] = step(greater(rank[k], F(0.5f)));
+                d[1][k] = d[0][k] - offset[0][k] + F(G3);
+                d[2][k] = d[0][k] - offset[1][k] + F(2.0f * G3);
+                d[3][k] = d[0][k] - F(1.0f - 3.0f * G3);
+            }
+
+            F g[4][3];
+            gradient3(hash(seed, i[0], i[1], i[2]), g[0]);
+            gradient3(hash(seed, i[0] + toInt(offset[0][0]), i[1] + toInt(offset[0][1]), i[2] + toInt(offset[0][2])), g[1]);
+            gradient3(hash(seed, i[0] + toInt(offset[1][0]), i[1] + toInt(offset[1][1]), i[2] + toInt(offset[1][2])), g[2]);
+            gradient3(hash(seed, i[0] + I(1u), i[1] + I(1u), i[2] + I(1u)), g[3]);
+
+            if(gradient)
+                gradient[0] = gradient[1] = gradient[2] = F(0.0f);
+
+            F res = corner<3>(d[0], g[0], gradient);
+            for(int c = 1; c < 4; c++)
+            {
+                res = res + corner<3>(d[c], g[c], gradient);
+            }
+
+            if(gradient)
+            {
+                for(int k = 0; k < 3; k++)
+                {
+                    gradient[k] = gradient[k] * F(SIMPLEX3_SCALE);
+                }
+            }
+            return res * F(SIMPLEX3_SCALE);
+        }
+
+        template<class F, class I> F simplex4(const F* p, F* gradient, const I& seed)
+        {
+            F s = (p[0] + p[1] + p[2] + p[3]) * F(F4);
+            F fi[4] = { floorLane(p[0] + s), floorLane(p[1] + s), floorLane(p[2] + s), floorLane(p[3] + s) };
+            F t = (fi[0] + fi[1] + fi[2] + fi[3]) * F(G4);
+            I i[4] = { toInt(fi[0]), toInt(fi[1]), toInt(fi[2]), toInt(fi[3]) };
+
+            F d[5][4], rank[4], offset[3][4];
+            for(int k = 0; k < 4; k++)
+            {
+                d[0][k] = p[k] - (fi[k] - t);
+            }
+
+            ranks<4>(d[0], rank);
+            for(int k = 0; k < 4; k++)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    offset[c][k] = step(greater(rank[k], F(2.5f - (float)c)));
+                    d[c + 1][k] = d[0][k] - offset[c][k] + F(G4 * (float)(c + 1));
+                }
+                d[4][k] = d[0][k] - F(1.0f - 4.0f * G4);
+            }
+
+            F g[5][4];
+            gradient4(hash(seed, i[0], i[1], i[2], i[3]), g[0]);
+            for(int c = 0; c < 3; c++)
+            {
+                gradient4(hash(seed, i[0] + toInt(offset[c][0]), i[1] + toInt(offset[c][1]), i[2] + toInt(offset[c][2]), i[3] + toInt(offset[c][3])), g[c + 1]);
+            }
+            gradient4(hash(seed, i[0] + I(1u), i[1] + I(1u), i[2] + I(1u), i[3] + I(1u)), g[4]);
+
+            if(gradient)
+                gradient[0] = gradient[1] = gradient[2] = gradient[3] = F(0.0f);
+
+            F res = corner<4>(d[0], g[0], gradient);
+            for(int c = 1; c < 5; c++)
+            {
+                res = res + corner<4>(d[c], g[c], gradient);
+            }
+
+            if(gradient)
+            {
+                for(int k = 0; k < 4; k++)
+                {
+                    gradient[k] = gradient[k] * F(SIMPLEX4_SCALE);
+                }
+            }
+            return res * F(SIMPLEX4_SCALE);
+        }
+
+        ///////////////////////////////////////
+        //              BATCHES              //
+        ///////////////////////////////////////
+
+        struct perlin2Kernel
+        {
+            static const unsigned DIM = 2;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return perlin2(p, gradient, seed); }
+        };
+
+        struct perlin3Kernel
+        {
+            static const unsigned DIM = 3;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return perlin3(p, gradient, seed); }
+        };
+
+        struct perlin4Kernel
+        {
+            static const unsigned DIM = 4;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return perlin4(p, gradient, seed); }
+        };
+
+        struct simplex2Kernel
+        {
+            static const unsigned DIM = 2;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return simplex2(p, gradient, seed); }
+        };
+
+        struct simplex3Kernel
+        {
+            static const unsigned DIM = 3;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return simplex3(p, gradient, seed); }
+        };
+
+        struct simplex4Kernel
+        {
+            static const unsigned DIM = 4;
+            template<class F, class I> static F evaluate(const F* p, F* gradient, const I& seed) { return simplex4(p, gradient, seed); }
+        };
+
+        // octave o runs at frequency * lacunarity^o with seed + o, the sum is divided by the total amplitude
+        template<class K, class F, class I> F fbm(const F* p, F* gradient, const fbmSettings& settings, const uint32_t& seed)
+        {
+            const unsigned D = K::DIM;
+
+            F res(0.0f), q[D], g[D];
+            if(gradient)
+            {
+                for(unsigned k = 0; k < D; k++)
+                {
+                    gradient[k] = F(0.0f);
+                }
+            }
+
+            float frequency = settings.frequency, amplitude = 1.0f, total = 0.0f;
+            for(unsigned octave = 0; octave < settings.octaves; octave++)
+            {
+                for(unsigned k = 0; k < D; k++)
+                {
+                    q[k] = p[k] * F(frequency);
+                }
+
+                F v = K::evaluate(q, gradient ? g : nullptr, I(seed + octave));
+                res = res + v * F(amplitude);
+                if(gradient)
+                {
+                    for(unsigned k = 0; k < D; k++)
+                    {
+                        gradient[k] = gradient[k] + g[k] * F(amplitude * frequency);
+                    }
+                }
+
+                total += amplitude;
+                frequency *= settings.lacunarity;
+                amplitude *= settings.gain;
+            }
+
+            F scale(total > 0.0f ? 1.0f / total : 0.0f);
+            if(gradient)
+            {
+                for(unsigned k = 0; k < D; k++)
+                {
+                    gradient[k] = gradient[k] * scale;
+                }
+            }
+            return res * scale;
+        }
+
+        inline bool wantsGradient(const noiseOutput& res, const unsigned& dimensions)
+        {
+            const float* out[4] = { res.dx, res.dy, res.dz, res.dw };
+            for(unsigned k = 0; k < dimensions; k++)
+            {
+                if(out[k])
+                    return true;
+            }
+            return false;
+        }
+
+        template<class K> void stream(const noiseStreams& points, const unsigned& begin, const unsigned& end, const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+        {
+            const unsigned D = K::DIM;
+            const float* in[4] = { points.x, points.y, points.z, points.w };
+            float* out[4] = { res.dx, res.dy, res.dz, res.dw };
+            const bool gradient = wantsGradient(res, D);
+            unsigned n = begin;
+
+#ifdef __SSE2__
+            for(; n + 4 <= end; n += 4)
+            {
+                lane4 p[D], g[D];
+                for(unsigned k = 0; k < D; k++)
+                {
+                    p[k] = lane4(_mm_loadu_ps(in[k] + n));
+                }
+
+                lane4 v = fbm<K, lane4, ilane4>(p, gradient ? g : nullptr, settings, seed);
+                if(res.value)
+                    _mm_storeu_ps(res.value + n, v.v);
+                for(unsigned k = 0; k < D && gradient; k++)
+                {
+                    if(out[k])
+                        _mm_storeu_ps(out[k] + n, g[k].v);
+                }
+            }
+#endif // __SSE2__
+
+            for(; n < end; n++)
+            {
+                float p[D], g[D];
+                for(unsigned k = 0; k < D; k++)
+                {
+                    p[k] = in[k][n];
+                }
+
+                float v = fbm<K, float, uint32_t>(p, gradient ? g : nullptr, settings, seed);
+                if(res.value)
+                    res.value[n] = v;
+                for(unsigned k = 0; k < D && gradient; k++)
+                {
+                    if(out[k])
+                        out[k][n] = g[k];
+                }
+            }
+        }
+
+        // rows [begin, end) of a width * height * depth grid, a row is one y and z
+        template<class K> void gridRows(const float* origin, const float* step, const unsigned& width, const unsigned& height,
+                                        const unsigned& begin, const unsigned& end, const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+        {
+            const unsigned D = K::DIM;
+            float* out[4] = { res.dx, res.dy, res.dz, res.dw };
+            const bool gradient = wantsGradient(res, D);
+
+            for(unsigned row = begin; row < end; row++)
+            {
+                float y = origin[1] + (float)(row % height) * step[1];
+                float z = D > 2 ? origin[2] + (float)(row / height) * step[2] : 0.0f;
+                size_t first = (size_t)row * width;
+                unsigned column = 0;
+
+#ifdef __SSE2__
+                for(; column + 4 <= width; column += 4)
+                {
+                    lane4 p[D], g[D];
+                    __m128 index = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((int)column), _mm_set_epi32(3, 2, 1, 0)));
+                    p[0] = lane4(_mm_add_ps(_mm_set1_ps(origin[0]), _mm_mul_ps(index, _mm_set1_ps(step[0]))));
+                    p[1] = lane4(y);
+                    if(D > 2)
+                        p[2] = lane4(z);
+
+                    lane4 v = fbm<K, lane4, ilane4>(p, gradient ? g : nullptr, settings, seed);
+                    if(res.value)
+                        _mm_storeu_ps(res.value + first + column, v.v);
+                    for(unsigned k = 0; k < D && gradient; k++)
+                    {
+                        if(out[k])
+                            _mm_storeu_ps(out[k] + first + column, g[k].v);
+                    }
+                }
+#endif // __SSE2__
+
+                for(; column < width; column++)
+                {
+                    float p[D], g[D];
+                    p[0] = origin[0] + (float)column * step[0];
+                    p[1] = y;
+                    if(D > 2)
+                        p[2] = z;
+
+                    float v = fbm<K, float, uint32_t>(p, gradient ? g : nullptr, settings, seed);
+                    if(res.value)
+                        res.value[first + column] = v;
+                    for(unsigned k = 0; k < D && gradient; k++)
+                    {
+                        if(out[k])
+                            out[k][first + column] = g[k];
+                    }
+                }
+            }
+        }
+
+        struct kernels
+        {
+            void (*stream)(const noiseStreams&, const unsigned&, const unsigned&, const noiseOutput&, const fbmSettings&, const uint32_t&);
+            void (*grid)(const float*, const float*, const unsigned&, const unsigned&, const unsigned&, const unsigned&, const noiseOutput&, const fbmSettings&, const uint32_t&);
+        };
+
+        template<class K> kernels kernelsOf()
+        {
+            kernels res = { &stream<K>, &gridRows<K> };
+            return res;
+        }
+
+        bool find(const noise::type& kind, const unsigned& dimensions, kernels& res)
+        {
+            if(kind == noise::PERLIN && dimensions == 2)
+                res = kernelsOf<perlin2Kernel>();
+            else if(kind == noise::PERLIN && dimensions == 3)
+                res = kernelsOf<perlin3Kernel>();
+            else if(kind == noise::PERLIN && dimensions == 4)
+                res = kernelsOf<perlin4Kernel>();
+            else if(kind == noise::SIMPLEX && dimensions == 2)
+                res = kernelsOf<simplex2Kernel>();
+            else if(kind == noise::SIMPLEX && dimensions == 3)
+                res = kernelsOf<simplex3Kernel>();
+            else if(kind == noise::SIMPLEX && dimensions == 4)
+                res = kernelsOf<simplex4Kernel>();
+            else
+                return false;
+
+            return true;
+        }
+
+        unsigned rowGrain(const unsigned& width)
+        {
+            return std::max(GRAIN / std::max(width, 1u), 1u);
+        }
+    }
+
+    fbmSettings::fbmSettings() : octaves(1), frequency(1.0f), lacunarity(2.0f), gain(0.5f) {}
+    fbmSettings::fbmSettings(const unsigned& octaves, const float& frequency, const float& lacunarity, const float& gain) :
+        octaves(octaves), frequency(frequency), lacunarity(lacunarity), gain(gain) {}
+
+    ///////////////////////////////////////
+    //              SINGLE               //
+    ///////////////////////////////////////
+
+    float noise::perlin(const vec2& p, vec2* gradient, const uint32_t& seed)
+    {
+        return perlin2<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::perlin(const vec3& p, vec3* gradient, const uint32_t& seed)
+    {
+        return perlin3<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::perlin(const vec4& p, vec4* gradient, const uint32_t& seed)
+    {
+        return perlin4<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::simplex(const vec2& p, vec2* gradient, const uint32_t& seed)
+    {
+        return simplex2<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::simplex(const vec3& p, vec3* gradient, const uint32_t& seed)
+    {
+        return simplex3<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::simplex(const vec4& p, vec4* gradient, const uint32_t& seed)
+    {
+        return simplex4<float, uint32_t>(&p.x, gradient ? &gradient->x : nullptr, seed);
+    }
+
+    float noise::fbm(const type& kind, const vec2& p, const fbmSettings& settings, vec2* gradient, const uint32_t& seed)
+    {
+        float* g = gradient ? &gradient->x : nullptr;
+        if(kind == PERLIN)
+            return m3d::fbm<perlin2Kernel, float, uint32_t>(&p.x, g, settings, seed);
+        return m3d::fbm<simplex2Kernel, float, uint32_t>(&p.x, g, settings, seed);
+    }
+
+    float noise::fbm(const type& kind, const vec3& p, const fbmSettings& settings, vec3* gradient, const uint32_t& seed)
+    {
+        float* g = gradient ? &gradient->x : nullptr;
+        if(kind == PERLIN)
+            return m3d::fbm<perlin3Kernel, float, uint32_t>(&p.x, g, settings, seed);
+        return m3d::fbm<simplex3Kernel, float, uint32_t>(&p.x, g, settings, seed);
+    }
+
+    ///////////////////////////////////////
+    //              BATCHES              //
+    ///////////////////////////////////////
+
+    bool noise::evaluate(const type& kind, const unsigned& dimensions, const noiseStreams& points, const unsigned& count,
+                         const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::evaluate");
+
+        kernels k;
+        if(!find(kind, dimensions, k))
+            return false;
+
+        k.stream(points, 0, count, res, settings, seed);
+        return true;
+    }
+
+    bool noise::evaluateParallel(const type& kind, const unsigned& dimensions, const noiseStreams& points, const unsigned& count,
+                                 const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::evaluateParallel");
+
+        kernels k;
+        if(!find(kind, dimensions, k))
+            return false;
+
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            k.stream(points, begin, end, res, settings, seed);
+        });
+        return true;
+    }
+
+    void noise::grid(const type& kind, const vec2& origin, const vec2& step, const unsigned& width, const unsigned& height,
+                     const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::grid(2d)");
+
+        kernels k;
+        if(!find(kind, 2, k))
+            return;
+
+        k.grid(&origin.x, &step.x, width, height, 0, height, res, settings, seed);
+    }
+
+    void noise::grid(const type& kind, const vec3& origin, const vec3& step, const unsigned& width, const unsigned& height, const unsigned& depth,
+                     const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::grid(3d)");
+
+        kernels k;
+        if(!find(kind, 3, k))
+            return;
+
+        k.grid(&origin.x, &step.x, width, height, 0, height * depth, res, settings, seed);
+    }
+
+    void noise::gridParallel(const type& kind, const vec2& origin, const vec2& step, const unsigned& width, const unsigned& height,
+                             const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::gridParallel(2d)");
+
+        kernels k;
+        if(!find(kind, 2, k))
+            return;
+
+        parallelFor(height, rowGrain(width), [&](unsigned begin, unsigned end)
+        {
+            k.grid(&origin.x, &step.x, width, height, begin, end, res, settings, seed);
+        });
+    }
+
+    void noise::gridParallel(const type& kind, const vec3& origin, const vec3& step, const unsigned& width, const unsigned& height, const unsigned& depth,
+                             const noiseOutput& res, const fbmSettings& settings, const uint32_t& seed)
+    {
+        M3D_PROFILE("noise::gridParallel(3d)");
+
+        kernels k;
+        if(!find(kind, 3, k))
+            return;
+
+        parallelFor(height * depth, rowGrain(width), [&](unsigned begin, unsigned end)
+        {
+            k.grid(&origin.x, &step.x, width, height, begin, end, res, settings, seed);
+        });
+    }
+}
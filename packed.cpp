@@ -0,0 +1,718 @@
+#include "m3d/packed.h"
+#include "m3d/vec2.h"
+#include "m3d/vec3.h"
+#include "m3d/vec4.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif // __F16C__
+
+namespace m3d
+{
+    namespace
+    {
+        inline uint32_t floatBits(const float& v)
+        {
+            uint32_t res;
+            memcpy(&res, &v, sizeof(res));
+            return res;
+        }
+
+        inline float bitsFloat(const uint32_t& v)
+        {
+            float res;
+            memcpy(&res, &v, sizeof(res));
+            return res;
+        }
+
+        inline float signNotZero(const float& v)
+        {
+            return v >= 0.0f ? 1.0f : -1.0f;
+        }
+
+        // [lo, 1] written as compares instead of fmaxf/fminf, so every nan goes to lo (fmaxf makes a signaling nan
+        // a nan that fminf then takes to 1) and the compiler can use minss/maxss like the batches use min_ps/max_ps
+        inline float clampUnit(const float& v, const float& lo)
+        {
+            float res = v > lo ? v : lo;
+            return res < 1.0f ? res : 1.0f;
+        }
+
+#ifdef __SSE2__
+        // the batch kernels repeat the scalar functions op for op, so they return the same bits. max_ps and min_ps
+        // are the compares of clampUnit, cvtps_epi32 rounds to nearest even like lrintf
+
+        inline __m128 select(const __m128& mask, const __m128& a, const __m128& b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        inline __m128i select(const __m128i& mask, const __m128i& a, const __m128i& b)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        inline __m128 abs4(const __m128& v)
+        {
+            return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+        }
+
+        inline __m128 signNotZero4(const __m128& v)
+        {
+            return select(_mm_cmpge_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f), _mm_set1_ps(-1.0f));
+        }
+
+        // packSnorm / packUnorm before the cast
+        inline __m128i quantize4(const __m128& v, const __m128& lo, const __m128& scale)
+        {
+            return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, lo), _mm_set1_ps(1.0f)), scale));
+        }
+
+        // unpackSnorm / unpackUnorm of four integers, lo is -1 for snorm and 0 for unorm where the max changes nothing
+        inline void unpack4(const __m128i& v, const __m128& scale, const __m128& lo, float* out)
+        {
+            _mm_storeu_ps(out, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), scale), lo));
+        }
+
+        // 8 and 16 bit integers to 32 bits, the arithmetic shifts sign extend
+        inline __m128i signExtendLow16(const __m128i& v) { return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16); }
+        inline __m128i signExtendHigh16(const __m128i& v) { return _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16); }
+        inline __m128i signExtendLow8(const __m128i& v) { return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8); }
+        inline __m128i signExtendHigh8(const __m128i& v) { return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8); }
+
+        // floatToHalf of four lanes, the half is sign extended from the low 16 bits so packs_epi32 keeps it
+        inline __m128i floatToHalf4(const __m128& v)
+        {
+            const __m128i f32infty = _mm_set1_epi32(255 << 23);
+            const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+            const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+
+            __m128i f = _mm_castps_si128(v);
+            __m128i sign = _mm_and_si128(f, _mm_set1_epi32((int)0x80000000u));
+            f = _mm_xor_si128(f, sign);
+
+            // f has no sign bit left, the signed compares work
+            __m128i overflow = _mm_cmpgt_epi32(f, _mm_sub_epi32(f16max, _mm_set1_epi32(1)));
+            __m128i infNan = select(_mm_cmpgt_epi32(f, f32infty), _mm_set1_epi32(0x7e00), _mm_set1_epi32(0x7c00));
+
+            __m128i denormal = _mm_cmplt_epi32(f, _mm_set1_epi32(113 << 23));
+            __m128i small = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(f), _mm_castsi128_ps(denormMagic))), denormMagic);
+
+            __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(f, 13), _mm_set1_epi32(1));
+            __m128i normal = _mm_add_epi32(f, _mm_set1_epi32((int)((uint32_t)(15 - 127) << 23)));
+            normal = _mm_add_epi32(normal, _mm_add_epi32(_mm_set1_epi32(0xfff), mantissaOdd));
+            normal = _mm_srli_epi32(normal, 13);
+
+            __m128i res = select(overflow, infNan, select(denormal, small, normal));
+            res = _mm_or_si128(res, _mm_srli_epi32(sign, 16));
+            return _mm_srai_epi32(_mm_slli_epi32(res, 16), 16);
+        }
+
+        // halfToFloat of four halves zero extended to 32 bits
+        inline __m128 halfToFloat4(const __m128i& h)
+        {
+            const __m128i shiftedExp = _mm_set1_epi32(0x7c00 << 13);
+
+            __m128i res = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+            __m128i exp = _mm_and_si128(res, shiftedExp);
+            res = _mm_add_epi32(res, _mm_set1_epi32((127 - 15) << 23));
+
+            res = _mm_add_epi32(res, _mm_and_si128(_mm_cmpeq_epi32(exp, shiftedExp), _mm_set1_epi32((128 - 16) << 23)));
+
+            __m128i denormal = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(res, _mm_set1_epi32(1 << 23))),
+                                                           _mm_castsi128_ps(_mm_set1_epi32(113 << 23))));
+            res = select(_mm_cmpeq_epi32(exp, _mm_setzero_si128()), denormal, res);
+
+            res = _mm_or_si128(res, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16));
+            return _mm_castsi128_ps(res);
+        }
+
+        // x y z of four tightly packed vec3s
+        inline void loadVec3s4(const vec3* in, __m128& x, __m128& y, __m128& z)
+        {
+            const float* src = &in[0].x;
+            __m128 r0 = _mm_loadu_ps(src);
+            __m128 r1 = _mm_loadu_ps(src + 4);
+            __m128 r2 = _mm_loadu_ps(src + 8);
+
+            __m128 p0 = r0;
+            __m128 t = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 3, 3));
+            __m128 p1 = _mm_shuffle_ps(t, r1, _MM_SHUFFLE(0, 1, 2, 0));
+            __m128 p2 = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 0, 3, 2));
+            __m128 p3 = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 2, 1));
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            x = p0;
+            y = p1;
+            z = p2;
+        }
+
+        inline void storeVec3s4(vec3* out, __m128 x, __m128 y, __m128 z)
+        {
+            __m128 w = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+
+            // x y z rows back into x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+            __m128 t = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 2, 2));
+            float* dst = &out[0].x;
+            _mm_storeu_ps(dst, _mm_shuffle_ps(x, t, _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(dst + 4, _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 0, 2, 1)));
+            t = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 0, 2, 2));
+            _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t, w, _MM_SHUFFLE(2, 1, 2, 0)));
+        }
+#endif // __SSE2__
+    }
+
+    //https://gist.github.com/rygorous/2156668
+    uint16_t packed::floatToHalf(const float& v)
+    {
+        const uint32_t f32infty = 255u << 23;
+        const uint32_t f16max = (127u + 16u) << 23;
+        const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        uint32_t f = floatBits(v);
+        uint32_t sign = f & 0x80000000u;
+        f ^= sign;
+
+        uint16_t res;
+        if(f >= f16max)
+        {
+            // overflow to inf, keep nan a nan
+            res = f > f32infty ? 0x7e00 : 0x7c00;
+        }
+        else if(f < (113u << 23))
+        {
+            // the float add does the denormal rounding for us
+            res = (uint16_t)(floatBits(bitsFloat(f) + bitsFloat(denormMagic)) - denormMagic);
+        }
+        else
+        {
+            uint32_t mantissaOdd = (f >> 13) & 1;
+            f += (uint32_t)(15 - 127) << 23;
+            f += 0xfff + mantissaOdd;
+            res = (uint16_t)(f >> 13);
+        }
+
+        return res | (uint16_t)(sign >> 16);
+    }
+
+    float packed::halfToFloat(const uint16_t& v)
+    {
+        const uint32_t shiftedExp = 0x7c00u << 13;
+
+        uint32_t res = (uint32_t)(v & 0x7fff) << 13;
+        uint32_t exp = res & shiftedExp;
+        res += (127u - 15u) << 23;
+
+        if(exp == shiftedExp)
+        {
+            // inf / nan
+            res += (128u - 16u) << 23;
+        }
+        else if(exp == 0)
+        {
+            // zero / denormal, renormalize through the fpu
+            res += 1u << 23;
+            res = floatBits(bitsFloat(res) - bitsFloat(113u << 23));
+        }
+
+        res |= (uint32_t)(v & 0x8000) << 16;
+        return bitsFloat(res);
+    }
+
+    //http://jcgt.org/published/0003/02/01/
+    vec2 packed::octahedralEncode(const vec3& v)
+    {
+        float invL1 = 1.0f / (fabsf(v.x) + fabsf(v.y) + fabsf(v.z));
+        vec2 res(v.x * invL1, v.y * invL1);
+
+        if(v.z < 0.0f)
+        {
+            float x = res.x;
+            res.x = (1.0f - fabsf(res.y)) * signNotZero(x);
+            res.y = (1.0f - fabsf(x)) * signNotZero(res.y);
+        }
+
+        return res;
+    }
+
+    vec3 packed::octahedralDecode(const vec2& v)
+    {
+        vec3 res(v.x, v.y, 1.0f - fabsf(v.x) - fabsf(v.y));
+
+        if(res.z < 0.0f)
+        {
+            float x = res.x;
+            res.x = (1.0f - fabsf(res.y)) * signNotZero(x);
+            res.y = (1.0f - fabsf(x)) * signNotZero(res.y);
+        }
+
+        return vec3::normalized(res);
+    }
+
+    uint32_t packed::packOctahedral(const vec3& v)
+    {
+        vec2 e = octahedralEncode(v);
+        return (uint32_t)(uint16_t)packSnorm16(e.x) | ((uint32_t)(uint16_t)packSnorm16(e.y) << 16);
+    }
+
+    vec3 packed::unpackOctahedral(const uint32_t& v)
+    {
+        vec2 e(unpackSnorm16((int16_t)(v & 0xffff)), unpackSnorm16((int16_t)(v >> 16)));
+        return octahedralDecode(e);
+    }
+
+    int8_t packed::packSnorm8(const float& v)
+    {
+        return (int8_t)lrintf(clampUnit(v, -1.0f) * 127.0f);
+    }
+
+    float packed::unpackSnorm8(const int8_t& v)
+    {
+        return fmaxf((float)v * (1.0f / 127.0f), -1.0f);
+    }
+
+    uint8_t packed::packUnorm8(const float& v)
+    {
+        return (uint8_t)lrintf(clampUnit(v, 0.0f) * 255.0f);
+    }
+
+    float packed::unpackUnorm8(const uint8_t& v)
+    {
+        return (float)v * (1.0f / 255.0f);
+    }
+
+    int16_t packed::packSnorm16(const float& v)
+    {
+        return (int16_t)lrintf(clampUnit(v, -1.0f) * 32767.0f);
+    }
+
+    float packed::unpackSnorm16(const int16_t& v)
+    {
+        return fmaxf((float)v * (1.0f / 32767.0f), -1.0f);
+    }
+
+    uint16_t packed::packUnorm16(const float& v)
+    {
+        return (uint16_t)lrintf(clampUnit(v, 0.0f) * 65535.0f);
+    }
+
+    float packed::unpackUnorm16(const uint16_t& v)
+    {
+        return (float)v * (1.0f / 65535.0f);
+    }
+
+    ///////////////////////////////////////
+    //              BATCH                //
+    ///////////////////////////////////////
+
+    void packed::packOctahedral(const vec3* in, uint32_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 x, y, z;
+            loadVec3s4(in + n, x, y, z);
+
+            __m128 invL1 = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(abs4(x), abs4(y)), abs4(z)));
+            __m128 ex = _mm_mul_ps(x, invL1);
+            __m128 ey = _mm_mul_ps(y, invL1);
+
+            __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+            __m128 fx = _mm_mul_ps(_mm_sub_ps(one, abs4(ey)), signNotZero4(ex));
+            __m128 fy = _mm_mul_ps(_mm_sub_ps(one, abs4(ex)), signNotZero4(ey));
+            ex = select(lower, fx, ex);
+            ey = select(lower, fy, ey);
+
+            __m128i px = _mm_and_si128(quantize4(ex, lo, scale), _mm_set1_epi32(0xffff));
+            __m128i py = _mm_slli_epi32(quantize4(ey, lo, scale), 16);
+            _mm_storeu_si128((__m128i*)(out + n), _mm_or_si128(px, py));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packOctahedral(in[n]);
+    }
+
+    void packed::unpackOctahedral(const uint32_t* in, vec3* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(1.0f / 32767.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + n));
+            __m128 x = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)), scale), lo);
+            __m128 y = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(v, 16)), scale), lo);
+            __m128 z = _mm_sub_ps(_mm_sub_ps(one, abs4(x)), abs4(y));
+
+            __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+            __m128 fx = _mm_mul_ps(_mm_sub_ps(one, abs4(y)), signNotZero4(x));
+            __m128 fy = _mm_mul_ps(_mm_sub_ps(one, abs4(x)), signNotZero4(y));
+            x = select(lower, fx, x);
+            y = select(lower, fy, y);
+
+            // vec3::normalized, a zero length is left as it is
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+            __m128 nonZero = _mm_cmpneq_ps(length, _mm_setzero_ps());
+            storeVec3s4(out + n, select(nonZero, _mm_div_ps(x, length), x), select(nonZero, _mm_div_ps(y, length), y),
+                        select(nonZero, _mm_div_ps(z, length), z));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackOctahedral(in[n]);
+    }
+
+    void packed::packHalf(const float* in, uint16_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __F16C__
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + n), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128((__m128i*)(out + n), h);
+        }
+#endif // __F16C__
+#ifdef __SSE2__
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i h = _mm_packs_epi32(floatToHalf4(_mm_loadu_ps(in + n)), floatToHalf4(_mm_loadu_ps(in + n + 4)));
+            _mm_storeu_si128((__m128i*)(out + n), h);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = floatToHalf(in[n]);
+    }
+
+    void packed::unpackHalf(const uint16_t* in, float* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __F16C__
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i h = _mm_loadu_si128((const __m128i*)(in + n));
+            _mm256_storeu_ps(out + n, _mm256_cvtph_ps(h));
+        }
+#endif // __F16C__
+#ifdef __SSE2__
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i h = _mm_loadu_si128((const __m128i*)(in + n));
+            _mm_storeu_ps(out + n, halfToFloat4(_mm_unpacklo_epi16(h, _mm_setzero_si128())));
+            _mm_storeu_ps(out + n + 4, halfToFloat4(_mm_unpackhi_epi16(h, _mm_setzero_si128())));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = halfToFloat(in[n]);
+    }
+
+    // the integers are in range before the saturating packs, they only narrow
+
+    void packed::packSnorm8(const float* in, int8_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(127.0f);
+        for(; n + 16 <= count; n += 16)
+        {
+            __m128i a = _mm_packs_epi32(quantize4(_mm_loadu_ps(in + n), lo, scale), quantize4(_mm_loadu_ps(in + n + 4), lo, scale));
+            __m128i b = _mm_packs_epi32(quantize4(_mm_loadu_ps(in + n + 8), lo, scale), quantize4(_mm_loadu_ps(in + n + 12), lo, scale));
+            _mm_storeu_si128((__m128i*)(out + n), _mm_packs_epi16(a, b));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packSnorm8(in[n]);
+    }
+
+    void packed::unpackSnorm8(const int8_t* in, float* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(1.0f / 127.0f);
+        for(; n + 16 <= count; n += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + n));
+            __m128i a = signExtendLow8(v), b = signExtendHigh8(v);
+            unpack4(signExtendLow16(a), scale, lo, out + n);
+            unpack4(signExtendHigh16(a), scale, lo, out + n + 4);
+            unpack4(signExtendLow16(b), scale, lo, out + n + 8);
+            unpack4(signExtendHigh16(b), scale, lo, out + n + 12);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackSnorm8(in[n]);
+    }
+
+    void packed::packUnorm8(const float* in, uint8_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 scale = _mm_set1_ps(255.0f);
+        for(; n + 16 <= count; n += 16)
+        {
+            __m128i a = _mm_packs_epi32(quantize4(_mm_loadu_ps(in + n), lo, scale), quantize4(_mm_loadu_ps(in + n + 4), lo, scale));
+            __m128i b = _mm_packs_epi32(quantize4(_mm_loadu_ps(in + n + 8), lo, scale), quantize4(_mm_loadu_ps(in + n + 12), lo, scale));
+            _mm_storeu_si128((__m128i*)(out + n), _mm_packus_epi16(a, b));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packUnorm8(in[n]);
+    }
+
+    void packed::unpackUnorm8(const uint8_t* in, float* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+        const __m128i zero = _mm_setzero_si128();
+        for(; n + 16 <= count; n += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + n));
+            __m128i a = _mm_unpacklo_epi8(v, zero), b = _mm_unpackhi_epi8(v, zero);
+            unpack4(_mm_unpacklo_epi16(a, zero), scale, lo, out + n);
+            unpack4(_mm_unpackhi_epi16(a, zero), scale, lo, out + n + 4);
+            unpack4(_mm_unpacklo_epi16(b, zero), scale, lo, out + n + 8);
+            unpack4(_mm_unpackhi_epi16(b, zero), scale, lo, out + n + 12);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackUnorm8(in[n]);
+    }
+
+    void packed::packSnorm16(const float* in, int16_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i a = _mm_packs_epi32(quantize4(_mm_loadu_ps(in + n), lo, scale), quantize4(_mm_loadu_ps(in + n + 4), lo, scale));
+            _mm_storeu_si128((__m128i*)(out + n), a);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packSnorm16(in[n]);
+    }
+
+    void packed::unpackSnorm16(const int16_t* in, float* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_set1_ps(-1.0f);
+        const __m128 scale = _mm_set1_ps(1.0f / 32767.0f);
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + n));
+            unpack4(signExtendLow16(v), scale, lo, out + n);
+            unpack4(signExtendHigh16(v), scale, lo, out + n + 4);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackSnorm16(in[n]);
+    }
+
+    void packed::packUnorm16(const float* in, uint16_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 scale = _mm_set1_ps(65535.0f);
+        // sse2 only packs to signed 16 bits, the values are moved down by 32768 and the top bit flipped back after
+        const __m128i bias = _mm_set1_epi32(32768);
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i a = _mm_sub_epi32(quantize4(_mm_loadu_ps(in + n), lo, scale), bias);
+            __m128i b = _mm_sub_epi32(quantize4(_mm_loadu_ps(in + n + 4), lo, scale), bias);
+            _mm_storeu_si128((__m128i*)(out + n), _mm_xor_si128(_mm_packs_epi32(a, b), _mm_set1_epi16((short)0x8000)));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packUnorm16(in[n]);
+    }
+
+    void packed::unpackUnorm16(const uint16_t* in, float* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 lo = _mm_setzero_ps();
+        const __m128 scale = _mm_set1_ps(1.0f / 65535.0f);
+        const __m128i zero = _mm_setzero_si128();
+        for(; n + 8 <= count; n += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + n));
+            unpack4(_mm_unpacklo_epi16(v, zero), scale, lo, out + n);
+            unpack4(_mm_unpackhi_epi16(v, zero), scale, lo, out + n + 4);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackUnorm16(in[n]);
+    }
+
+    // the vector types are tightly packed floats, so the streams forward to the float versions
+
+    void packed::packHalf(const vec2* in, uint16_t* out, const unsigned& count)
+    {
+        packHalf((const float*)in, out, count * 2);
+    }
+
+    void packed::packHalf(const vec3* in, uint16_t* out, const unsigned& count)
+    {
+        packHalf((const float*)in, out, count * 3);
+    }
+
+    void packed::packHalf(const vec4* in, uint16_t* out, const unsigned& count)
+    {
+        packHalf((const float*)in, out, count * 4);
+    }
+
+    void packed::unpackHalf(const uint16_t* in, vec2* out, const unsigned& count)
+    {
+        unpackHalf(in, (float*)out, count * 2);
+    }
+
+    void packed::unpackHalf(const uint16_t* in, vec3* out, const unsigned& count)
+    {
+        unpackHalf(in, (float*)out, count * 3);
+    }
+
+    void packed::unpackHalf(const uint16_t* in, vec4* out, const unsigned& count)
+    {
+        unpackHalf(in, (float*)out, count * 4);
+    }
+
+    void packed::packSnorm8(const vec2* in, int8_t* out, const unsigned& count)
+    {
+        packSnorm8((const float*)in, out, count * 2);
+    }
+
+    void packed::packSnorm8(const vec3* in, int8_t* out, const unsigned& count)
+    {
+        packSnorm8((const float*)in, out, count * 3);
+    }
+
+    void packed::packSnorm8(const vec4* in, int8_t* out, const unsigned& count)
+    {
+        packSnorm8((const float*)in, out, count * 4);
+    }
+
+    void packed::unpackSnorm8(const int8_t* in, vec2* out, const unsigned& count)
+    {
+        unpackSnorm8(in, (float*)out, count * 2);
+    }
+
+    void packed::unpackSnorm8(const int8_t* in, vec3* out, const unsigned& count)
+    {
+        unpackSnorm8(in, (float*)out, count * 3);
+    }
+
+    void packed::unpackSnorm8(const int8_t* in, vec4* out, const unsigned& count)
+    {
+        unpackSnorm8(in, (float*)out, count * 4);
+    }
+
+    void packed::packUnorm8(const vec2* in, uint8_t* out, const unsigned& count)
+    {
+        packUnorm8((const float*)in, out, count * 2);
+    }
+
+    void packed::packUnorm8(const vec3* in, uint8_t* out, const unsigned& count)
+    {
+        packUnorm8((const float*)in, out, count * 3);
+    }
+
+    void packed::packUnorm8(const vec4* in, uint8_t* out, const unsigned& count)
+    {
+        packUnorm8((const float*)in, out, count * 4);
+    }
+
+    void packed::unpackUnorm8(const uint8_t* in, vec2* out, const unsigned& count)
+    {
+        unpackUnorm8(in, (float*)out, count * 2);
+    }
+
+    void packed::unpackUnorm8(const uint8_t* in, vec3* out, const unsigned& count)
+    {
+        unpackUnorm8(in, (float*)out, count * 3);
+    }
+
+    void packed::unpackUnorm8(const uint8_t* in, vec4* out, const unsigned& count)
+    {
+        unpackUnorm8(in, (float*)out, count * 4);
+    }
+
+    void packed::packSnorm16(const vec2* in, int16_t* out, const unsigned& count)
+    {
+        packSnorm16((const float*)in, out, count * 2);
+    }
+
+    void packed::packSnorm16(const vec3* in, int16_t* out, const unsigned& count)
+    {
+        packSnorm16((const float*)in, out, count * 3);
+    }
+
+    void packed::packSnorm16(const vec4* in, int16_t* out, const unsigned& count)
+    {
+        packSnorm16((const float*)in, out, count * 4);
+    }
+
+    void packed::unpackSnorm16(const int16_t* in, vec2* out, const unsigned& count)
+    {
+        unpackSnorm16(in, (float*)out, count * 2);
+    }
+
+    void packed::unpackSnorm16(const int16_t* in, vec3* out, const unsigned& count)
+    {
+        unpackSnorm16(in, (float*)out, count * 3);
+    }
+
+    void packed::unpackSnorm16(const int16_t* in, vec4* out, const unsigned& count)
+    {
+        unpackSnorm16(in, (float*)out, count * 4);
+    }
+
+    void packed::packUnorm16(const vec2* in, uint16_t* out, const unsigned& count)
+    {
+        packUnorm16((const float*)in, out, count * 2);
+    }
+
+    void packed::packUnorm16(const vec3* in, uint16_t* out, const unsigned& count)
+    {
+        packUnorm16((const float*)in, out, count * 3);
+    }
+
+    void packed::packUnorm16(const vec4* in, uint16_t* out, const unsigned& count)
+    {
+        packUnorm16((const float*)in, out, count * 4);
+    }
+
+    void packed::unpackUnorm16(const uint16_t* in, vec2* out, const unsigned& count)
+    {
+        unpackUnorm16(in, (float*)out, count * 2);
+    }
+
+    void packed::unpackUnorm16(const uint16_t* in, vec3* out, const unsigned& count)
+    {
+        unpackUnorm16(in, (float*)out, count * 3);
+    }
+
+    void packed::unpackUnorm16(const uint16_t* in, vec4* out, const unsigned& count)
+    {
+        unpackUnorm16(in, (float*)out, count * 4);
+    }
+}
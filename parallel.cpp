@@ -0,0 +1,195 @@
+#include "m3d/parallel.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned MAX_THREADS = 64;
+
+        // threadCount() - 1 workers started on the first parallel call and kept until exit. one parallelFor owns
+        // the pool at a time, nested or concurrent calls run inline instead of waiting for it
+        class pool
+        {
+        public:
+            pool() : m_busy(false), m_fn(nullptr), m_ranges(0), m_size(0), m_remainder(0), m_next(0), m_failed(false),
+                m_pending(0), m_active(0), m_generation(0), m_stop(false)
+            {
+                for(unsigned n = 1; n < threadCount(); n++)
+                    m_threads.push_back(std::thread(&pool::worker, this));
+            }
+
+            ~pool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for(std::thread& t : m_threads)
+                    t.join();
+            }
+
+            bool run(const rangeFunction& fn, const unsigned& count, const unsigned& ranges)
+            {
+                bool expected = false;
+                if(!m_busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return false;
+
+                {
+                    // a worker that woke late for the last job may still be about to take an index from m_next
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_done.wait(lock, [this]{ return m_active == 0; });
+
+                    m_fn = &fn;
+                    m_ranges = ranges;
+                    m_size = count / ranges;
+                    m_remainder = count % ranges;
+                    m_next.store(0, std::memory_order_relaxed);
+                    m_failed.store(false, std::memory_order_relaxed);
+                    m_error = nullptr;
+                    m_pending = ranges;
+                    m_generation++;
+                }
+                m_wake.notify_all();
+
+                execute();
+
+                std::exception_ptr error;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_done.wait(lock, [this]{ return m_pending == 0; });
+                    error = m_error;
+                    m_error = nullptr;
+                }
+
+                // no range is running anymore, fn can go out of scope with the exception
+                m_busy.store(false, std::memory_order_release);
+                if(error)
+                    std::rethrow_exception(error);
+                return true;
+            }
+
+        private:
+            std::vector<std::thread> m_threads;
+            std::atomic<bool> m_busy;
+
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+
+            // the current job, written under m_mutex while no worker is active
+            const rangeFunction* m_fn;
+            unsigned m_ranges;
+            unsigned m_size;
+            unsigned m_remainder;
+            std::atomic<unsigned> m_next;
+            // set by the first range that throws, the ranges taken after it are skipped
+            std::atomic<bool> m_failed;
+            std::exception_ptr m_error;
+
+            unsigned m_pending;
+            unsigned m_active;
+            uint64_t m_generation;
+            bool m_stop;
+
+            // takes ranges until there are none left, the same split as running them in order. an exception is kept
+            // for run() to rethrow, skipped ranges still count as finished so the wait in run() always ends
+            void execute()
+            {
+                unsigned finished = 0;
+                std::exception_ptr error;
+                for(;;)
+                {
+                    unsigned range = m_next.fetch_add(1, std::memory_order_relaxed);
+                    if(range >= m_ranges)
+                        break;
+
+                    finished++;
+                    if(m_failed.load(std::memory_order_relaxed))
+                        continue;
+
+                    unsigned begin = range * m_size + std::min(range, m_remainder);
+                    unsigned end = begin + m_size + (range < m_remainder ? 1 : 0);
+                    try
+                    {
+                        (*m_fn)(begin, end);
+                    }
+                    catch(...)
+                    {
+                        error = std::current_exception();
+                        m_failed.store(true, std::memory_order_relaxed);
+                    }
+                }
+
+                if(finished > 0)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if(error && !m_error)
+                        m_error = error;
+                    m_pending -= finished;
+                    if(m_pending == 0)
+                        m_done.notify_all();
+                }
+            }
+
+            void worker()
+            {
+                uint64_t seen = 0;
+                for(;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_wake.wait(lock, [this, seen]{ return m_stop || m_generation != seen; });
+                        if(m_stop)
+                            return;
+
+                        seen = m_generation;
+                        if(m_pending == 0)
+                            continue;
+                        m_active++;
+                    }
+
+                    execute();
+
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        if(--m_active == 0)
+                            m_done.notify_all();
+                    }
+                }
+            }
+        };
+    }
+
+    unsigned threadCount()
+    {
+        static const unsigned res = std::min(std::max(std::thread::hardware_concurrency(), 1u), MAX_THREADS);
+        return res;
+    }
+
+    void parallelFor(const unsigned& count, const unsigned& grain, const rangeFunction& fn)
+    {
+        unsigned minRange = std::max(grain, 1u);
+        unsigned ranges = std::min(threadCount(), (count + minRange - 1) / minRange);
+
+        if(ranges <= 1)
+        {
+            if(count > 0)
+                fn(0, count);
+            return;
+        }
+
+        static pool workers;
+        if(!workers.run(fn, count, ranges))
+            fn(0, count);
+    }
+}
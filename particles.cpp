@@ -0,0 +1,266 @@
+#include "m3d/particles.h"
+#include "m3d/vec3.h"
+#include "m3d/vec4.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+namespace m3d
+{
+    namespace
+    {
+        // particles per parallel range and per compaction chunk
+        const unsigned CHUNK = 16384;
+
+        inline void step(particles& p, const unsigned& n, const float& dt, const float& damping, const particleForces& f)
+        {
+            float vx = (p.vx[n] + f.gravity[0] * dt) * damping;
+            float vy = (p.vy[n] + f.gravity[1] * dt) * damping;
+            float vz = (p.vz[n] + f.gravity[2] * dt) * damping;
+            float x = p.x[n] + vx * dt;
+            float y = p.y[n] + vy * dt;
+            float z = p.z[n] + vz * dt;
+
+            // push back onto the plane and reflect the velocity going into it
+            for(unsigned i = 0; i < f.planeCount; i++)
+            {
+                const vec4& plane = f.planes[i];
+                float d = plane.x * x + plane.y * y + plane.z * z + plane.w;
+                if(d < 0.0f)
+                {
+                    x -= plane.x * d;
+                    y -= plane.y * d;
+                    z -= plane.z * d;
+
+                    float vn = plane.x * vx + plane.y * vy + plane.z * vz;
+                    if(vn < 0.0f)
+                    {
+                        float bounce = (1.0f + f.restitution) * vn;
+                        vx -= plane.x * bounce;
+                        vy -= plane.y * bounce;
+                        vz -= plane.z * bounce;
+                    }
+                }
+            }
+
+            p.x[n] = x; p.y[n] = y; p.z[n] = z;
+            p.vx[n] = vx; p.vy[n] = vy; p.vz[n] = vz;
+            p.life[n] -= dt;
+        }
+
+#ifdef __SSE__
+        inline __m128 load(const std::vector<float>& v, const unsigned& n) { return _mm_loadu_ps(v.data() + n); }
+        inline void store(std::vector<float>& v, const unsigned& n, const __m128& x) { _mm_storeu_ps(v.data() + n, x); }
+
+        // step for particles n to n + 3, the plane tests become masks
+        inline void step4(particles& p, const unsigned& n, const __m128& dt, const __m128& damping, const __m128 g[3], const particleForces& f)
+        {
+            __m128 vx = _mm_mul_ps(_mm_add_ps(load(p.vx, n), _mm_mul_ps(g[0], dt)), damping);
+            __m128 vy = _mm_mul_ps(_mm_add_ps(load(p.vy, n), _mm_mul_ps(g[1], dt)), damping);
+            __m128 vz = _mm_mul_ps(_mm_add_ps(load(p.vz, n), _mm_mul_ps(g[2], dt)), damping);
+            __m128 x = _mm_add_ps(load(p.x, n), _mm_mul_ps(vx, dt));
+            __m128 y = _mm_add_ps(load(p.y, n), _mm_mul_ps(vy, dt));
+            __m128 z = _mm_add_ps(load(p.z, n), _mm_mul_ps(vz, dt));
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 bounceScale = _mm_set1_ps(1.0f + f.restitution);
+
+            for(unsigned i = 0; i < f.planeCount; i++)
+            {
+                __m128 nx = _mm_set1_ps(f.planes[i].x);
+                __m128 ny = _mm_set1_ps(f.planes[i].y);
+                __m128 nz = _mm_set1_ps(f.planes[i].z);
+
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), _mm_set1_ps(f.planes[i].w)));
+                __m128 inside = _mm_cmplt_ps(d, zero);
+                if(_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                // min(d, 0) is the push for every lane, 0 for the ones on the open side
+                __m128 push = _mm_min_ps(d, zero);
+                x = _mm_sub_ps(x, _mm_mul_ps(nx, push));
+                y = _mm_sub_ps(y, _mm_mul_ps(ny, push));
+                z = _mm_sub_ps(z, _mm_mul_ps(nz, push));
+
+                __m128 vn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+                __m128 bounce = _mm_and_ps(inside, _mm_mul_ps(_mm_min_ps(vn, zero), bounceScale));
+                vx = _mm_sub_ps(vx, _mm_mul_ps(nx, bounce));
+                vy = _mm_sub_ps(vy, _mm_mul_ps(ny, bounce));
+                vz = _mm_sub_ps(vz, _mm_mul_ps(nz, bounce));
+            }
+
+            store(p.x, n, x); store(p.y, n, y); store(p.z, n, z);
+            store(p.vx, n, vx); store(p.vy, n, vy); store(p.vz, n, vz);
+            store(p.life, n, _mm_sub_ps(load(p.life, n), dt));
+        }
+#endif // __SSE__
+
+        // indices of the living particles in [begin, end), branch free: every index is written
+        // and the next one overwrites it unless the particle lives
+        inline unsigned survivors(const float* life, const unsigned& begin, const unsigned& end, unsigned* index)
+        {
+            unsigned alive = 0;
+            for(unsigned n = begin; n < end; n++)
+            {
+                index[alive] = n;
+                alive += life[n] > 0.0f ? 1 : 0;
+            }
+
+            return alive;
+        }
+
+        // index is ascending and index[k] >= k, so src and dst may be the same stream
+        inline void gather(const float* src, float* dst, const unsigned* index, const unsigned& count)
+        {
+            for(unsigned k = 0; k < count; k++)
+            {
+                dst[k] = src[index[k]];
+            }
+        }
+    }
+
+    unsigned particles::add(const vec3& position, const vec3& velocity, const float& life)
+    {
+        unsigned n = count();
+        resize(n + 1);
+
+        x[n] = position.x; y[n] = position.y; z[n] = position.z;
+        vx[n] = velocity.x; vy[n] = velocity.y; vz[n] = velocity.z;
+        this->life[n] = life;
+
+        return n;
+    }
+
+    void particles::resize(const unsigned& count)
+    {
+        std::vector<float>* streams[] = { &x, &y, &z, &vx, &vy, &vz, &life };
+        for(std::vector<float>* v : streams)
+        {
+            v->resize(count, 0.0f);
+        }
+    }
+
+    void particles::clear()
+    {
+        resize(0);
+    }
+
+    unsigned particles::count() const
+    {
+        return (unsigned)x.size();
+    }
+
+    void particles::update(const float& dt, const particleForces& forces)
+    {
+        update(0, count(), dt, forces);
+    }
+
+    void particles::update(const unsigned& begin, const unsigned& end, const float& dt, const particleForces& forces)
+    {
+        M3D_PROFILE("particles::update");
+
+        float damping = std::max(0.0f, 1.0f - forces.drag * dt);
+        unsigned n = begin;
+
+#ifdef __SSE__
+        __m128 dt4 = _mm_set1_ps(dt);
+        __m128 damping4 = _mm_set1_ps(damping);
+        __m128 g[3] = { _mm_set1_ps(forces.gravity[0]), _mm_set1_ps(forces.gravity[1]), _mm_set1_ps(forces.gravity[2]) };
+
+        for(; n + 4 <= end; n += 4)
+        {
+            step4(*this, n, dt4, damping4, g, forces);
+        }
+#endif // __SSE__
+
+        for(; n < end; n++)
+        {
+            step(*this, n, dt, damping, forces);
+        }
+    }
+
+    void particles::updateParallel(const float& dt, const particleForces& forces)
+    {
+        parallelFor(count(), CHUNK, [&](unsigned begin, unsigned end)
+        {
+            update(begin, end, dt, forces);
+        });
+    }
+
+    unsigned particles::compact()
+    {
+        M3D_PROFILE("particles::compact");
+
+        unsigned size = count();
+        m_index.resize(size + 1);
+
+        unsigned alive = survivors(life.data(), 0, size, m_index.data());
+
+        std::vector<float>* streams[] = { &x, &y, &z, &vx, &vy, &vz, &life };
+        for(std::vector<float>* v : streams)
+        {
+            gather(v->data(), v->data(), m_index.data(), alive);
+        }
+
+        resize(alive);
+        return alive;
+    }
+
+    unsigned particles::compactParallel()
+    {
+        M3D_PROFILE("particles::compactParallel");
+
+        unsigned size = count();
+        unsigned chunks = (size + CHUNK - 1) / CHUNK;
+        if(chunks <= 1)
+            return compact();
+
+        // chunk c keeps its survivor indices at c * (CHUNK + 1), the extra slot takes the last unused write
+        m_index.resize((size_t)chunks * (CHUNK + 1));
+        m_offsets.assign(chunks + 1, 0);
+        unsigned* offsets = m_offsets.data();
+
+        parallelFor(chunks, 1, [&](unsigned begin, unsigned end)
+        {
+            for(unsigned c = begin; c < end; c++)
+            {
+                offsets[c + 1] = survivors(life.data(), c * CHUNK, std::min(size, (c + 1) * CHUNK), m_index.data() + (size_t)c * (CHUNK + 1));
+            }
+        });
+
+        for(unsigned c = 0; c < chunks; c++)
+        {
+            offsets[c + 1] += offsets[c];
+        }
+
+        unsigned alive = offsets[chunks];
+        std::vector<float>* src[] = { &x, &y, &z, &vx, &vy, &vz, &life };
+        std::vector<float>* dst[] = { &m_x, &m_y, &m_z, &m_vx, &m_vy, &m_vz, &m_life };
+        for(std::vector<float>* v : dst)
+        {
+            v->resize(alive);
+        }
+
+        parallelFor(chunks, 1, [&](unsigned begin, unsigned end)
+        {
+            for(unsigned c = begin; c < end; c++)
+            {
+                for(int i = 0; i < 7; i++)
+                {
+                    gather(src[i]->data(), dst[i]->data() + offsets[c], m_index.data() + (size_t)c * (CHUNK + 1), offsets[c + 1] - offsets[c]);
+                }
+            }
+        });
+
+        x.swap(m_x); y.swap(m_y); z.swap(m_z);
+        vx.swap(m_vx); vy.swap(m_vy); vz.swap(m_vz);
+        life.swap(m_life);
+
+        return alive;
+    }
+}
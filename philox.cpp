@@ -0,0 +1,334 @@
+#include "m3d/philox.h"
+#include "m3d/vec2.h"
+#include "m3d/vec3.h"
+#include "m3d/quat.h"
+#include "m3d/math1D.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <math.h>
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 4096;
+        const unsigned ROUNDS = 10;
+
+        //https://www.thesalmons.org/john/random123/papers/random123sc11.pdf, table 2
+        const uint32_t MULTIPLIER0 = 0xD2511F53u;
+        const uint32_t MULTIPLIER1 = 0xCD9E8D57u;
+        const uint32_t WEYL0 = 0x9E3779B9u;
+        const uint32_t WEYL1 = 0xBB67AE85u;
+
+        const float TO_UNIT = 1.0f / 16777216.0f;
+        const float TWO_PI = 6.28318531f;
+
+        inline void philoxRounds(uint32_t* c, uint32_t k0, uint32_t k1)
+        {
+            for(unsigned round = 0; round < ROUNDS; round++)
+            {
+                uint64_t p0 = (uint64_t)MULTIPLIER0 * c[0];
+                uint64_t p1 = (uint64_t)MULTIPLIER1 * c[2];
+
+                uint32_t c1 = c[1], c3 = c[3];
+                c[0] = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+                c[1] = (uint32_t)p1;
+                c[2] = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+                c[3] = (uint32_t)p0;
+
+                k0 += WEYL0;
+                k1 += WEYL1;
+            }
+        }
+
+        // the top 24 bits, every value is exact and 1 is never reached
+        inline float unit(const uint32_t& v)
+        {
+            return (float)(v >> 8) * TO_UNIT;
+        }
+
+        // u are the uniform values of one counter, res the components of one element
+        inline void sample(const philox::distribution& kind, const float* u, float* res)
+        {
+            float s, c;
+            switch(kind)
+            {
+            case philox::UNIFORM:
+                res[0] = u[0];
+                break;
+            case philox::UNIT_VECTOR:
+            case philox::HEMISPHERE:
+            {
+                float z = kind == philox::UNIT_VECTOR ? 1.0f - 2.0f * u[0] : 1.0f - u[0];
+                float r = sqrtf(fmaxf(1.0f - z * z, 0.0f));
+                fastSincos(TWO_PI * u[1], s, c);
+                res[0] = r * c;
+                res[1] = r * s;
+                res[2] = z;
+                break;
+            }
+            case philox::COSINE_HEMISPHERE:
+            case philox::DISC:
+            {
+                // malley's method, the disc point lifted onto the hemisphere
+                float r = sqrtf(u[0]);
+                fastSincos(TWO_PI * u[1], s, c);
+                res[0] = r * c;
+                res[1] = r * s;
+                res[2] = sqrtf(fmaxf(1.0f - u[0], 0.0f));
+                break;
+            }
+            case philox::ROTATION:
+            {
+                //http://planning.cs.uiuc.edu/node198.html
+                float a = sqrtf(1.0f - u[0]), b = sqrtf(u[0]);
+                fastSincos(TWO_PI * u[1], s, c);
+                res[0] = a * s;
+                res[1] = a * c;
+                fastSincos(TWO_PI * u[2], s, c);
+                res[2] = b * s;
+                res[3] = b * c;
+                break;
+            }
+            }
+        }
+
+        inline unsigned components(const philox::distribution& kind)
+        {
+            switch(kind)
+            {
+            case philox::UNIFORM:
+                return 1;
+            case philox::DISC:
+                return 2;
+            case philox::ROTATION:
+                return 4;
+            default:
+                return 3;
+            }
+        }
+
+#ifdef __SSE2__
+        // high and low halves of four 32 x 32 bit products, even and odd lanes go through the 64 bit multiply
+        inline void mulhilo4(const __m128i& a, const __m128i& m, __m128i& hi, __m128i& lo)
+        {
+            __m128i even = _mm_mul_epu32(a, m);
+            __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), m);
+            lo = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+            hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+        }
+
+        // philoxRounds on four counters, word w of every counter in c[w]
+        inline void philoxRounds4(__m128i* c, uint32_t k0, uint32_t k1)
+        {
+            const __m128i m0 = _mm_set1_epi32((int)MULTIPLIER0);
+            const __m128i m1 = _mm_set1_epi32((int)MULTIPLIER1);
+
+            for(unsigned round = 0; round < ROUNDS; round++)
+            {
+                __m128i hi0, lo0, hi1, lo1;
+                mulhilo4(c[0], m0, hi0, lo0);
+                mulhilo4(c[2], m1, hi1, lo1);
+
+                c[0] = _mm_xor_si128(_mm_xor_si128(hi1, c[1]), _mm_set1_epi32((int)k0));
+                c[1] = lo1;
+                c[2] = _mm_xor_si128(_mm_xor_si128(hi0, c[3]), _mm_set1_epi32((int)k1));
+                c[3] = lo0;
+
+                k0 += WEYL0;
+                k1 += WEYL1;
+            }
+        }
+
+        inline __m128 unit4(const __m128i& v)
+        {
+            return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(v, 8)), _mm_set1_ps(TO_UNIT));
+        }
+
+        // sample, same steps lane for lane
+        inline void sample4(const philox::distribution& kind, const __m128* u, __m128* res)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 twoPi = _mm_set1_ps(TWO_PI);
+            __m128 s, c;
+
+            switch(kind)
+            {
+            case philox::UNIFORM:
+                res[0] = u[0];
+                break;
+            case philox::UNIT_VECTOR:
+            case philox::HEMISPHERE:
+            {
+                __m128 z = kind == philox::UNIT_VECTOR ? _mm_sub_ps(one, _mm_mul_ps(_mm_set1_ps(2.0f), u[0])) : _mm_sub_ps(one, u[0]);
+                __m128 r = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(z, z)), zero));
+                fastSincos4(_mm_mul_ps(twoPi, u[1]), s, c);
+                res[0] = _mm_mul_ps(r, c);
+                res[1] = _mm_mul_ps(r, s);
+                res[2] = z;
+                break;
+            }
+            case philox::COSINE_HEMISPHERE:
+            case philox::DISC:
+            {
+                __m128 r = _mm_sqrt_ps(u[0]);
+                fastSincos4(_mm_mul_ps(twoPi, u[1]), s, c);
+                res[0] = _mm_mul_ps(r, c);
+                res[1] = _mm_mul_ps(r, s);
+                res[2] = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, u[0]), zero));
+                break;
+            }
+            case philox::ROTATION:
+            {
+                __m128 a = _mm_sqrt_ps(_mm_sub_ps(one, u[0])), b = _mm_sqrt_ps(u[0]);
+                fastSincos4(_mm_mul_ps(twoPi, u[1]), s, c);
+                res[0] = _mm_mul_ps(a, s);
+                res[1] = _mm_mul_ps(a, c);
+                fastSincos4(_mm_mul_ps(twoPi, u[2]), s, c);
+                res[2] = _mm_mul_ps(b, s);
+                res[3] = _mm_mul_ps(b, c);
+                break;
+            }
+            }
+        }
+#endif // __SSE2__
+    }
+
+    philox::philox(const uint64_t& seed, const uint32_t& stream) : m_stream(stream)
+    {
+        m_key[0] = (uint32_t)seed;
+        m_key[1] = (uint32_t)(seed >> 32);
+    }
+
+    void philox::words(const uint64_t& counter, uint32_t* res) const
+    {
+        res[0] = (uint32_t)counter;
+        res[1] = (uint32_t)(counter >> 32);
+        res[2] = m_stream;
+        res[3] = 0;
+        philoxRounds(res, m_key[0], m_key[1]);
+    }
+
+    float philox::uniform(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+        return unit(w[0]);
+    }
+
+    vec3 philox::unitVector(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+
+        float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+        vec3 res;
+        sample(UNIT_VECTOR, u, &res.x);
+        return res;
+    }
+
+    vec3 philox::hemisphere(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+
+        float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+        vec3 res;
+        sample(HEMISPHERE, u, &res.x);
+        return res;
+    }
+
+    vec3 philox::cosineHemisphere(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+
+        float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+        vec3 res;
+        sample(COSINE_HEMISPHERE, u, &res.x);
+        return res;
+    }
+
+    vec2 philox::disc(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+
+        float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+        float res[3];
+        sample(DISC, u, res);
+        return vec2(res[0], res[1]);
+    }
+
+    quat philox::rotation(const uint64_t& counter) const
+    {
+        uint32_t w[4];
+        words(counter, w);
+
+        float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+        float res[4];
+        sample(ROTATION, u, res);
+        return quat(res[0], res[1], res[2], res[3]);
+    }
+
+    void philox::generate(const distribution& kind, const randomStreams& res, const unsigned& count, const uint64_t& first) const
+    {
+        M3D_PROFILE("philox::generate");
+
+        float* out[4] = { res.x, res.y, res.z, res.w };
+        const unsigned written = components(kind);
+        unsigned n = 0;
+
+#ifdef __SSE2__
+        for(; n + 4 <= count; n += 4)
+        {
+            // the counters of the four lanes, with the carry into the high word
+            uint64_t c[4] = { first + n, first + n + 1, first + n + 2, first + n + 3 };
+            __m128i w[4];
+            w[0] = _mm_set_epi32((int)(uint32_t)c[3], (int)(uint32_t)c[2], (int)(uint32_t)c[1], (int)(uint32_t)c[0]);
+            w[1] = _mm_set_epi32((int)(uint32_t)(c[3] >> 32), (int)(uint32_t)(c[2] >> 32), (int)(uint32_t)(c[1] >> 32), (int)(uint32_t)(c[0] >> 32));
+            w[2] = _mm_set1_epi32((int)m_stream);
+            w[3] = _mm_setzero_si128();
+            philoxRounds4(w, m_key[0], m_key[1]);
+
+            __m128 u[4] = { unit4(w[0]), unit4(w[1]), unit4(w[2]), unit4(w[3]) };
+            __m128 v[4];
+            sample4(kind, u, v);
+            for(unsigned k = 0; k < written; k++)
+            {
+                if(out[k])
+                    _mm_storeu_ps(out[k] + n, v[k]);
+            }
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            uint32_t w[4];
+            words(first + n, w);
+
+            float u[4] = { unit(w[0]), unit(w[1]), unit(w[2]), unit(w[3]) };
+            float v[4];
+            sample(kind, u, v);
+            for(unsigned k = 0; k < written; k++)
+            {
+                if(out[k])
+                    out[k][n] = v[k];
+            }
+        }
+    }
+
+    void philox::generateParallel(const distribution& kind, const randomStreams& res, const unsigned& count, const uint64_t& first) const
+    {
+        M3D_PROFILE("philox::generateParallel");
+
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            randomStreams range = { res.x ? res.x + begin : nullptr, res.y ? res.y + begin : nullptr,
+                                    res.z ? res.z + begin : nullptr, res.w ? res.w + begin : nullptr };
+            generate(kind, range, end - begin, first + begin);
+        });
+    }
+}
@@ -0,0 +1,572 @@
+#include "m3d/pointCloud.h"
+#include "m3d/vec3.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <algorithm>
+
+namespace m3d
+{
+    namespace
+    {
+        const uint32_t MAGIC = 0x50443d4d; // "M3DP"
+        const uint32_t VERSION = 1;
+        const uint32_t FLAG_NORMALS = 1;
+        // values per line the importer parses, ply headers with more properties are rejected
+        const unsigned MAX_VALUES = 32;
+        // points per chunk, both read ahead slots of a file with normals then take 96mb each
+        const unsigned MAX_CHUNK_SIZE = 1u << 22;
+
+        struct fileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t flags;
+            uint32_t chunkSize;
+            uint64_t pointCount;
+        };
+
+        static_assert(sizeof(fileHeader) == 24, "point cloud header layout");
+
+        // the leading numbers of an ascii line, comment lines parse as none
+        unsigned parseValues(const char* line, float* values)
+        {
+            if(line[0] == '#')
+                return 0;
+
+            unsigned parsed = 0;
+            const char* cursor = line;
+            while(parsed < MAX_VALUES)
+            {
+                char* end;
+                values[parsed] = strtof(cursor, &end);
+                if(end == cursor) break;
+                cursor = end;
+                parsed++;
+            }
+            return parsed;
+        }
+    }
+
+    ///////////////////////////////////////
+    //              STREAM               //
+    ///////////////////////////////////////
+
+    pointStream::pointStream() : m_current(0), m_consuming(false), m_stop(false), m_chunkSize(0), m_normals(false), m_failed(false) {};
+
+    pointStream::~pointStream()
+    {
+        // derived streams close themselves, this only catches a thread that is still running
+        if(m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cond.notify_all();
+            m_thread.join();
+        }
+    }
+
+    const pointChunk* pointStream::next()
+    {
+        if(m_chunkSize == 0)
+            return nullptr;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        // hand the previous chunk back to the read ahead thread
+        if(m_consuming)
+        {
+            m_slots[m_current].ready = false;
+            m_current ^= 1;
+            m_consuming = false;
+            m_cond.notify_all();
+        }
+
+        m_cond.wait(lock, [this]{ return m_slots[m_current].ready; });
+
+        if(m_slots[m_current].chunk.count == 0)
+            return nullptr;
+
+        m_consuming = true;
+        return &m_slots[m_current].chunk;
+    }
+
+    void pointStream::close()
+    {
+        if(m_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cond.notify_all();
+            m_thread.join();
+        }
+
+        if(m_chunkSize != 0)
+            closeSource();
+
+        for(slot& s : m_slots)
+            std::vector<float>().swap(s.storage);
+
+        m_chunkSize = 0;
+        m_normals = false;
+    }
+
+    unsigned pointStream::chunkSize() const
+    {
+        return m_chunkSize;
+    }
+
+    bool pointStream::hasNormals() const
+    {
+        return m_normals;
+    }
+
+    bool pointStream::failed() const
+    {
+        return m_failed.load();
+    }
+
+    void pointStream::fail()
+    {
+        m_failed.store(true);
+    }
+
+    void pointStream::start(const unsigned& chunkSize, const bool& normals)
+    {
+        m_chunkSize = chunkSize;
+        m_normals = normals;
+        m_current = 0;
+        m_consuming = false;
+        m_stop = false;
+        m_failed.store(false);
+
+        for(slot& s : m_slots)
+        {
+            s.storage.assign((size_t)chunkSize * (normals ? 6 : 3), 0.0f);
+            float* data = s.storage.data();
+
+            s.chunk.count = 0;
+            s.chunk.x = data;
+            s.chunk.y = data + chunkSize;
+            s.chunk.z = data + chunkSize * 2;
+            s.chunk.nx = normals ? data + chunkSize * 3 : nullptr;
+            s.chunk.ny = normals ? data + chunkSize * 4 : nullptr;
+            s.chunk.nz = normals ? data + chunkSize * 5 : nullptr;
+            s.ready = false;
+        }
+
+        m_thread = std::thread(&pointStream::readAhead, this);
+    }
+
+    void pointStream::readAhead()
+    {
+        unsigned s = 0;
+
+        for(;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cond.wait(lock, [this, s]{ return m_stop || !m_slots[s].ready; });
+                if(m_stop)
+                    return;
+            }
+
+            // the slot belongs to this thread until it is marked ready
+            unsigned count = fill(m_slots[s].chunk);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_slots[s].chunk.count = count;
+                m_slots[s].ready = true;
+            }
+            m_cond.notify_all();
+
+            if(count == 0)
+                return;
+
+            s ^= 1;
+        }
+    }
+
+    ///////////////////////////////////////
+    //              READER               //
+    ///////////////////////////////////////
+
+    pointCloudReader::pointCloudReader() : m_file(nullptr), m_pointCount(0), m_read(0) {};
+
+    pointCloudReader::~pointCloudReader()
+    {
+        close();
+    }
+
+    bool pointCloudReader::open(const char* path)
+    {
+        close();
+
+        m_file = fopen(path, "rb");
+        if(m_file == nullptr)
+            return false;
+
+        fileHeader header;
+        if(fread(&header, sizeof(header), 1, m_file) != 1 || header.magic != MAGIC ||
+           header.version != VERSION || header.chunkSize == 0 || header.chunkSize > MAX_CHUNK_SIZE)
+        {
+            fclose(m_file);
+            m_file = nullptr;
+            return false;
+        }
+
+        // no chunk holds more than the whole file, small files don't get buffers sized for the writer's chunks
+        m_pointCount = header.pointCount;
+        m_read = 0;
+        start((unsigned)std::min<uint64_t>(header.chunkSize, std::max<uint64_t>(header.pointCount, 1)), (header.flags & FLAG_NORMALS) != 0);
+        return true;
+    }
+
+    uint64_t pointCloudReader::pointCount() const
+    {
+        return m_pointCount;
+    }
+
+    unsigned pointCloudReader::fill(pointChunk& chunk)
+    {
+        // the writer never writes empty chunks, the stream only ends cleanly after every point of the header
+        uint32_t count;
+        if(fread(&count, sizeof(count), 1, m_file) != 1)
+        {
+            if(m_read != m_pointCount || ferror(m_file))
+                fail();
+            return 0;
+        }
+        if(count == 0 || count > chunkSize() || count > m_pointCount - m_read)
+        {
+            fail();
+            return 0;
+        }
+
+        float* streams[6] = { chunk.x, chunk.y, chunk.z, chunk.nx, chunk.ny, chunk.nz };
+        unsigned streamCount = hasNormals() ? 6 : 3;
+        for(unsigned n = 0; n < streamCount; n++)
+        {
+            if(fread(streams[n], sizeof(float), count, m_file) != count)
+            {
+                fail();
+                return 0;
+            }
+        }
+
+        m_read += count;
+        return count;
+    }
+
+    void pointCloudReader::closeSource()
+    {
+        if(m_file)
+            fclose(m_file);
+        m_file = nullptr;
+        m_pointCount = 0;
+        m_read = 0;
+    }
+
+    ///////////////////////////////////////
+    //              IMPORTER             //
+    ///////////////////////////////////////
+
+    pointCloudImporter::pointCloudImporter() : m_file(nullptr), m_remaining(0), m_columnCount(0), m_required(0) {};
+
+    pointCloudImporter::~pointCloudImporter()
+    {
+        close();
+    }
+
+    //http://paulbourke.net/dataformats/ply/
+    bool pointCloudImporter::open(const char* path, const unsigned& chunkSize)
+    {
+        close();
+
+        m_file = fopen(path, "rb");
+        if(m_file == nullptr || chunkSize == 0 || chunkSize > MAX_CHUNK_SIZE)
+        {
+            closeSource();
+            return false;
+        }
+
+        const char* names[6] = { "x", "y", "z", "nx", "ny", "nz" };
+        for(int& c : m_columns)
+            c = -1;
+
+        char line[1024];
+        if(fgets(line, sizeof(line), m_file) == nullptr)
+        {
+            closeSource();
+            return false;
+        }
+
+        if(strncmp(line, "ply", 3) == 0)
+        {
+            bool ascii = false;
+            bool inVertex = false;
+            bool foundVertex = false;
+            uint64_t skipLines = 0;
+            unsigned property = 0;
+
+            while(fgets(line, sizeof(line), m_file))
+            {
+                char word[64], arg0[64], arg1[64];
+                int args = sscanf(line, "%63s %63s %63s", word, arg0, arg1);
+                if(args < 1)
+                    continue;
+
+                if(strcmp(word, "end_header") == 0)
+                    break;
+                else if(strcmp(word, "format") == 0)
+                    ascii = args >= 2 && strcmp(arg0, "ascii") == 0;
+                else if(strcmp(word, "element") == 0 && args >= 3)
+                {
+                    inVertex = strcmp(arg0, "vertex") == 0;
+                    uint64_t count = strtoull(arg1, nullptr, 10);
+
+                    if(inVertex)
+                    {
+                        foundVertex = true;
+                        m_remaining = count;
+                    }
+                    else if(!foundVertex)
+                        skipLines += count;
+                }
+                else if(strcmp(word, "property") == 0 && inVertex && args >= 3)
+                {
+                    // list properties can't be mapped to fixed columns
+                    if(strcmp(arg0, "list") == 0)
+                    {
+                        closeSource();
+                        return false;
+                    }
+
+                    for(unsigned n = 0; n < 6; n++)
+                    {
+                        if(strcmp(arg1, names[n]) == 0)
+                            m_columns[n] = property;
+                    }
+                    property++;
+                }
+            }
+
+            if(!ascii || !foundVertex || property > MAX_VALUES || m_columns[0] < 0 || m_columns[1] < 0 || m_columns[2] < 0)
+            {
+                closeSource();
+                return false;
+            }
+
+            // elements before the vertices are skipped here, the ones after are never read
+            for(uint64_t n = 0; n < skipLines; n++)
+            {
+                if(fgets(line, sizeof(line), m_file) == nullptr)
+                    break;
+            }
+
+            m_columnCount = property;
+        }
+        else
+        {
+            // xyz, the first line fill() would read a point from decides if there are normals
+            float values[MAX_VALUES];
+            unsigned parsed = parseValues(line, values);
+            while(parsed < 3 && fgets(line, sizeof(line), m_file))
+                parsed = parseValues(line, values);
+
+            rewind(m_file);
+            m_remaining = UINT64_MAX;
+            m_columnCount = parsed >= 6 ? 6 : 3;
+            for(unsigned n = 0; n < m_columnCount; n++)
+                m_columns[n] = n;
+        }
+
+        m_required = (unsigned)std::max(m_columns[0], std::max(m_columns[1], m_columns[2])) + 1;
+        start(chunkSize, m_columns[3] >= 0 && m_columns[4] >= 0 && m_columns[5] >= 0);
+        return true;
+    }
+
+    unsigned pointCloudImporter::fill(pointChunk& chunk)
+    {
+        float values[MAX_VALUES];
+        char line[1024];
+
+        unsigned count = 0;
+        while(count < chunkSize() && m_remaining > 0 && fgets(line, sizeof(line), m_file))
+        {
+            // comments and short lines are skipped, every column read below has been parsed
+            unsigned parsed = parseValues(line, values);
+            if(parsed < m_required)
+                continue;
+
+            chunk.x[count] = values[m_columns[0]];
+            chunk.y[count] = values[m_columns[1]];
+            chunk.z[count] = values[m_columns[2]];
+
+            if(chunk.nx)
+            {
+                bool has = (int)parsed > m_columns[3] && (int)parsed > m_columns[4] && (int)parsed > m_columns[5];
+                chunk.nx[count] = has ? values[m_columns[3]] : 0.0f;
+                chunk.ny[count] = has ? values[m_columns[4]] : 0.0f;
+                chunk.nz[count] = has ? values[m_columns[5]] : 0.0f;
+            }
+
+            count++;
+            m_remaining--;
+        }
+
+        // xyz files run to the end of the file, a ply file ending before its vertex count is truncated
+        if(count == 0 && (ferror(m_file) || (m_remaining > 0 && m_remaining != UINT64_MAX)))
+            fail();
+
+        return count;
+    }
+
+    void pointCloudImporter::closeSource()
+    {
+        if(m_file)
+            fclose(m_file);
+        m_file = nullptr;
+        m_remaining = 0;
+        m_columnCount = 0;
+        m_required = 0;
+    }
+
+    ///////////////////////////////////////
+    //              WRITER               //
+    ///////////////////////////////////////
+
+    pointCloudWriter::pointCloudWriter() : m_file(nullptr), m_chunkSize(0), m_normals(false), m_pointCount(0), m_buffered(0), m_failed(false) {};
+
+    pointCloudWriter::~pointCloudWriter()
+    {
+        close();
+    }
+
+    bool pointCloudWriter::open(const char* path, const unsigned& chunkSize, const bool& normals)
+    {
+        close();
+
+        if(chunkSize == 0 || chunkSize > MAX_CHUNK_SIZE)
+            return false;
+
+        m_file = fopen(path, "wb");
+        if(m_file == nullptr)
+            return false;
+
+        m_chunkSize = chunkSize;
+        m_normals = normals;
+        m_pointCount = 0;
+        m_buffered = 0;
+        m_failed = false;
+        m_buffer.assign((size_t)chunkSize * (normals ? 6 : 3), 0.0f);
+
+        // the point count is patched in close
+        fileHeader header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.flags = normals ? FLAG_NORMALS : 0;
+        header.chunkSize = chunkSize;
+        header.pointCount = 0;
+        m_failed = fwrite(&header, sizeof(header), 1, m_file) != 1;
+
+        return !m_failed;
+    }
+
+    void pointCloudWriter::write(const vec3* points, const vec3* normals, const unsigned& count)
+    {
+        if(m_file == nullptr)
+            return;
+
+        float* data = m_buffer.data();
+        for(unsigned n = 0; n < count; n++)
+        {
+            data[m_buffered] = points[n].x;
+            data[m_chunkSize + m_buffered] = points[n].y;
+            data[m_chunkSize * 2 + m_buffered] = points[n].z;
+
+            if(m_normals)
+            {
+                vec3 normal = normals ? normals[n] : vec3(0.0f);
+                data[m_chunkSize * 3 + m_buffered] = normal.x;
+                data[m_chunkSize * 4 + m_buffered] = normal.y;
+                data[m_chunkSize * 5 + m_buffered] = normal.z;
+            }
+
+            if(++m_buffered == m_chunkSize)
+                flush();
+        }
+    }
+
+    void pointCloudWriter::write(const pointChunk& chunk)
+    {
+        if(m_file == nullptr)
+            return;
+
+        const float* streams[6] = { chunk.x, chunk.y, chunk.z, chunk.nx, chunk.ny, chunk.nz };
+        unsigned streamCount = m_normals ? 6 : 3;
+
+        unsigned done = 0;
+        while(done < chunk.count)
+        {
+            unsigned n = std::min(chunk.count - done, m_chunkSize - m_buffered);
+            for(unsigned s = 0; s < streamCount; s++)
+            {
+                float* dst = m_buffer.data() + (size_t)m_chunkSize * s + m_buffered;
+                if(streams[s])
+                    memcpy(dst, streams[s] + done, n * sizeof(float));
+                else
+                    memset(dst, 0, n * sizeof(float));
+            }
+
+            done += n;
+            m_buffered += n;
+            if(m_buffered == m_chunkSize)
+                flush();
+        }
+    }
+
+    bool pointCloudWriter::close()
+    {
+        if(m_file == nullptr)
+            return false;
+
+        if(m_buffered > 0)
+            flush();
+
+        if(fseek(m_file, offsetof(fileHeader, pointCount), SEEK_SET) != 0 ||
+           fwrite(&m_pointCount, sizeof(m_pointCount), 1, m_file) != 1)
+            m_failed = true;
+
+        if(fclose(m_file) != 0)
+            m_failed = true;
+
+        m_file = nullptr;
+        std::vector<float>().swap(m_buffer);
+        return !m_failed;
+    }
+
+    void pointCloudWriter::flush()
+    {
+        uint32_t count = m_buffered;
+        unsigned streamCount = m_normals ? 6 : 3;
+
+        if(fwrite(&count, sizeof(count), 1, m_file) != 1)
+            m_failed = true;
+
+        for(unsigned s = 0; s < streamCount; s++)
+        {
+            if(fwrite(m_buffer.data() + (size_t)m_chunkSize * s, sizeof(float), count, m_file) != count)
+                m_failed = true;
+        }
+
+        m_pointCount += count;
+        m_buffered = 0;
+    }
+}
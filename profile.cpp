@@ -0,0 +1,155 @@
+#include "m3d/profile.h"
+
+#ifdef M3D_INSTRUMENT
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace m3d
+{
+    namespace
+    {
+        std::mutex g_mutex;
+        const char* g_names[profile::MAX_COUNTERS];
+        std::atomic<unsigned> g_counterCount(0);
+
+        // blocks are never freed so the counts of finished threads still show up in the report
+        std::vector<profile::counter*>& blocks()
+        {
+            static std::vector<profile::counter*> res;
+            return res;
+        }
+
+        thread_local profile::counter* t_counters = nullptr;
+
+        profile::counter* createBlock()
+        {
+            profile::counter* res = new profile::counter[profile::MAX_COUNTERS];
+            for(unsigned n = 0; n < profile::MAX_COUNTERS; n++)
+            {
+                res[n].calls.store(0, std::memory_order_relaxed);
+                res[n].samples.store(0, std::memory_order_relaxed);
+                res[n].cycles.store(0, std::memory_order_relaxed);
+            }
+
+            std::lock_guard<std::mutex> lock(g_mutex);
+            blocks().push_back(res);
+            return res;
+        }
+    }
+
+    const unsigned profile::MAX_COUNTERS;
+
+    unsigned profile::registerCounter(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        unsigned count = g_counterCount.load(std::memory_order_relaxed);
+        for(unsigned n = 0; n < count; n++)
+        {
+            if(strcmp(g_names[n], name) == 0)
+                return n;
+        }
+
+        // past the limit every new name shares the last slot
+        if(count == MAX_COUNTERS)
+        {
+            g_names[MAX_COUNTERS - 1] = "(other)";
+            return MAX_COUNTERS - 1;
+        }
+
+        g_names[count] = name;
+        g_counterCount.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    profile::counter* profile::local()
+    {
+        if(t_counters == nullptr)
+            t_counters = createBlock();
+        return t_counters;
+    }
+
+    uint64_t profile::timestamp()
+    {
+#if defined(_MSC_VER) || defined(__i386__) || defined(__x86_64__)
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    unsigned profile::merge(totals* out)
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        unsigned count = g_counterCount.load(std::memory_order_acquire);
+        for(unsigned n = 0; n < count; n++)
+        {
+            out[n].name = g_names[n];
+            out[n].calls = 0;
+            out[n].samples = 0;
+            out[n].cycles = 0;
+
+            for(counter* block : blocks())
+            {
+                out[n].calls += block[n].calls.load(std::memory_order_relaxed);
+                out[n].samples += block[n].samples.load(std::memory_order_relaxed);
+                out[n].cycles += block[n].cycles.load(std::memory_order_relaxed);
+            }
+        }
+
+        return count;
+    }
+
+    void profile::report(FILE* file)
+    {
+        totals counters[MAX_COUNTERS];
+        unsigned count = merge(counters);
+
+        std::sort(counters, counters + count, [](const totals& a, const totals& b) { return a.calls > b.calls; });
+
+        uint64_t allCalls = 0;
+        for(unsigned n = 0; n < count; n++)
+            allCalls += counters[n].calls;
+
+        fprintf(file, "%-32s %14s %8s %14s %18s\n", "function", "calls", "share", "cycles/call", "cycles (est.)");
+        for(unsigned n = 0; n < count; n++)
+        {
+            const totals& t = counters[n];
+            if(t.calls == 0)
+                continue;
+
+            double share = allCalls ? 100.0 * (double)t.calls / (double)allCalls : 0.0;
+            double perCall = t.samples ? (double)t.cycles / (double)t.samples : 0.0;
+            fprintf(file, "%-32s %14llu %7.2f%% %14.1f %18.0f\n", t.name, (unsigned long long)t.calls, share, perCall, perCall * (double)t.calls);
+        }
+    }
+
+    void profile::reset()
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+
+        // racy against running threads by design, a count in flight may survive the reset
+        for(counter* block : blocks())
+        {
+            for(unsigned n = 0; n < MAX_COUNTERS; n++)
+            {
+                block[n].calls.store(0, std::memory_order_relaxed);
+                block[n].samples.store(0, std::memory_order_relaxed);
+                block[n].cycles.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+#endif // M3D_INSTRUMENT
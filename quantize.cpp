@@ -0,0 +1,585 @@
+#include "m3d/quantize.h"
+#include "m3d/vec3.h"
+#include "m3d/quat.h"
+#include "m3d/transform.h"
+
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+
+namespace m3d
+{
+    namespace
+    {
+        const float SQRT2 = 1.41421356f;
+        const float INV_SQRT2 = 0.70710678f;
+
+        inline uint32_t quantizeUnit(const float& v, const float& maxValue)
+        {
+            // [-1/sqrt(2), 1/sqrt(2)] -> [0, maxValue]
+            float t = (v * SQRT2 * 0.5f + 0.5f) * maxValue + 0.5f;
+            t = fminf(fmaxf(t, 0.0f), maxValue);
+            return (uint32_t)t;
+        }
+
+        inline float dequantizeUnit(const uint32_t& v, const float& invMaxValue)
+        {
+            return ((float)v * invMaxValue * 2.0f - 1.0f) * INV_SQRT2;
+        }
+
+        inline uint64_t packSmallestThree(const quat& q, const unsigned& bits)
+        {
+            float c[4] = { q.i, q.j, q.k, q.w };
+
+            unsigned largest = 0;
+            float largestAbs = fabsf(c[0]);
+            for(unsigned n = 1; n < 4; n++)
+            {
+                float a = fabsf(c[n]);
+                if(a > largestAbs)
+                {
+                    largestAbs = a;
+                    largest = n;
+                }
+            }
+
+            // q and -q are the same rotation, make the dropped component positive
+            float s = c[largest] < 0.0f ? -1.0f : 1.0f;
+            float maxValue = (float)((1u << bits) - 1);
+
+            uint64_t res = largest;
+            for(unsigned n = 0; n < 4; n++)
+            {
+                if(n == largest) continue;
+                res = (res << bits) | quantizeUnit(c[n] * s, maxValue);
+            }
+
+            return res;
+        }
+
+        inline quat unpackSmallestThree(const uint64_t& v, const unsigned& bits)
+        {
+            uint64_t mask = (1u << bits) - 1;
+            float invMaxValue = 1.0f / (float)mask;
+            unsigned largest = (unsigned)(v >> (bits * 3)) & 3;
+
+            float c[4];
+            float sum = 0.0f;
+            unsigned shift = bits * 3;
+            for(unsigned n = 0; n < 4; n++)
+            {
+                if(n == largest) continue;
+                shift -= bits;
+                c[n] = dequantizeUnit((uint32_t)((v >> shift) & mask), invMaxValue);
+                sum += c[n] * c[n];
+            }
+            c[largest] = sqrtf(fmaxf(1.0f - sum, 0.0f));
+
+            return quat(c[0], c[1], c[2], c[3]);
+        }
+
+        inline uint32_t quantizeRange(const float& v, const float& min, const float& scale, const float& maxValue)
+        {
+            float t = (v - min) * scale + 0.5f;
+            t = fminf(fmaxf(t, 0.0f), maxValue);
+            return (uint32_t)t;
+        }
+
+        // the position strides are sizeof(vec3) or sizeof(transform), the rotation stride sizeof(transform)
+        static_assert(sizeof(vec3) == 12 && sizeof(quat) == 16 && sizeof(transform) == 40, "batches read the in memory layout");
+
+#ifdef __SSE2__
+        // the scalar codecs four at a time with the same operations in the same order, so both give the same bits
+
+        inline __m128 select(const __m128& mask, const __m128& a, const __m128& b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        inline __m128i select(const __m128i& mask, const __m128i& a, const __m128i& b)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        // low 32 bits of the four 64 bit lanes of a and b
+        inline __m128i low32(const __m128i& a, const __m128i& b)
+        {
+            return _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+
+        inline __m128i quantize4(const __m128& t, const __m128& maxValue)
+        {
+            return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), maxValue));
+        }
+
+        // quantizeUnit on four lanes
+        inline __m128i quantizeUnit4(const __m128& v, const __m128& maxValue)
+        {
+            __m128 t = _mm_mul_ps(_mm_mul_ps(v, _mm_set1_ps(SQRT2)), _mm_set1_ps(0.5f));
+            t = _mm_add_ps(_mm_mul_ps(_mm_add_ps(t, _mm_set1_ps(0.5f)), maxValue), _mm_set1_ps(0.5f));
+            return quantize4(t, maxValue);
+        }
+
+        // packSmallestThree of four quaternions stride bytes apart, the index and the three kept components in the order they are packed
+        inline void packSmallestThree4(const quat* q, const size_t& stride, const unsigned& bits, __m128i& largest, __m128i& a, __m128i& b, __m128i& c)
+        {
+            const uint8_t* p = (const uint8_t*)q;
+            __m128 i = _mm_loadu_ps((const float*)p);
+            __m128 j = _mm_loadu_ps((const float*)(p + stride));
+            __m128 k = _mm_loadu_ps((const float*)(p + stride * 2));
+            __m128 w = _mm_loadu_ps((const float*)(p + stride * 3));
+            _MM_TRANSPOSE4_PS(i, j, k, w);
+
+            const __m128 sign = _mm_set1_ps(-0.0f);
+            __m128 ai = _mm_andnot_ps(sign, i), aj = _mm_andnot_ps(sign, j), ak = _mm_andnot_ps(sign, k), aw = _mm_andnot_ps(sign, w);
+            __m128 m = _mm_max_ps(_mm_max_ps(ai, aj), _mm_max_ps(ak, aw));
+
+            // the first component reaching the maximum, like the strict compare of the scalar loop
+            __m128 isI = _mm_cmpeq_ps(ai, m);
+            __m128 isJ = _mm_andnot_ps(isI, _mm_cmpeq_ps(aj, m));
+            __m128 isK = _mm_andnot_ps(_mm_or_ps(isI, isJ), _mm_cmpeq_ps(ak, m));
+            __m128 upToJ = _mm_or_ps(isI, isJ);
+            __m128 upToK = _mm_or_ps(upToJ, isK);
+
+            // the masks are -1 where set, 3 minus the number of them set is the index
+            largest = _mm_add_epi32(_mm_set1_epi32(3), _mm_add_epi32(_mm_add_epi32(_mm_castps_si128(isI), _mm_castps_si128(upToJ)), _mm_castps_si128(upToK)));
+
+            // q and -q are the same rotation, make the dropped component positive
+            __m128 dropped = select(isI, i, select(isJ, j, select(isK, k, w)));
+            __m128 flip = _mm_and_ps(_mm_cmplt_ps(dropped, _mm_setzero_ps()), sign);
+
+            const __m128 maxValue = _mm_set1_ps((float)((1u << bits) - 1));
+            __m128i qi = quantizeUnit4(_mm_xor_ps(i, flip), maxValue);
+            __m128i qj = quantizeUnit4(_mm_xor_ps(j, flip), maxValue);
+            __m128i qk = quantizeUnit4(_mm_xor_ps(k, flip), maxValue);
+            __m128i qw = quantizeUnit4(_mm_xor_ps(w, flip), maxValue);
+
+            a = select(_mm_castps_si128(isI), qj, qi);
+            b = select(_mm_castps_si128(upToJ), qk, qj);
+            c = select(_mm_castps_si128(upToK), qw, qk);
+        }
+
+        // unpackSmallestThree of four quaternions stride bytes apart from the index and the three stored components
+        inline void unpackSmallestThree4(const __m128i& largest, const __m128i& a, const __m128i& b, const __m128i& c, const unsigned& bits,
+                                         quat* q, const size_t& stride)
+        {
+            const __m128 invMaxValue = _mm_set1_ps(1.0f / (float)((1u << bits) - 1));
+            const __m128 two = _mm_set1_ps(2.0f);
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 invSqrt2 = _mm_set1_ps(INV_SQRT2);
+
+            __m128 fa = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(a), invMaxValue), two), one), invSqrt2);
+            __m128 fb = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(b), invMaxValue), two), one), invSqrt2);
+            __m128 fc = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), invMaxValue), two), one), invSqrt2);
+
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fa, fa), _mm_mul_ps(fb, fb)), _mm_mul_ps(fc, fc));
+            __m128 big = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(one, sum), _mm_setzero_ps()));
+
+            __m128 isI = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_setzero_si128()));
+            __m128 isJ = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(1)));
+            __m128 isK = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(2)));
+            __m128 isW = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+
+            __m128 i = select(isI, big, fa);
+            __m128 j = select(isI, fa, select(isJ, big, fb));
+            __m128 k = select(isK, big, select(isW, fc, fb));
+            __m128 w = select(isW, big, fc);
+            _MM_TRANSPOSE4_PS(i, j, k, w);
+
+            uint8_t* p = (uint8_t*)q;
+            _mm_storeu_ps((float*)p, i);
+            _mm_storeu_ps((float*)(p + stride), j);
+            _mm_storeu_ps((float*)(p + stride * 2), k);
+            _mm_storeu_ps((float*)(p + stride * 3), w);
+        }
+
+        // index << 3 bits | a << 2 bits | b << bits | c, for bits up to 10
+        inline __m128i combine32(const __m128i& largest, const __m128i& a, const __m128i& b, const __m128i& c, const unsigned& bits)
+        {
+            __m128i shift = _mm_cvtsi32_si128((int)bits);
+            __m128i res = _mm_or_si128(_mm_sll_epi32(largest, shift), a);
+            res = _mm_or_si128(_mm_sll_epi32(res, shift), b);
+            return _mm_or_si128(_mm_sll_epi32(res, shift), c);
+        }
+
+        inline void split32(const __m128i& v, const unsigned& bits, __m128i& largest, __m128i& a, __m128i& b, __m128i& c)
+        {
+            __m128i shift = _mm_cvtsi32_si128((int)bits);
+            __m128i mask = _mm_set1_epi32((int)((1u << bits) - 1));
+            c = _mm_and_si128(v, mask);
+            b = _mm_and_si128(_mm_srl_epi32(v, shift), mask);
+            a = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128((int)bits * 2)), mask);
+            largest = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128((int)bits * 3)), _mm_set1_epi32(3));
+        }
+
+        // x | y << bits | z << 2 bits of four lanes into two vectors of two 64 bit values
+        inline void combine64(const __m128i& x, const __m128i& y, const __m128i& z, const unsigned& bits, __m128i& lo, __m128i& hi)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i shift = _mm_cvtsi32_si128((int)bits);
+            __m128i shift2 = _mm_cvtsi32_si128((int)bits * 2);
+            lo = _mm_or_si128(_mm_or_si128(_mm_unpacklo_epi32(x, zero), _mm_sll_epi64(_mm_unpacklo_epi32(y, zero), shift)),
+                              _mm_sll_epi64(_mm_unpacklo_epi32(z, zero), shift2));
+            hi = _mm_or_si128(_mm_or_si128(_mm_unpackhi_epi32(x, zero), _mm_sll_epi64(_mm_unpackhi_epi32(y, zero), shift)),
+                              _mm_sll_epi64(_mm_unpackhi_epi32(z, zero), shift2));
+        }
+
+        // the three fields of four 64 bit values, for bits up to 21
+        inline void split64(const __m128i& lo, const __m128i& hi, const unsigned& bits, __m128i& x, __m128i& y, __m128i& z)
+        {
+            __m128i mask = _mm_set1_epi32((int)((1u << bits) - 1));
+            __m128i shift = _mm_cvtsi32_si128((int)bits);
+            __m128i shift2 = _mm_cvtsi32_si128((int)bits * 2);
+            x = _mm_and_si128(low32(lo, hi), mask);
+            y = _mm_and_si128(low32(_mm_srl_epi64(lo, shift), _mm_srl_epi64(hi, shift)), mask);
+            z = _mm_and_si128(low32(_mm_srl_epi64(lo, shift2), _mm_srl_epi64(hi, shift2)), mask);
+        }
+
+        // xyz of four points stride bytes apart. packed vec3 arrays are read as three vectors, larger strides
+        // read 16 bytes per point so the 4 bytes after every point have to be readable
+        inline void loadPoints4(const uint8_t* p, const size_t& stride, __m128& x, __m128& y, __m128& z)
+        {
+            __m128 p0, p1, p2, p3;
+            if(stride == sizeof(vec3))
+            {
+                __m128 r0 = _mm_loadu_ps((const float*)p);
+                __m128 r1 = _mm_loadu_ps((const float*)p + 4);
+                __m128 r2 = _mm_loadu_ps((const float*)p + 8);
+                p0 = r0;
+                __m128 t = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 3, 3));
+                p1 = _mm_shuffle_ps(t, r1, _MM_SHUFFLE(0, 1, 2, 0));
+                p2 = _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(0, 0, 3, 2));
+                p3 = _mm_shuffle_ps(r2, r2, _MM_SHUFFLE(3, 3, 2, 1));
+            }
+            else
+            {
+                p0 = _mm_loadu_ps((const float*)p);
+                p1 = _mm_loadu_ps((const float*)(p + stride));
+                p2 = _mm_loadu_ps((const float*)(p + stride * 2));
+                p3 = _mm_loadu_ps((const float*)(p + stride * 3));
+            }
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            x = p0;
+            y = p1;
+            z = p2;
+        }
+
+        // 16 bytes per point, the 4 bytes after every point are overwritten
+        inline void storePoints4(uint8_t* p, const size_t& stride, __m128 x, __m128 y, __m128 z)
+        {
+            __m128 w = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps((float*)p, x);
+            _mm_storeu_ps((float*)(p + stride), y);
+            _mm_storeu_ps((float*)(p + stride * 2), z);
+            _mm_storeu_ps((float*)(p + stride * 3), w);
+        }
+
+        inline void storeVec3s4(vec3* out, __m128 x, __m128 y, __m128 z)
+        {
+            __m128 w = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+
+            // x y z rows back into x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+            __m128 t = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 2, 2));
+            float* dst = &out[0].x;
+            _mm_storeu_ps(dst, _mm_shuffle_ps(x, t, _MM_SHUFFLE(2, 0, 1, 0)));
+            _mm_storeu_ps(dst + 4, _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 0, 2, 1)));
+            t = _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 0, 2, 2));
+            _mm_storeu_ps(dst + 8, _mm_shuffle_ps(t, w, _MM_SHUFFLE(2, 1, 2, 0)));
+        }
+#endif // __SSE2__
+
+        void packQuats(const quat* in, uint32_t* out, const unsigned& count, const unsigned& bits)
+        {
+            unsigned n = 0;
+#ifdef __SSE2__
+            for(; n + 4 <= count; n += 4)
+            {
+                __m128i largest, a, b, c;
+                packSmallestThree4(in + n, sizeof(quat), bits, largest, a, b, c);
+                _mm_storeu_si128((__m128i*)(out + n), combine32(largest, a, b, c, bits));
+            }
+#endif // __SSE2__
+            for(; n < count; n++)
+                out[n] = (uint32_t)packSmallestThree(in[n], bits);
+        }
+
+        void unpackQuats(const uint32_t* in, quat* out, const unsigned& count, const unsigned& bits)
+        {
+            unsigned n = 0;
+#ifdef __SSE2__
+            for(; n + 4 <= count; n += 4)
+            {
+                __m128i largest, a, b, c;
+                split32(_mm_loadu_si128((const __m128i*)(in + n)), bits, largest, a, b, c);
+                unpackSmallestThree4(largest, a, b, c, bits, out + n, sizeof(quat));
+            }
+#endif // __SSE2__
+            for(; n < count; n++)
+                out[n] = unpackSmallestThree(in[n], bits);
+        }
+    }
+
+    uint32_t quantize::packQuat29(const quat& v)
+    {
+        return (uint32_t)packSmallestThree(v, 9);
+    }
+
+    quat quantize::unpackQuat29(const uint32_t& v)
+    {
+        return unpackSmallestThree(v, 9);
+    }
+
+    uint32_t quantize::packQuat32(const quat& v)
+    {
+        return (uint32_t)packSmallestThree(v, 10);
+    }
+
+    quat quantize::unpackQuat32(const uint32_t& v)
+    {
+        return unpackSmallestThree(v, 10);
+    }
+
+    uint64_t quantize::packQuat48(const quat& v)
+    {
+        return packSmallestThree(v, 15);
+    }
+
+    quat quantize::unpackQuat48(const uint64_t& v)
+    {
+        return unpackSmallestThree(v, 15);
+    }
+
+    uint64_t quantize::packVec3(const vec3& v, const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        uint64_t res;
+        packVec3s(&v, &res, 1, min, max, bits);
+        return res;
+    }
+
+    vec3 quantize::unpackVec3(const uint64_t& v, const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        vec3 res;
+        unpackVec3s(&v, &res, 1, min, max, bits);
+        return res;
+    }
+
+    ///////////////////////////////////////
+    //              BATCH                //
+    ///////////////////////////////////////
+
+    void quantize::packQuats29(const quat* in, uint32_t* out, const unsigned& count)
+    {
+        packQuats(in, out, count, 9);
+    }
+
+    void quantize::unpackQuats29(const uint32_t* in, quat* out, const unsigned& count)
+    {
+        unpackQuats(in, out, count, 9);
+    }
+
+    void quantize::packQuats32(const quat* in, uint32_t* out, const unsigned& count)
+    {
+        packQuats(in, out, count, 10);
+    }
+
+    void quantize::unpackQuats32(const uint32_t* in, quat* out, const unsigned& count)
+    {
+        unpackQuats(in, out, count, 10);
+    }
+
+    // the low 30 bits hold b and c, the ones above the index and a, so the 64 bit helpers split at 30
+    void quantize::packQuats48(const quat* in, uint64_t* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128i shift = _mm_cvtsi32_si128(15);
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128i largest, a, b, c, lo, hi;
+            packSmallestThree4(in + n, sizeof(quat), 15, largest, a, b, c);
+            combine64(_mm_or_si128(_mm_sll_epi32(b, shift), c), _mm_or_si128(_mm_sll_epi32(largest, shift), a), _mm_setzero_si128(), 30, lo, hi);
+            _mm_storeu_si128((__m128i*)(out + n), lo);
+            _mm_storeu_si128((__m128i*)(out + n + 2), hi);
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = packSmallestThree(in[n], 15);
+    }
+
+    void quantize::unpackQuats48(const uint64_t* in, quat* out, const unsigned& count)
+    {
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128i shift = _mm_cvtsi32_si128(15);
+        const __m128i mask = _mm_set1_epi32(0x7fff);
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128i low, high, unused;
+            split64(_mm_loadu_si128((const __m128i*)(in + n)), _mm_loadu_si128((const __m128i*)(in + n + 2)), 30, low, high, unused);
+
+            __m128i largest = _mm_and_si128(_mm_srl_epi32(high, shift), _mm_set1_epi32(3));
+            __m128i a = _mm_and_si128(high, mask);
+            __m128i b = _mm_and_si128(_mm_srl_epi32(low, shift), mask);
+            __m128i c = _mm_and_si128(low, mask);
+            unpackSmallestThree4(largest, a, b, c, 15, out + n, sizeof(quat));
+        }
+#endif // __SSE2__
+        for(; n < count; n++)
+            out[n] = unpackSmallestThree(in[n], 15);
+    }
+
+    void quantize::packVec3s(const vec3* in, uint64_t* out, const unsigned& count, const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        float maxValue = (float)((1u << bits) - 1);
+        float sx = maxValue / (max.x - min.x);
+        float sy = maxValue / (max.y - min.y);
+        float sz = maxValue / (max.z - min.z);
+
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 maxValue4 = _mm_set1_ps(maxValue);
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128 x, y, z;
+            __m128i lo, hi;
+            loadPoints4((const uint8_t*)(in + n), sizeof(vec3), x, y, z);
+            combine64(quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, _mm_set1_ps(min.x)), _mm_set1_ps(sx)), half), maxValue4),
+                      quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(y, _mm_set1_ps(min.y)), _mm_set1_ps(sy)), half), maxValue4),
+                      quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(z, _mm_set1_ps(min.z)), _mm_set1_ps(sz)), half), maxValue4), bits, lo, hi);
+            _mm_storeu_si128((__m128i*)(out + n), lo);
+            _mm_storeu_si128((__m128i*)(out + n + 2), hi);
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            uint64_t x = quantizeRange(in[n].x, min.x, sx, maxValue);
+            uint64_t y = quantizeRange(in[n].y, min.y, sy, maxValue);
+            uint64_t z = quantizeRange(in[n].z, min.z, sz, maxValue);
+            out[n] = x | (y << bits) | (z << (bits * 2));
+        }
+    }
+
+    void quantize::unpackVec3s(const uint64_t* in, vec3* out, const unsigned& count, const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        uint64_t mask = (1u << bits) - 1;
+        float invMaxValue = 1.0f / (float)mask;
+        float sx = (max.x - min.x) * invMaxValue;
+        float sy = (max.y - min.y) * invMaxValue;
+        float sz = (max.z - min.z) * invMaxValue;
+
+        unsigned n = 0;
+#ifdef __SSE2__
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128i x, y, z;
+            split64(_mm_loadu_si128((const __m128i*)(in + n)), _mm_loadu_si128((const __m128i*)(in + n + 2)), bits, x, y, z);
+            storeVec3s4(out + n, _mm_add_ps(_mm_set1_ps(min.x), _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(sx))),
+                                 _mm_add_ps(_mm_set1_ps(min.y), _mm_mul_ps(_mm_cvtepi32_ps(y), _mm_set1_ps(sy))),
+                                 _mm_add_ps(_mm_set1_ps(min.z), _mm_mul_ps(_mm_cvtepi32_ps(z), _mm_set1_ps(sz))));
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            uint64_t v = in[n];
+            out[n].x = min.x + (float)(v & mask) * sx;
+            out[n].y = min.y + (float)((v >> bits) & mask) * sy;
+            out[n].z = min.z + (float)((v >> (bits * 2)) & mask) * sz;
+        }
+    }
+
+    void quantize::packTransforms(const transform* in, uint64_t* positions, uint32_t* rotations, const unsigned& count,
+                                  const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        float maxValue = (float)((1u << bits) - 1);
+        float sx = maxValue / (max.x - min.x);
+        float sy = maxValue / (max.y - min.y);
+        float sz = maxValue / (max.z - min.z);
+
+        unsigned n = 0;
+#ifdef __SSE2__
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 maxValue4 = _mm_set1_ps(maxValue);
+        for(; n + 4 <= count; n += 4)
+        {
+            // the 16 byte loads of the positions end inside the rotations
+            __m128 x, y, z;
+            __m128i lo, hi;
+            loadPoints4((const uint8_t*)&in[n].position, sizeof(transform), x, y, z);
+            combine64(quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, _mm_set1_ps(min.x)), _mm_set1_ps(sx)), half), maxValue4),
+                      quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(y, _mm_set1_ps(min.y)), _mm_set1_ps(sy)), half), maxValue4),
+                      quantize4(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(z, _mm_set1_ps(min.z)), _mm_set1_ps(sz)), half), maxValue4), bits, lo, hi);
+            _mm_storeu_si128((__m128i*)(positions + n), lo);
+            _mm_storeu_si128((__m128i*)(positions + n + 2), hi);
+
+            __m128i largest, a, b, c;
+            packSmallestThree4(&in[n].rotation, sizeof(transform), 10, largest, a, b, c);
+            _mm_storeu_si128((__m128i*)(rotations + n), combine32(largest, a, b, c, 10));
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            uint64_t x = quantizeRange(in[n].position.x, min.x, sx, maxValue);
+            uint64_t y = quantizeRange(in[n].position.y, min.y, sy, maxValue);
+            uint64_t z = quantizeRange(in[n].position.z, min.z, sz, maxValue);
+            positions[n] = x | (y << bits) | (z << (bits * 2));
+            rotations[n] = (uint32_t)packSmallestThree(in[n].rotation, 10);
+        }
+    }
+
+    void quantize::unpackTransforms(const uint64_t* positions, const uint32_t* rotations, transform* out, const unsigned& count,
+                                    const vec3& min, const vec3& max, const unsigned& bits)
+    {
+        uint64_t mask = (1u << bits) - 1;
+        float invMaxValue = 1.0f / (float)mask;
+        float sx = (max.x - min.x) * invMaxValue;
+        float sy = (max.y - min.y) * invMaxValue;
+        float sz = (max.z - min.z) * invMaxValue;
+
+        unsigned n = 0;
+#ifdef __SSE2__
+        for(; n + 4 <= count; n += 4)
+        {
+            __m128i x, y, z;
+            split64(_mm_loadu_si128((const __m128i*)(positions + n)), _mm_loadu_si128((const __m128i*)(positions + n + 2)), bits, x, y, z);
+            // the positions spill into rotation.i, the rotations are written after them
+            storePoints4((uint8_t*)&out[n].position, sizeof(transform),
+                         _mm_add_ps(_mm_set1_ps(min.x), _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(sx))),
+                         _mm_add_ps(_mm_set1_ps(min.y), _mm_mul_ps(_mm_cvtepi32_ps(y), _mm_set1_ps(sy))),
+                         _mm_add_ps(_mm_set1_ps(min.z), _mm_mul_ps(_mm_cvtepi32_ps(z), _mm_set1_ps(sz))));
+
+            __m128i largest, a, b, c;
+            split32(_mm_loadu_si128((const __m128i*)(rotations + n)), 10, largest, a, b, c);
+            unpackSmallestThree4(largest, a, b, c, 10, &out[n].rotation, sizeof(transform));
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            uint64_t v = positions[n];
+            out[n].position.x = min.x + (float)(v & mask) * sx;
+            out[n].position.y = min.y + (float)((v >> bits) & mask) * sy;
+            out[n].position.z = min.z + (float)((v >> (bits * 2)) & mask) * sz;
+            out[n].rotation = unpackSmallestThree(rotations[n], 10);
+        }
+    }
+
+    void quantize::delta(const uint32_t* values, const uint32_t* reference, uint32_t* out, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+            out[n] = values[n] ^ reference[n];
+    }
+
+    void quantize::delta(const uint64_t* values, const uint64_t* reference, uint64_t* out, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+            out[n] = values[n] ^ reference[n];
+    }
+}
@@ -1,9 +1,12 @@
 #include "m3d/quat.h"
 #include "m3d/vec3.h"
 #include "m3d/math1D.h"
+#include "m3d/mat3x3.h"
 #include "m3d/mat4x4.h"
+#include "m3d/profile.h"
 #include <cmath>
 #include <algorithm>
+#include <float.h>
 
 #include <stdio.h>
 
@@ -13,6 +16,8 @@ namespace m3d
     quat::quat(const float& i, const float& j, const float& k, const float& w) : i(i), j(j), k(k), w(w) {};
     quat::quat(const float& angle, const vec3& axis)
     {
+        M3D_PROFILE("quat::quat(angle, axis)");
+
         float s = std::sin(angle / 2.0f);
         i = axis.x * s;
         j = axis.y * s;
@@ -30,10 +35,21 @@ namespace m3d
         return 2.0f * acos((quat::conjugate(a) * b).w);
     }
 
+    quat quat::angleAxisFast(const float& angle, const vec3& axis)
+    {
+        M3D_PROFILE("quat::angleAxisFast");
+
+        float s, c;
+        fastSincos(angle * 0.5f, s, c);
+        return quat(axis.x * s, axis.y * s, axis.z * s, c);
+    }
+
     //https://stackoverflow.com/questions/12435671/quaternion-lookat-function
     //https://gamedev.stackexchange.com/questions/15070/orienting-a-model-to-face-a-target
     quat quat::angleVec3(const vec3& a, const vec3& b, const vec3& up)
     {
+        M3D_PROFILE("quat::angleVec3");
+
         float dot = vec3::dot(a, b);
         // test for dot -1
         if(fabsf(dot + 1.0f) < 0.000001f)
@@ -73,6 +89,8 @@ namespace m3d
 
     vec3 quat::euler(const quat& v)
     {
+        M3D_PROFILE("quat::euler");
+
         float i2 = v.i * v.i;
         float j2 = v.j * v.j;
         float k2 = v.k * v.k;
@@ -111,6 +129,8 @@ namespace m3d
 
     vec3 quat::rotateVec3(const quat& a, const vec3& b)
     {
+        M3D_PROFILE("quat::rotateVec3");
+
         quat P = quat(b.x, b.y, b.z, 0.0f);
 
         quat temp = a * P * quat::conjugate(a);
@@ -120,6 +140,8 @@ namespace m3d
 
     quat quat::normalized(const quat& v)
     {
+        M3D_PROFILE("quat::normalized");
+
         float length = quat::length(v);
         quat res;
         res.i = v.i / length;
@@ -129,9 +151,21 @@ namespace m3d
         return res;
     }
 
+    quat quat::normalizedFast(const quat& v)
+    {
+        M3D_PROFILE("quat::normalizedFast");
+
+        float lengthSqr = quat::lengthSqr(v);
+
+        // the estimate flushes denormals, take the exact path for those
+        return lengthSqr >= FLT_MIN ? v * fastRsqrt(lengthSqr) : quat::normalized(v);
+    }
+
     //https://en.wikipedia.org/wiki/Slerp#Source_code
     quat quat::slerp(const quat& a, const quat& b, const float& t)
     {
+        M3D_PROFILE("quat::slerp");
+
         // Only unit quaternions are valid rotations.
         // Normalize to avoid undefined behavior.
         quat v0 = a.normalized();
@@ -172,44 +206,108 @@ namespace m3d
         return ((v0 * s0) + (v1 * s1)).normalized();
     }
 
+    //https://zeux.io/2015/07/23/approximating-slerp/
+    // nlerp with t corrected by a fitted polynomial, branch free
+    quat quat::slerpFast(const quat& a, const quat& b, const float& t)
+    {
+        M3D_PROFILE("quat::slerpFast");
+
+        float ca = quat::dot(a, b);
+        float d = fabsf(ca);
+
+        float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+        float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+        float k = A * (t - 0.5f) * (t - 0.5f) + B;
+        float ot = t + t * (t - 0.5f) * (t - 1.0f) * k;
+
+        float lt = 1.0f - ot;
+        float rt = ca > 0.0f ? ot : -ot;
+
+        quat res;
+        res.i = a.i * lt + b.i * rt;
+        res.j = a.j * lt + b.j * rt;
+        res.k = a.k * lt + b.k * rt;
+        res.w = a.w * lt + b.w * rt;
+        return quat::normalizedFast(res);
+    }
+
+    quat quat::log(const quat& v)
+    {
+        float length = sqrtf(v.i * v.i + v.j * v.j + v.k * v.k);
+
+        // sin(angle) / angle is 1 near zero, the vector part is already the answer
+        float scale = length > 1e-6f ? atan2f(length, v.w) / length : 1.0f;
+        return quat(v.i * scale, v.j * scale, v.k * scale, 0.0f);
+    }
+
+    quat quat::exp(const quat& v)
+    {
+        float angle = sqrtf(v.i * v.i + v.j * v.j + v.k * v.k);
+
+        float scale = angle > 1e-6f ? sinf(angle) / angle : 1.0f;
+        return quat(v.i * scale, v.j * scale, v.k * scale, cosf(angle));
+    }
+
+    //https://theory.org/software/qfa/writeup/node12.html
+    quat quat::squad(const quat& a, const quat& aControl, const quat& bControl, const quat& b, const float& t)
+    {
+        M3D_PROFILE("quat::squad");
+
+        return quat::slerp(quat::slerp(a, b, t), quat::slerp(aControl, bControl, t), 2.0f * t * (1.0f - t));
+    }
+
+    // current * exp(-(log(current^-1 * previous) + log(current^-1 * next)) / 4)
+    quat quat::squadControl(const quat& previous, const quat& current, const quat& next)
+    {
+        M3D_PROFILE("quat::squadControl");
+
+        quat inverse = quat::conjugate(current);
+        quat a = quat::log(quat::mul(inverse, quat::dot(previous, current) < 0.0f ? quat::mul(previous, -1.0f) : previous));
+        quat b = quat::log(quat::mul(inverse, quat::dot(next, current) < 0.0f ? quat::mul(next, -1.0f) : next));
+
+        return quat::normalized(quat::mul(current, quat::exp(quat::mul(quat::add(a, b), -0.25f))));
+    }
+
     //https://www.euclideanspace.com/maths/geometry/rotations/conversions/matrixToQuaternion/
     quat quat::fromMat4x4(const mat4x4& mat)
     {
+        M3D_PROFILE("quat::fromMat4x4");
+
         quat res;
 
-        float trace = mat.m[0][0] + mat.m[1][1] + mat.m[2][2];
+        float trace = mat.at(0, 0) + mat.at(1, 1) + mat.at(2, 2);
         if( trace > 0 )
         {
             float s = 0.5f / sqrtf(trace+ 1.0f);
             res.w = 0.25f / s;
-            res.i = ( mat.m[1][2] - mat.m[2][1] ) * s;
-            res.j = ( mat.m[2][0] - mat.m[0][2] ) * s;
-            res.k = ( mat.m[0][1] - mat.m[1][0] ) * s;
+            res.i = ( mat.at(1, 2) - mat.at(2, 1) ) * s;
+            res.j = ( mat.at(2, 0) - mat.at(0, 2) ) * s;
+            res.k = ( mat.at(0, 1) - mat.at(1, 0) ) * s;
         }
         else
         {
-            if( mat.m[0][0] > mat.m[1][1] && mat.m[0][0] > mat.m[2][2] )
+            if( mat.at(0, 0) > mat.at(1, 1) && mat.at(0, 0) > mat.at(2, 2) )
             {
-                float s = 2.0f * sqrtf( 1.0f + mat.m[0][0] - mat.m[1][1] - mat.m[2][2]);
-                res.w = (mat.m[1][2] - mat.m[2][1] ) / s;
+                float s = 2.0f * sqrtf( 1.0f + mat.at(0, 0) - mat.at(1, 1) - mat.at(2, 2));
+                res.w = (mat.at(1, 2) - mat.at(2, 1) ) / s;
                 res.i = 0.25f * s;
-                res.j = (mat.m[1][0] + mat.m[0][1] ) / s;
-                res.k = (mat.m[2][0] + mat.m[0][2] ) / s;
+                res.j = (mat.at(1, 0) + mat.at(0, 1) ) / s;
+                res.k = (mat.at(2, 0) + mat.at(0, 2) ) / s;
             }
-            else if(mat.m[1][1] > mat.m[2][2])
+            else if(mat.at(1, 1) > mat.at(2, 2))
             {
-                float s = 2.0f * sqrtf( 1.0f + mat.m[1][1] - mat.m[0][0] - mat.m[2][2]);
-                res.w = (mat.m[2][0] - mat.m[0][2] ) / s;
-                res.i = (mat.m[1][0] + mat.m[0][1] ) / s;
+                float s = 2.0f * sqrtf( 1.0f + mat.at(1, 1) - mat.at(0, 0) - mat.at(2, 2));
+                res.w = (mat.at(2, 0) - mat.at(0, 2) ) / s;
+                res.i = (mat.at(1, 0) + mat.at(0, 1) ) / s;
                 res.j = 0.25f * s;
-                res.k = (mat.m[2][1] + mat.m[1][2] ) / s;
+                res.k = (mat.at(2, 1) + mat.at(1, 2) ) / s;
             }
             else
             {
-                float s = 2.0f * sqrtf( 1.0f + mat.m[2][2] - mat.m[0][0] - mat.m[1][1] );
-                res.w = (mat.m[0][1] - mat.m[1][0] ) / s;
-                res.i = (mat.m[2][0] + mat.m[0][2] ) / s;
-                res.j = (mat.m[2][1] + mat.m[1][2] ) / s;
+                float s = 2.0f * sqrtf( 1.0f + mat.at(2, 2) - mat.at(0, 0) - mat.at(1, 1) );
+                res.w = (mat.at(0, 1) - mat.at(1, 0) ) / s;
+                res.i = (mat.at(2, 0) + mat.at(0, 2) ) / s;
+                res.j = (mat.at(2, 1) + mat.at(1, 2) ) / s;
                 res.k = 0.25f * s;
             }
         }
@@ -217,6 +315,48 @@ namespace m3d
         return res.normalized();
     }
 
+    // same branches as fromMat4x4 on the transposed matrix, the largest of w, i, j, k is found first so s never gets small
+    quat quat::fromRotation(const mat3x3& mat)
+    {
+        quat res;
+
+        float trace = mat.at(0, 0) + mat.at(1, 1) + mat.at(2, 2);
+        if(trace > 0.0f)
+        {
+            float s = 0.5f / sqrtf(trace + 1.0f);
+            res.w = 0.25f / s;
+            res.i = (mat.at(2, 1) - mat.at(1, 2)) * s;
+            res.j = (mat.at(0, 2) - mat.at(2, 0)) * s;
+            res.k = (mat.at(1, 0) - mat.at(0, 1)) * s;
+        }
+        else if(mat.at(0, 0) > mat.at(1, 1) && mat.at(0, 0) > mat.at(2, 2))
+        {
+            float s = 2.0f * sqrtf(1.0f + mat.at(0, 0) - mat.at(1, 1) - mat.at(2, 2));
+            res.w = (mat.at(2, 1) - mat.at(1, 2)) / s;
+            res.i = 0.25f * s;
+            res.j = (mat.at(0, 1) + mat.at(1, 0)) / s;
+            res.k = (mat.at(0, 2) + mat.at(2, 0)) / s;
+        }
+        else if(mat.at(1, 1) > mat.at(2, 2))
+        {
+            float s = 2.0f * sqrtf(1.0f + mat.at(1, 1) - mat.at(0, 0) - mat.at(2, 2));
+            res.w = (mat.at(0, 2) - mat.at(2, 0)) / s;
+            res.i = (mat.at(0, 1) + mat.at(1, 0)) / s;
+            res.j = 0.25f * s;
+            res.k = (mat.at(1, 2) + mat.at(2, 1)) / s;
+        }
+        else
+        {
+            float s = 2.0f * sqrtf(1.0f + mat.at(2, 2) - mat.at(0, 0) - mat.at(1, 1));
+            res.w = (mat.at(1, 0) - mat.at(0, 1)) / s;
+            res.i = (mat.at(0, 2) + mat.at(2, 0)) / s;
+            res.j = (mat.at(1, 2) + mat.at(2, 1)) / s;
+            res.k = 0.25f * s;
+        }
+
+        return res.normalized();
+    }
+
     quat quat::add(const quat& a, const quat& b)
     {
         quat res;
@@ -241,6 +381,8 @@ namespace m3d
 
     quat quat::mul(const quat& a, const quat& b)
     {
+        M3D_PROFILE("quat::mul");
+
         quat res;
 
         res.i = a.w * b.i + a.i * b.w + a.j * b.k - a.k * b.j;
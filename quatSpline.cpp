@@ -0,0 +1,236 @@
+#include "m3d/quatSpline.h"
+#include "m3d/quat.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 1024;
+
+#ifdef __SSE__
+        // quat::slerpFast on four pairs, components in separate registers, same steps lane for lane
+        inline void slerpFast4(const __m128* a, const __m128* b, const __m128& t, __m128* res)
+        {
+            __m128 ca = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+                                   _mm_add_ps(_mm_mul_ps(a[2], b[2]), _mm_mul_ps(a[3], b[3])));
+            __m128 sign = _mm_and_ps(ca, _mm_set1_ps(-0.0f));
+            __m128 d = _mm_xor_ps(ca, sign);
+
+            __m128 A = _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)));
+            A = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, A));
+            A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, A));
+            __m128 B = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)));
+            B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, B));
+
+            __m128 half = _mm_sub_ps(t, _mm_set1_ps(0.5f));
+            __m128 k = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(A, half), half), B);
+            __m128 ot = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, half), _mm_sub_ps(t, _mm_set1_ps(1.0f))), k));
+
+            // slerpFast keeps the sign only for ca > 0, zero flips like a negative dot
+            __m128 positive = _mm_cmpgt_ps(ca, _mm_setzero_ps());
+            __m128 lt = _mm_sub_ps(_mm_set1_ps(1.0f), ot);
+            __m128 rt = _mm_or_ps(_mm_and_ps(positive, ot), _mm_andnot_ps(positive, _mm_xor_ps(ot, _mm_set1_ps(-0.0f))));
+
+            __m128 q[4];
+            for(int c = 0; c < 4; c++)
+            {
+                q[c] = _mm_add_ps(_mm_mul_ps(a[c], lt), _mm_mul_ps(b[c], rt));
+            }
+
+            // fastRsqrt, an estimate and one newton step
+            __m128 lengthSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q[0], q[0]), _mm_mul_ps(q[1], q[1])),
+                                          _mm_add_ps(_mm_mul_ps(q[2], q[2]), _mm_mul_ps(q[3], q[3])));
+            __m128 y = _mm_rsqrt_ps(lengthSqr);
+            y = _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), lengthSqr), _mm_mul_ps(y, y))));
+
+            for(int c = 0; c < 4; c++)
+            {
+                res[c] = _mm_mul_ps(q[c], y);
+            }
+        }
+
+        const float IDENTITY[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        // four quaternions, one per lane, to i j k w registers
+        inline void load4(const float* const* q, __m128* res)
+        {
+            res[0] = _mm_loadu_ps(q[0]);
+            res[1] = _mm_loadu_ps(q[1]);
+            res[2] = _mm_loadu_ps(q[2]);
+            res[3] = _mm_loadu_ps(q[3]);
+            _MM_TRANSPOSE4_PS(res[0], res[1], res[2], res[3]);
+        }
+#endif // __SSE__
+    }
+
+    unsigned quatSpline::addTrack(const float* times, const quat* keys, const unsigned& count)
+    {
+        M3D_PROFILE("quatSpline::addTrack");
+
+        track res;
+        res.first = (unsigned)m_keys.size();
+        res.count = count;
+        m_tracks.push_back(res);
+
+        m_times.insert(m_times.end(), times, times + count);
+        for(unsigned n = 0; n < count; n++)
+        {
+            quat key = quat::normalized(keys[n]);
+            if(n > 0 && quat::dot(key, m_keys.back()) < 0.0f)
+                key = quat::mul(key, -1.0f);
+            m_keys.push_back(key);
+        }
+
+        // the ends use themselves as the missing neighbour
+        const quat* k = m_keys.data() + res.first;
+        for(unsigned n = 0; n < count; n++)
+        {
+            m_controls.push_back(quat::squadControl(k[n > 0 ? n - 1 : n], k[n], k[n + 1 < count ? n + 1 : n]));
+        }
+
+        return (unsigned)m_tracks.size() - 1;
+    }
+
+    void quatSpline::clear()
+    {
+        m_tracks.clear();
+        m_times.clear();
+        m_keys.clear();
+        m_controls.clear();
+    }
+
+    unsigned quatSpline::trackCount() const
+    {
+        return (unsigned)m_tracks.size();
+    }
+
+    unsigned quatSpline::segment(const track& current, const float& time, float& t) const
+    {
+        const float* times = m_times.data() + current.first;
+        if(current.count < 2 || time <= times[0])
+        {
+            t = 0.0f;
+            return current.first;
+        }
+
+        if(time >= times[current.count - 1])
+        {
+            t = 1.0f;
+            return current.first + current.count - 2;
+        }
+
+        unsigned n = (unsigned)(std::upper_bound(times, times + current.count, time) - times) - 1;
+        t = (time - times[n]) / (times[n + 1] - times[n]);
+        return current.first + n;
+    }
+
+    quat quatSpline::evaluate(const unsigned& track, const float& time) const
+    {
+        const quatSpline::track& current = m_tracks[track];
+        if(current.count == 0)
+            return quat();
+
+        float t;
+        unsigned n = segment(current, time, t);
+        if(current.count == 1)
+            return m_keys[n];
+
+        return quat::squad(m_keys[n], m_controls[n], m_controls[n + 1], m_keys[n + 1], t);
+    }
+
+    void quatSpline::evaluate(const unsigned& begin, const unsigned& end, const float* times, const unsigned& timeStride, quat* res) const
+    {
+        unsigned n = begin;
+
+#ifdef __SSE__
+        for(; n + 4 <= end; n += 4)
+        {
+            // single key tracks repeat their key, both slerps then return it
+            const float* keys[4][4];
+            float t[4];
+            for(unsigned lane = 0; lane < 4; lane++)
+            {
+                const track& current = m_tracks[n + lane];
+                if(current.count == 0)
+                {
+                    keys[0][lane] = keys[1][lane] = keys[2][lane] = keys[3][lane] = IDENTITY;
+                    t[lane] = 0.0f;
+                    continue;
+                }
+
+                unsigned key = segment(current, times[(n + lane) * timeStride], t[lane]);
+                unsigned next = current.count > 1 ? key + 1 : key;
+                keys[0][lane] = &m_keys[key].i;
+                keys[1][lane] = &m_keys[next].i;
+                keys[2][lane] = &m_controls[key].i;
+                keys[3][lane] = &m_controls[next].i;
+            }
+
+            __m128 a[4], b[4], c[4], d[4], outer[4], inner[4], q[4];
+            load4(keys[0], a);
+            load4(keys[1], b);
+            load4(keys[2], c);
+            load4(keys[3], d);
+
+            __m128 t4 = _mm_loadu_ps(t);
+            slerpFast4(a, b, t4, outer);
+            slerpFast4(c, d, t4, inner);
+            slerpFast4(outer, inner, _mm_mul_ps(_mm_set1_ps(2.0f), _mm_mul_ps(t4, _mm_sub_ps(_mm_set1_ps(1.0f), t4))), q);
+
+            _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+            for(unsigned lane = 0; lane < 4; lane++)
+            {
+                _mm_storeu_ps(&res[n + lane].i, q[lane]);
+            }
+        }
+#endif // __SSE__
+
+        for(; n < end; n++)
+        {
+            const track& current = m_tracks[n];
+            if(current.count == 0)
+            {
+                res[n] = quat();
+                continue;
+            }
+
+            float t;
+            unsigned key = segment(current, times[n * timeStride], t);
+            unsigned next = current.count > 1 ? key + 1 : key;
+            res[n] = quat::slerpFast(quat::slerpFast(m_keys[key], m_keys[next], t),
+                                     quat::slerpFast(m_controls[key], m_controls[next], t), 2.0f * t * (1.0f - t));
+        }
+    }
+
+    void quatSpline::evaluate(const float* times, quat* res) const
+    {
+        M3D_PROFILE("quatSpline::evaluate");
+
+        evaluate(0, trackCount(), times, 1, res);
+    }
+
+    void quatSpline::evaluateParallel(const float* times, quat* res) const
+    {
+        M3D_PROFILE("quatSpline::evaluateParallel");
+
+        parallelFor(trackCount(), GRAIN, [&](unsigned begin, unsigned end)
+        {
+            evaluate(begin, end, times, 1, res);
+        });
+    }
+
+    void quatSpline::evaluate(const float& time, quat* res) const
+    {
+        M3D_PROFILE("quatSpline::evaluate(time)");
+
+        evaluate(0, trackCount(), &time, 0, res);
+    }
+}
@@ -0,0 +1,158 @@
+#include "m3d/ray.h"
+#include "m3d/vec2.h"
+#include "m3d/mat4x4.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <math.h>
+
+namespace m3d
+{
+    namespace
+    {
+        // rows of pixels per parallelFor range
+        const unsigned GRAIN = 16;
+
+        // the inverse view projection times (x, y, z, 1) is column0 * x + column1 * y + (column2 * z + column3),
+        // the last part is the same for every ray so it is added once per plane
+        struct unprojector
+        {
+            float c0[4];
+            float c1[4];
+            float nearBase[4];
+            float farBase[4];
+
+            unprojector(const mat4x4& inv, const float& nearZ, const float& farZ)
+            {
+                for(int i = 0; i < 4; i++)
+                {
+                    c0[i] = inv.at(i, 0);
+                    c1[i] = inv.at(i, 1);
+                    nearBase[i] = inv.at(i, 2) * nearZ + inv.at(i, 3);
+                    farBase[i] = inv.at(i, 2) * farZ + inv.at(i, 3);
+                }
+            }
+
+            // n and f are the homogeneous near and far points, f.w is 0 for an infinite far plane
+            // so the direction is f.xyz * n.w - n.xyz * f.w instead of a difference of divided points
+            inline void rayFrom(const float* n, const float* f, ray& res) const
+            {
+                float invW = 1.0f / n[3];
+                res.origin.x = n[0] * invW;
+                res.origin.y = n[1] * invW;
+                res.origin.z = n[2] * invW;
+
+                float dx = f[0] * n[3] - n[0] * f[3];
+                float dy = f[1] * n[3] - n[1] * f[3];
+                float dz = f[2] * n[3] - n[2] * f[3];
+                float invLength = 1.0f / sqrtf(dx * dx + dy * dy + dz * dz);
+
+                res.direction.x = dx * invLength;
+                res.direction.y = dy * invLength;
+                res.direction.z = dz * invLength;
+            }
+
+            inline void unproject(const float& x, const float& y, ray& res) const
+            {
+                float n[4], f[4];
+                for(int i = 0; i < 4; i++)
+                {
+                    float xy = c0[i] * x + c1[i] * y;
+                    n[i] = xy + nearBase[i];
+                    f[i] = xy + farBase[i];
+                }
+
+                rayFrom(n, f, res);
+            }
+        };
+    }
+
+    ray::ray() {};
+    ray::ray(const vec3& origin, const vec3& direction) : origin(origin), direction(direction) {};
+
+    ///////////////////////////////////////
+    //              STATIC               //
+    ///////////////////////////////////////
+
+    vec3 ray::point(const ray& r, const float& t)
+    {
+        return vec3(r.origin.x + r.direction.x * t, r.origin.y + r.direction.y * t, r.origin.z + r.direction.z * t);
+    }
+
+    ray ray::unproject(const mat4x4& invViewProj, const vec2& ndc, const float& nearZ, const float& farZ)
+    {
+        ray res;
+        unprojector(invViewProj, nearZ, farZ).unproject(ndc.x, ndc.y, res);
+        return res;
+    }
+
+    void ray::unproject(const mat4x4& invViewProj, const vec2* ndc, ray* rays, const unsigned& count, const float& nearZ, const float& farZ)
+    {
+        M3D_PROFILE("ray::unproject");
+
+        unprojector u(invViewProj, nearZ, farZ);
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            u.unproject(ndc[n].x, ndc[n].y, rays[n]);
+        }
+    }
+
+    void ray::unprojectGrid(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, ray* rays, const float& nearZ, const float& farZ)
+    {
+        ray::unprojectRows(invViewProj, width, height, 0, height, rays, nearZ, farZ);
+    }
+
+    // the y part is shared by a whole row and x steps by 2 / width
+    void ray::unprojectRows(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, const unsigned& rowBegin, const unsigned& rowEnd,
+                            ray* rays, const float& nearZ, const float& farZ)
+    {
+        M3D_PROFILE("ray::unprojectRows");
+
+        unprojector u(invViewProj, nearZ, farZ);
+
+        float stepX = 2.0f / width;
+        float stepY = 2.0f / height;
+
+        for(unsigned y = rowBegin; y < rowEnd; y++)
+        {
+            float ndcY = 1.0f - (y + 0.5f) * stepY;
+
+            float rowNear[4], rowFar[4];
+            for(int i = 0; i < 4; i++)
+            {
+                rowNear[i] = u.c1[i] * ndcY + u.nearBase[i];
+                rowFar[i] = u.c1[i] * ndcY + u.farBase[i];
+            }
+
+            ray* row = rays + (size_t)y * width;
+            for(unsigned x = 0; x < width; x++)
+            {
+                float ndcX = (x + 0.5f) * stepX - 1.0f;
+
+                float n[4], f[4];
+                for(int i = 0; i < 4; i++)
+                {
+                    float cx = u.c0[i] * ndcX;
+                    n[i] = cx + rowNear[i];
+                    f[i] = cx + rowFar[i];
+                }
+
+                u.rayFrom(n, f, row[x]);
+            }
+        }
+    }
+
+    void ray::unprojectGridParallel(const mat4x4& invViewProj, const unsigned& width, const unsigned& height, ray* rays, const float& nearZ, const float& farZ)
+    {
+        parallelFor(height, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            ray::unprojectRows(invViewProj, width, height, begin, end, rays, nearZ, farZ);
+        });
+    }
+
+    vec3 ray::point(const float& t) const
+    {
+        return ray::point(*this, t);
+    }
+}
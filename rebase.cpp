@@ -0,0 +1,105 @@
+#include "m3d/rebase.h"
+#include "m3d/vec3.h"
+#include "m3d/dvec3.h"
+#include "m3d/affine.h"
+#include "m3d/profile.h"
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+namespace m3d
+{
+    static_assert(sizeof(vec3) == 3 * sizeof(float), "rebase reads vec3 arrays as flat floats");
+
+    namespace
+    {
+        inline float relativeAxis(const float& hi, const float& lo, const float& originHi, const float& originLo)
+        {
+            return (hi - originHi) + (lo - originLo);
+        }
+    }
+
+    void rebase::split(const dvec3& v, vec3& hi, vec3& lo)
+    {
+        hi = v.toVec3();
+        lo = vec3((float)(v.x - hi.x), (float)(v.y - hi.y), (float)(v.z - hi.z));
+    }
+
+    void rebase::split(const dvec3* v, vec3* hi, vec3* lo, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+        {
+            rebase::split(v[n], hi[n], lo[n]);
+        }
+    }
+
+    void rebase::relative(const dvec3& origin, const vec3* hi, const vec3* lo, vec3* res, const unsigned& count)
+    {
+        M3D_PROFILE("rebase::relative");
+
+        vec3 originHi, originLo;
+        rebase::split(origin, originHi, originLo);
+
+        const float oh[3] = { originHi.x, originHi.y, originHi.z };
+        const float ol[3] = { originLo.x, originLo.y, originLo.z };
+
+        const float* h = &hi[0].x;
+        const float* l = &lo[0].x;
+        float* out = &res[0].x;
+        unsigned size = count * 3;
+        unsigned n = 0;
+
+#ifdef __SSE__
+        // four vec3 are three float4, the origin repeats as xyzx yzxy zxyz over them
+        __m128 oh0 = _mm_setr_ps(oh[0], oh[1], oh[2], oh[0]);
+        __m128 oh1 = _mm_setr_ps(oh[1], oh[2], oh[0], oh[1]);
+        __m128 oh2 = _mm_setr_ps(oh[2], oh[0], oh[1], oh[2]);
+        __m128 ol0 = _mm_setr_ps(ol[0], ol[1], ol[2], ol[0]);
+        __m128 ol1 = _mm_setr_ps(ol[1], ol[2], ol[0], ol[1]);
+        __m128 ol2 = _mm_setr_ps(ol[2], ol[0], ol[1], ol[2]);
+
+        for(; n + 12 <= size; n += 12)
+        {
+            _mm_storeu_ps(out + n, _mm_add_ps(_mm_sub_ps(_mm_loadu_ps(h + n), oh0), _mm_sub_ps(_mm_loadu_ps(l + n), ol0)));
+            _mm_storeu_ps(out + n + 4, _mm_add_ps(_mm_sub_ps(_mm_loadu_ps(h + n + 4), oh1), _mm_sub_ps(_mm_loadu_ps(l + n + 4), ol1)));
+            _mm_storeu_ps(out + n + 8, _mm_add_ps(_mm_sub_ps(_mm_loadu_ps(h + n + 8), oh2), _mm_sub_ps(_mm_loadu_ps(l + n + 8), ol2)));
+        }
+#endif // __SSE__
+
+        for(; n < size; n++)
+        {
+            out[n] = relativeAxis(h[n], l[n], oh[n % 3], ol[n % 3]);
+        }
+    }
+
+    void rebase::relative(const dvec3& origin, const vec3* hi, const vec3* lo, const affine* models, affine* res, const unsigned& count)
+    {
+        M3D_PROFILE("rebase::relative(affine)");
+
+        vec3 originHi, originLo;
+        rebase::split(origin, originHi, originLo);
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            const affine& m = models[n];
+            affine& r = res[n];
+
+            r.m[0][0] = m.m[0][0]; r.m[0][1] = m.m[0][1]; r.m[0][2] = m.m[0][2];
+            r.m[1][0] = m.m[1][0]; r.m[1][1] = m.m[1][1]; r.m[1][2] = m.m[1][2];
+            r.m[2][0] = m.m[2][0]; r.m[2][1] = m.m[2][1]; r.m[2][2] = m.m[2][2];
+
+            r.m[0][3] = relativeAxis(hi[n].x, lo[n].x, originHi.x, originLo.x);
+            r.m[1][3] = relativeAxis(hi[n].y, lo[n].y, originHi.y, originLo.y);
+            r.m[2][3] = relativeAxis(hi[n].z, lo[n].z, originHi.z, originLo.z);
+        }
+    }
+
+    void rebase::relative(const dvec3& origin, const dvec3* positions, vec3* res, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+        {
+            res[n] = dvec3::relative(positions[n], origin);
+        }
+    }
+}
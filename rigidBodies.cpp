@@ -0,0 +1,226 @@
+#include "m3d/rigidBodies.h"
+#include "m3d/vec3.h"
+#include "m3d/quat.h"
+#include "m3d/math1D.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+#include <math.h>
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 8192;
+
+        // |q|^2 may drift this far from 1 before the orientation is renormalized,
+        // the exponential map step itself is unit length so the drift is only rounding
+        const float DRIFT = 1e-5f;
+
+        // below this half angle sin(t) / t uses its series
+        const float SMALL_ANGLE = 1e-4f;
+
+        inline void step(rigidBodies& b, const unsigned& n, const float& dt, const float& halfDt, const vec3& g)
+        {
+            b.vx[n] += (b.ax[n] + g.x) * dt;
+            b.vy[n] += (b.ay[n] + g.y) * dt;
+            b.vz[n] += (b.az[n] + g.z) * dt;
+            b.x[n] += b.vx[n] * dt;
+            b.y[n] += b.vy[n] * dt;
+            b.z[n] += b.vz[n] * dt;
+
+            b.wx[n] += b.alphaX[n] * dt;
+            b.wy[n] += b.alphaY[n] * dt;
+            b.wz[n] += b.alphaZ[n] * dt;
+
+            float hx = b.wx[n] * halfDt;
+            float hy = b.wy[n] * halfDt;
+            float hz = b.wz[n] * halfDt;
+            float t2 = hx * hx + hy * hy + hz * hz;
+            float t = sqrtf(t2);
+
+            float s, c;
+            fastSincos(t, s, c);
+            float k = t < SMALL_ANGLE ? 1.0f - t2 / 6.0f : s / t;
+
+            float di = hx * k, dj = hy * k, dk = hz * k, dw = c;
+            float qi = b.qi[n], qj = b.qj[n], qk = b.qk[n], qw = b.qw[n];
+
+            float ri = dw * qi + di * qw + dj * qk - dk * qj;
+            float rj = dw * qj - di * qk + dj * qw + dk * qi;
+            float rk = dw * qk + di * qj - dj * qi + dk * qw;
+            float rw = dw * qw - di * qi - dj * qj - dk * qk;
+
+            float l2 = ri * ri + rj * rj + rk * rk + rw * rw;
+            if(fabsf(l2 - 1.0f) > DRIFT)
+            {
+                float inv = 1.0f / sqrtf(l2);
+                ri *= inv; rj *= inv; rk *= inv; rw *= inv;
+            }
+
+            b.qi[n] = ri;
+            b.qj[n] = rj;
+            b.qk[n] = rk;
+            b.qw[n] = rw;
+        }
+
+#ifdef __SSE2__
+        inline __m128 load(const std::vector<float>& v, const unsigned& n) { return _mm_loadu_ps(v.data() + n); }
+        inline void store(std::vector<float>& v, const unsigned& n, const __m128& x) { _mm_storeu_ps(v.data() + n, x); }
+
+        // step for bodies n to n + 3
+        inline void step4(rigidBodies& b, const unsigned& n, const __m128& dt, const __m128& halfDt, const __m128 g[3])
+        {
+            __m128 vx = _mm_add_ps(load(b.vx, n), _mm_mul_ps(_mm_add_ps(load(b.ax, n), g[0]), dt));
+            __m128 vy = _mm_add_ps(load(b.vy, n), _mm_mul_ps(_mm_add_ps(load(b.ay, n), g[1]), dt));
+            __m128 vz = _mm_add_ps(load(b.vz, n), _mm_mul_ps(_mm_add_ps(load(b.az, n), g[2]), dt));
+            store(b.vx, n, vx);
+            store(b.vy, n, vy);
+            store(b.vz, n, vz);
+            store(b.x, n, _mm_add_ps(load(b.x, n), _mm_mul_ps(vx, dt)));
+            store(b.y, n, _mm_add_ps(load(b.y, n), _mm_mul_ps(vy, dt)));
+            store(b.z, n, _mm_add_ps(load(b.z, n), _mm_mul_ps(vz, dt)));
+
+            __m128 wx = _mm_add_ps(load(b.wx, n), _mm_mul_ps(load(b.alphaX, n), dt));
+            __m128 wy = _mm_add_ps(load(b.wy, n), _mm_mul_ps(load(b.alphaY, n), dt));
+            __m128 wz = _mm_add_ps(load(b.wz, n), _mm_mul_ps(load(b.alphaZ, n), dt));
+            store(b.wx, n, wx);
+            store(b.wy, n, wy);
+            store(b.wz, n, wz);
+
+            __m128 hx = _mm_mul_ps(wx, halfDt);
+            __m128 hy = _mm_mul_ps(wy, halfDt);
+            __m128 hz = _mm_mul_ps(wz, halfDt);
+            __m128 t2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)), _mm_mul_ps(hz, hz));
+            __m128 t = _mm_sqrt_ps(t2);
+
+            __m128 s, c;
+            fastSincos4(t, s, c);
+
+            // the division is masked out for small angles, max keeps it from dividing by zero
+            __m128 small = _mm_cmplt_ps(t, _mm_set1_ps(SMALL_ANGLE));
+            __m128 series = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t2, _mm_set1_ps(1.0f / 6.0f)));
+            __m128 sinc = _mm_div_ps(s, _mm_max_ps(t, _mm_set1_ps(SMALL_ANGLE)));
+            __m128 k = _mm_or_ps(_mm_and_ps(small, series), _mm_andnot_ps(small, sinc));
+
+            __m128 di = _mm_mul_ps(hx, k), dj = _mm_mul_ps(hy, k), dk = _mm_mul_ps(hz, k), dw = c;
+            __m128 qi = load(b.qi, n), qj = load(b.qj, n), qk = load(b.qk, n), qw = load(b.qw, n);
+
+            __m128 ri = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dw, qi), _mm_mul_ps(di, qw)), _mm_mul_ps(dj, qk)), _mm_mul_ps(dk, qj));
+            __m128 rj = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dw, qj), _mm_mul_ps(di, qk)), _mm_mul_ps(dj, qw)), _mm_mul_ps(dk, qi));
+            __m128 rk = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(dw, qk), _mm_mul_ps(di, qj)), _mm_mul_ps(dj, qi)), _mm_mul_ps(dk, qw));
+            __m128 rw = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(dw, qw), _mm_mul_ps(di, qi)), _mm_mul_ps(dj, qj)), _mm_mul_ps(dk, qk));
+
+            // the square root and division only run when a lane has drifted
+            __m128 l2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ri, ri), _mm_mul_ps(rj, rj)), _mm_add_ps(_mm_mul_ps(rk, rk), _mm_mul_ps(rw, rw)));
+            __m128 drift = _mm_sub_ps(l2, _mm_set1_ps(1.0f));
+            drift = _mm_andnot_ps(_mm_set1_ps(-0.0f), drift);
+            __m128 drifted = _mm_cmpgt_ps(drift, _mm_set1_ps(DRIFT));
+
+            if(_mm_movemask_ps(drifted) != 0)
+            {
+                __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(l2));
+                inv = _mm_or_ps(_mm_and_ps(drifted, inv), _mm_andnot_ps(drifted, _mm_set1_ps(1.0f)));
+                ri = _mm_mul_ps(ri, inv);
+                rj = _mm_mul_ps(rj, inv);
+                rk = _mm_mul_ps(rk, inv);
+                rw = _mm_mul_ps(rw, inv);
+            }
+
+            store(b.qi, n, ri);
+            store(b.qj, n, rj);
+            store(b.qk, n, rk);
+            store(b.qw, n, rw);
+        }
+#endif // __SSE2__
+    }
+
+    unsigned rigidBodies::add(const vec3& position, const quat& orientation)
+    {
+        return add(position, orientation, vec3(0.0f), vec3(0.0f));
+    }
+
+    unsigned rigidBodies::add(const vec3& position, const quat& orientation, const vec3& velocity, const vec3& angularVelocity)
+    {
+        unsigned n = count();
+        resize(n + 1);
+
+        x[n] = position.x; y[n] = position.y; z[n] = position.z;
+        vx[n] = velocity.x; vy[n] = velocity.y; vz[n] = velocity.z;
+        qi[n] = orientation.i; qj[n] = orientation.j; qk[n] = orientation.k; qw[n] = orientation.w;
+        wx[n] = angularVelocity.x; wy[n] = angularVelocity.y; wz[n] = angularVelocity.z;
+
+        return n;
+    }
+
+    // new bodies are at the origin, at rest with the identity orientation
+    void rigidBodies::resize(const unsigned& count)
+    {
+        std::vector<float>* zero[] = { &x, &y, &z, &vx, &vy, &vz, &qi, &qj, &qk, &wx, &wy, &wz, &ax, &ay, &az, &alphaX, &alphaY, &alphaZ };
+        for(std::vector<float>* v : zero)
+        {
+            v->resize(count, 0.0f);
+        }
+
+        qw.resize(count, 1.0f);
+    }
+
+    void rigidBodies::clear()
+    {
+        resize(0);
+    }
+
+    unsigned rigidBodies::count() const
+    {
+        return (unsigned)x.size();
+    }
+
+    vec3 rigidBodies::position(const unsigned& n) const
+    {
+        return vec3(x[n], y[n], z[n]);
+    }
+
+    quat rigidBodies::orientation(const unsigned& n) const
+    {
+        return quat(qi[n], qj[n], qk[n], qw[n]);
+    }
+
+    void rigidBodies::integrate(const float& dt, const vec3& gravity)
+    {
+        integrate(0, count(), dt, gravity);
+    }
+
+    void rigidBodies::integrate(const unsigned& begin, const unsigned& end, const float& dt, const vec3& gravity)
+    {
+        M3D_PROFILE("rigidBodies::integrate");
+
+        float halfDt = 0.5f * dt;
+        unsigned n = begin;
+
+#ifdef __SSE2__
+        __m128 dt4 = _mm_set1_ps(dt);
+        __m128 halfDt4 = _mm_set1_ps(halfDt);
+        __m128 g[3] = { _mm_set1_ps(gravity.x), _mm_set1_ps(gravity.y), _mm_set1_ps(gravity.z) };
+
+        for(; n + 4 <= end; n += 4)
+        {
+            step4(*this, n, dt4, halfDt4, g);
+        }
+#endif // __SSE2__
+
+        for(; n < end; n++)
+        {
+            step(*this, n, dt, halfDt, gravity);
+        }
+    }
+
+    // ranges are rounded to multiples of four so only the last one has a scalar tail
+    void rigidBodies::integrateParallel(const float& dt, const vec3& gravity)
+    {
+        unsigned groups = (count() + 3) / 4;
+        parallelFor(groups, GRAIN / 4, [&](unsigned begin, unsigned end)
+        {
+            integrate(begin * 4, end * 4 < count() ? end * 4 : count(), dt, gravity);
+        });
+    }
+}
@@ -0,0 +1,508 @@
+#include "m3d/spline.h"
+#include "m3d/vec2.h"
+#include "m3d/vec3.h"
+#include "m3d/profile.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+namespace m3d
+{
+    namespace
+    {
+        // vec2 and vec3 are plain floats, curves are evaluated on those
+        template<class T> struct dimension
+        {
+            static const unsigned value = sizeof(T) / sizeof(float);
+        };
+
+        const unsigned REFINE_STEPS = 4;
+        const unsigned DISTANCE_STEPS = 2;
+        // forward differences drift, they restart from the polynomial this often
+        const unsigned FORWARD_RUN = 32;
+
+        // rows give a b c d of a segment from its four control points
+        //https://en.wikipedia.org/wiki/B%C3%A9zier_curve#Cubic_B%C3%A9zier_curves
+        const float BEZIER_BASIS[4][4] =
+        {
+            { 1.0f, 0.0f, 0.0f, 0.0f },
+            { -3.0f, 3.0f, 0.0f, 0.0f },
+            { 3.0f, -6.0f, 3.0f, 0.0f },
+            { -1.0f, 3.0f, -3.0f, 1.0f }
+        };
+
+        //https://en.wikipedia.org/wiki/Centripetal_Catmull%E2%80%93Rom_spline, the uniform case
+        const float CATMULL_ROM_BASIS[4][4] =
+        {
+            { 0.0f, 1.0f, 0.0f, 0.0f },
+            { -0.5f, 0.0f, 0.5f, 0.0f },
+            { 1.0f, -2.5f, 2.0f, -0.5f },
+            { -0.5f, 1.5f, -1.5f, 0.5f }
+        };
+
+        const float BSPLINE_BASIS[4][4] =
+        {
+            { 1.0f / 6.0f, 4.0f / 6.0f, 1.0f / 6.0f, 0.0f },
+            { -0.5f, 0.0f, 0.5f, 0.0f },
+            { 0.5f, -1.0f, 0.5f, 0.0f },
+            { -1.0f / 6.0f, 0.5f, -0.5f, 1.0f / 6.0f }
+        };
+
+        template<unsigned D> inline void horner(const float* c, const float& s, float* res)
+        {
+            for(unsigned k = 0; k < D; k++)
+            {
+                res[k] = c[k] + s * (c[D + k] + s * (c[D * 2 + k] + s * c[D * 3 + k]));
+            }
+        }
+
+        template<unsigned D> inline void firstDerivative(const float* c, const float& s, float* res)
+        {
+            for(unsigned k = 0; k < D; k++)
+            {
+                res[k] = c[D + k] + s * (2.0f * c[D * 2 + k] + 3.0f * s * c[D * 3 + k]);
+            }
+        }
+
+        template<unsigned D> inline void secondDerivative(const float* c, const float& s, float* res)
+        {
+            for(unsigned k = 0; k < D; k++)
+            {
+                res[k] = 2.0f * c[D * 2 + k] + 6.0f * s * c[D * 3 + k];
+            }
+        }
+
+        template<unsigned D> inline float dot(const float* a, const float* b)
+        {
+            float res = 0.0f;
+            for(unsigned k = 0; k < D; k++)
+            {
+                res += a[k] * b[k];
+            }
+            return res;
+        }
+
+        template<unsigned D> inline float distanceSqr(const float* a, const float* b)
+        {
+            float res = 0.0f;
+            for(unsigned k = 0; k < D; k++)
+            {
+                res += (a[k] - b[k]) * (a[k] - b[k]);
+            }
+            return res;
+        }
+    }
+
+    template <typename T> spline<T>::spline() : m_segmentCount(0), m_samplesPerSegment(1) {}
+
+    template <typename T> bool spline<T>::build(const T* points, const unsigned& count, const type& kind, const unsigned& samplesPerSegment)
+    {
+        M3D_PROFILE("spline::build");
+
+        const unsigned D = dimension<T>::value;
+
+        m_coefficients.clear();
+        m_lengths.clear();
+        m_samples.clear();
+        m_segmentCount = 0;
+        m_samplesPerSegment = std::max(samplesPerSegment, 1u);
+
+        const float (*basis)[4];
+        unsigned segments, stride;
+        switch(kind)
+        {
+        case BEZIER:
+            if(count < 4 || (count - 1) % 3 != 0)
+                return false;
+            basis = BEZIER_BASIS;
+            segments = (count - 1) / 3;
+            stride = 3;
+            break;
+        case CATMULL_ROM:
+            if(count < 2)
+                return false;
+            basis = CATMULL_ROM_BASIS;
+            segments = count - 1;
+            stride = 1;
+            break;
+        case BSPLINE:
+            if(count < 4)
+                return false;
+            basis = BSPLINE_BASIS;
+            segments = count - 3;
+            stride = 1;
+            break;
+        default:
+            return false;
+        }
+
+        const float* p = reinterpret_cast<const float*>(points);
+        m_segmentCount = segments;
+        m_coefficients.resize(segments * 4 * D);
+
+        for(unsigned i = 0; i < segments; i++)
+        {
+            float control[4][3];
+            for(unsigned j = 0; j < 4; j++)
+            {
+                // catmull-rom starts one point before its segment, the ends are mirrored
+                int index = (int)(i * stride + j) - (kind == CATMULL_ROM ? 1 : 0);
+                for(unsigned k = 0; k < D; k++)
+                {
+                    if(index < 0)
+                        control[j][k] = 2.0f * p[k] - p[D + k];
+                    else if(index >= (int)count)
+                        control[j][k] = 2.0f * p[(count - 1) * D + k] - p[(count - 2) * D + k];
+                    else
+                        control[j][k] = p[index * D + k];
+                }
+            }
+
+            float* c = m_coefficients.data() + i * 4 * D;
+            for(unsigned row = 0; row < 4; row++)
+            {
+                for(unsigned k = 0; k < D; k++)
+                {
+                    c[row * D + k] = basis[row][0] * control[0][k] + basis[row][1] * control[1][k] +
+                                     basis[row][2] * control[2][k] + basis[row][3] * control[3][k];
+                }
+            }
+        }
+
+        // the arc length table, chords between samples
+        const unsigned samples = segments * m_samplesPerSegment + 1;
+        m_samples.resize(samples * D);
+        m_lengths.resize(samples);
+
+        std::vector<float> steps((m_samplesPerSegment + 1) * D);
+        for(unsigned i = 0; i < segments; i++)
+        {
+            forward(m_coefficients.data() + i * 4 * D, 0.0f, 1.0f / m_samplesPerSegment, m_samplesPerSegment, steps.data());
+            std::copy(steps.begin(), steps.end(), m_samples.begin() + i * m_samplesPerSegment * D);
+        }
+
+        m_lengths[0] = 0.0f;
+        for(unsigned i = 1; i < samples; i++)
+        {
+            m_lengths[i] = m_lengths[i - 1] + sqrtf(distanceSqr<D>(&m_samples[(i - 1) * D], &m_samples[i * D]));
+        }
+
+        return true;
+    }
+
+    template <typename T> unsigned spline<T>::segmentCount() const
+    {
+        return m_segmentCount;
+    }
+
+    template <typename T> float spline<T>::length() const
+    {
+        return m_lengths.empty() ? 0.0f : m_lengths.back();
+    }
+
+    template <typename T> const float* spline<T>::segment(const float& t, float& s) const
+    {
+        float clamped = std::min(std::max(t, 0.0f), (float)m_segmentCount);
+        unsigned i = std::min((unsigned)clamped, m_segmentCount - 1);
+        s = clamped - (float)i;
+        return m_coefficients.data() + i * 4 * dimension<T>::value;
+    }
+
+    template <typename T> T spline<T>::evaluate(const float& t) const
+    {
+        T res;
+        if(m_segmentCount == 0)
+            return res;
+
+        float s;
+        const float* c = segment(t, s);
+        horner<dimension<T>::value>(c, s, reinterpret_cast<float*>(&res));
+        return res;
+    }
+
+    template <typename T> T spline<T>::derivative(const float& t) const
+    {
+        T res;
+        if(m_segmentCount == 0)
+            return res;
+
+        float s;
+        const float* c = segment(t, s);
+        firstDerivative<dimension<T>::value>(c, s, reinterpret_cast<float*>(&res));
+        return res;
+    }
+
+    template <typename T> T spline<T>::secondDerivative(const float& t) const
+    {
+        T res;
+        if(m_segmentCount == 0)
+            return res;
+
+        float s;
+        const float* c = segment(t, s);
+        m3d::secondDerivative<dimension<T>::value>(c, s, reinterpret_cast<float*>(&res));
+        return res;
+    }
+
+    template <typename T> float spline<T>::parameterAtDistance(const float& distance) const
+    {
+        if(m_segmentCount == 0)
+            return 0.0f;
+
+        float d = std::min(std::max(distance, 0.0f), m_lengths.back());
+        unsigned i = (unsigned)(std::upper_bound(m_lengths.begin(), m_lengths.end(), d) - m_lengths.begin());
+        i = std::min(std::max(i, 1u), (unsigned)m_lengths.size() - 1) - 1;
+        return sampleParameter(i, d);
+    }
+
+    // the table is built from chords, so within a sample the chord from its start is solved for with newton,
+    // which keeps the speed even where a linear guess in t would not
+    template <typename T> float spline<T>::sampleParameter(const unsigned& sample, const float& distance) const
+    {
+        const unsigned D = dimension<T>::value;
+
+        float step = 1.0f / (float)m_samplesPerSegment;
+        float lo = (float)sample * step;
+        float span = m_lengths[sample + 1] - m_lengths[sample];
+        if(span <= 0.0f)
+            return lo;
+
+        float target = std::min(distance - m_lengths[sample], span);
+        float t = lo + step * target / span;
+        const float* start = m_samples.data() + sample * D;
+
+        for(unsigned n = 0; n < DISTANCE_STEPS; n++)
+        {
+            float s, position[D], d1[D], offset[D];
+            const float* c = segment(t, s);
+            horner<D>(c, s, position);
+            firstDerivative<D>(c, s, d1);
+
+            for(unsigned k = 0; k < D; k++)
+            {
+                offset[k] = position[k] - start[k];
+            }
+
+            float chord = sqrtf(dot<D>(offset, offset));
+            float slope = chord > 0.0f ? dot<D>(offset, d1) / chord : sqrtf(dot<D>(d1, d1));
+            if(slope <= 0.0f)
+                break;
+
+            t = std::min(std::max(t - (chord - target) / slope, lo), lo + step);
+        }
+
+        return t;
+    }
+
+    template <typename T> T spline<T>::evaluateAtDistance(const float& distance) const
+    {
+        return evaluate(parameterAtDistance(distance));
+    }
+
+    // newton on (P(t) - p) . P'(t) = 0, kept inside [lo, hi]
+    template <typename T> float spline<T>::refine(const float* p, float t, const float& lo, const float& hi) const
+    {
+        const unsigned D = dimension<T>::value;
+
+        for(unsigned n = 0; n < REFINE_STEPS; n++)
+        {
+            float s, position[D], d1[D], d2[D], offset[D];
+            const float* c = segment(t, s);
+            horner<D>(c, s, position);
+            firstDerivative<D>(c, s, d1);
+            m3d::secondDerivative<D>(c, s, d2);
+
+            for(unsigned k = 0; k < D; k++)
+            {
+                offset[k] = position[k] - p[k];
+            }
+
+            float slope = dot<D>(d1, d1) + dot<D>(offset, d2);
+            if(slope <= 0.0f)
+                break;
+
+            t = std::min(std::max(t - dot<D>(offset, d1) / slope, lo), hi);
+        }
+
+        return t;
+    }
+
+    template <typename T> float spline<T>::closest(const T& p, T* point) const
+    {
+        const unsigned D = dimension<T>::value;
+
+        if(m_segmentCount == 0)
+        {
+            if(point)
+                *point = T();
+            return 0.0f;
+        }
+
+        // newton from every sample closer than its neighbours, a single nearest sample can sit on the wrong lobe
+        const float* q = reinterpret_cast<const float*>(&p);
+        const unsigned samples = (unsigned)m_lengths.size();
+        const float step = 1.0f / (float)m_samplesPerSegment;
+
+        float previous = FLT_MAX;
+        float current = distanceSqr<D>(q, m_samples.data());
+        float bestDistance = FLT_MAX;
+        float refined = 0.0f;
+        T res;
+
+        for(unsigned i = 0; i < samples; i++)
+        {
+            float next = i + 1 < samples ? distanceSqr<D>(q, m_samples.data() + (i + 1) * D) : FLT_MAX;
+            if(current <= previous && current <= next)
+            {
+                float t = (float)i * step;
+                float candidate = refine(q, t, std::max(t - step, 0.0f), std::min(t + step, (float)m_segmentCount));
+                T position = evaluate(candidate);
+                float d = distanceSqr<D>(q, reinterpret_cast<const float*>(&position));
+                if(d > current)
+                {
+                    candidate = t;
+                    position = evaluate(t);
+                    d = current;
+                }
+
+                if(d < bestDistance)
+                {
+                    bestDistance = d;
+                    refined = candidate;
+                    res = position;
+                }
+            }
+
+            previous = current;
+            current = next;
+        }
+
+        if(point)
+            *point = res;
+        return refined;
+    }
+
+    template <typename T> void spline<T>::evaluate(const float* t, const unsigned& count, T* res) const
+    {
+        M3D_PROFILE("spline::evaluate");
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            res[n] = evaluate(t[n]);
+        }
+    }
+
+    template <typename T> void spline<T>::evaluateAtDistance(const float* distances, const unsigned& count, T* res) const
+    {
+        M3D_PROFILE("spline::evaluateAtDistance");
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            res[n] = evaluate(parameterAtDistance(distances[n]));
+        }
+    }
+
+    template <typename T> void spline<T>::closest(const T* points, const unsigned& count, float* t, T* res) const
+    {
+        M3D_PROFILE("spline::closest");
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            float v = closest(points[n], res ? res + n : nullptr);
+            if(t)
+                t[n] = v;
+        }
+    }
+
+    //https://www.scratchapixel.com/lessons/geometry/bezier-curve-rendering-utah-teapot/fast-forward-differencing.html
+    // the starting differences come straight from the coefficients, differencing evaluated points would cancel.
+    // they still drift, so they restart from the polynomial every FORWARD_RUN points
+    template <typename T> void spline<T>::forward(const float* c, const float& s0, const float& h, const unsigned& steps, float* res) const
+    {
+        const unsigned D = dimension<T>::value;
+        const float h2 = h * h, h3 = h2 * h;
+
+        for(unsigned begin = 0; begin <= steps; begin += FORWARD_RUN)
+        {
+            float s = s0 + h * (float)begin;
+            float f[D], d1[D], d2[D], d3[D];
+            horner<D>(c, s, f);
+            for(unsigned k = 0; k < D; k++)
+            {
+                float b = c[D + k], cc = c[D * 2 + k], d = c[D * 3 + k];
+                d1[k] = b * h + cc * (2.0f * s * h + h2) + d * (3.0f * s * s * h + 3.0f * s * h2 + h3);
+                d2[k] = 2.0f * cc * h2 + d * (6.0f * s * h2 + 6.0f * h3);
+                d3[k] = 6.0f * d * h3;
+            }
+
+            unsigned end = std::min(begin + FORWARD_RUN, steps + 1);
+            for(unsigned n = begin; n < end; n++)
+            {
+                for(unsigned k = 0; k < D; k++)
+                {
+                    res[n * D + k] = f[k];
+                    f[k] += d1[k];
+                    d1[k] += d2[k];
+                    d2[k] += d3[k];
+                }
+            }
+        }
+    }
+
+    template <typename T> void spline<T>::evaluateUniform(const unsigned& count, T* res) const
+    {
+        M3D_PROFILE("spline::evaluateUniform");
+
+        if(count == 0)
+            return;
+
+        if(count == 1 || m_segmentCount == 0)
+        {
+            std::fill(res, res + count, evaluate(0.0f));
+            return;
+        }
+
+        // differences restart on every segment, the coefficients change there
+        float h = (float)m_segmentCount / (float)(count - 1);
+        float* out = reinterpret_cast<float*>(res);
+        unsigned n = 0;
+        for(unsigned i = 0; i < m_segmentCount && n < count; i++)
+        {
+            unsigned end = i + 1 == m_segmentCount ? count : std::min((unsigned)ceilf((float)(i + 1) / h), count);
+            if(end <= n)
+                continue;
+
+            forward(m_coefficients.data() + i * 4 * dimension<T>::value, (float)n * h - (float)i, h, end - n - 1, out + n * dimension<T>::value);
+            n = end;
+        }
+    }
+
+    template <typename T> void spline<T>::evaluateUniformDistance(const unsigned& count, T* res) const
+    {
+        M3D_PROFILE("spline::evaluateUniformDistance");
+
+        if(count == 0)
+            return;
+
+        if(count == 1 || m_segmentCount == 0)
+        {
+            std::fill(res, res + count, evaluate(0.0f));
+            return;
+        }
+
+        float step = length() / (float)(count - 1);
+        unsigned i = 0;
+        const unsigned last = (unsigned)m_lengths.size() - 1;
+        for(unsigned n = 0; n < count; n++)
+        {
+            float d = n + 1 == count ? m_lengths[last] : (float)n * step;
+            while(i + 1 < last && m_lengths[i + 1] <= d) i++;
+
+            res[n] = evaluate(sampleParameter(i, d));
+        }
+    }
+
+    template class spline<vec2>;
+    template class spline<vec3>;
+}
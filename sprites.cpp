@@ -0,0 +1,118 @@
+#include "m3d/sprites.h"
+#include "m3d/vec2.h"
+#include "m3d/math1D.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 16384;
+
+        // rotated axes a = R * (scaleX, 0) and b = R * (0, scaleY), corner 0 = position - R * origin,
+        // the other corners are corner 0 + a, + a + b and + b
+        inline void quad(const spriteStreams& in, const unsigned& n, float* v)
+        {
+            float s, c;
+            fastSincos(in.rotation[n], s, c);
+
+            float ox = in.originX ? in.originX[n] : 0.0f;
+            float oy = in.originY ? in.originY[n] : 0.0f;
+
+            float ax = c * in.scaleX[n];
+            float ay = s * in.scaleX[n];
+            float bx = -s * in.scaleY[n];
+            float by = c * in.scaleY[n];
+
+            float x0 = in.x[n] - (c * ox - s * oy);
+            float y0 = in.y[n] - (s * ox + c * oy);
+
+            v[0] = x0;              v[1] = y0;
+            v[2] = x0 + ax;         v[3] = y0 + ay;
+            v[4] = x0 + ax + bx;    v[5] = y0 + ay + by;
+            v[6] = x0 + bx;         v[7] = y0 + by;
+        }
+
+#ifdef __SSE2__
+        // quad for sprites n to n + 3, the corners are computed as x and y vectors of four sprites
+        // and interleaved into 8 floats per sprite
+        inline void quad4(const spriteStreams& in, const unsigned& n, float* v)
+        {
+            __m128 s, c;
+            fastSincos4(_mm_loadu_ps(in.rotation + n), s, c);
+
+            __m128 ox = in.originX ? _mm_loadu_ps(in.originX + n) : _mm_setzero_ps();
+            __m128 oy = in.originY ? _mm_loadu_ps(in.originY + n) : _mm_setzero_ps();
+            __m128 scaleX = _mm_loadu_ps(in.scaleX + n);
+            __m128 scaleY = _mm_loadu_ps(in.scaleY + n);
+
+            __m128 ax = _mm_mul_ps(c, scaleX);
+            __m128 ay = _mm_mul_ps(s, scaleX);
+            __m128 bx = _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(s, scaleY));
+            __m128 by = _mm_mul_ps(c, scaleY);
+
+            __m128 x0 = _mm_sub_ps(_mm_loadu_ps(in.x + n), _mm_sub_ps(_mm_mul_ps(c, ox), _mm_mul_ps(s, oy)));
+            __m128 y0 = _mm_sub_ps(_mm_loadu_ps(in.y + n), _mm_add_ps(_mm_mul_ps(s, ox), _mm_mul_ps(c, oy)));
+            __m128 x1 = _mm_add_ps(x0, ax);
+            __m128 y1 = _mm_add_ps(y0, ay);
+            __m128 x2 = _mm_add_ps(x1, bx);
+            __m128 y2 = _mm_add_ps(y1, by);
+            __m128 x3 = _mm_add_ps(x0, bx);
+            __m128 y3 = _mm_add_ps(y0, by);
+
+            // corner xy pairs for sprites 0 1 in the low halves, 2 3 in the high halves
+            __m128 c0lo = _mm_unpacklo_ps(x0, y0), c0hi = _mm_unpackhi_ps(x0, y0);
+            __m128 c1lo = _mm_unpacklo_ps(x1, y1), c1hi = _mm_unpackhi_ps(x1, y1);
+            __m128 c2lo = _mm_unpacklo_ps(x2, y2), c2hi = _mm_unpackhi_ps(x2, y2);
+            __m128 c3lo = _mm_unpacklo_ps(x3, y3), c3hi = _mm_unpackhi_ps(x3, y3);
+
+            _mm_storeu_ps(v, _mm_movelh_ps(c0lo, c1lo));
+            _mm_storeu_ps(v + 4, _mm_movelh_ps(c2lo, c3lo));
+            _mm_storeu_ps(v + 8, _mm_movehl_ps(c1lo, c0lo));
+            _mm_storeu_ps(v + 12, _mm_movehl_ps(c3lo, c2lo));
+            _mm_storeu_ps(v + 16, _mm_movelh_ps(c0hi, c1hi));
+            _mm_storeu_ps(v + 20, _mm_movelh_ps(c2hi, c3hi));
+            _mm_storeu_ps(v + 24, _mm_movehl_ps(c1hi, c0hi));
+            _mm_storeu_ps(v + 28, _mm_movehl_ps(c3hi, c2hi));
+        }
+#endif // __SSE2__
+    }
+
+    void sprites::quads(const spriteStreams& sprites, vec2* vertices, const unsigned& count)
+    {
+        M3D_PROFILE("sprites::quads");
+
+        float* out = &vertices[0].x;
+        unsigned n = 0;
+
+#ifdef __SSE2__
+        for(; n + 4 <= count; n += 4)
+        {
+            quad4(sprites, n, out + (size_t)n * 8);
+        }
+#endif // __SSE2__
+
+        for(; n < count; n++)
+        {
+            quad(sprites, n, out + (size_t)n * 8);
+        }
+    }
+
+    void sprites::quadsParallel(const spriteStreams& sprites, vec2* vertices, const unsigned& count)
+    {
+        parallelFor(count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            spriteStreams range = sprites;
+            range.x += begin;
+            range.y += begin;
+            range.rotation += begin;
+            range.scaleX += begin;
+            range.scaleY += begin;
+            if(range.originX) range.originX += begin;
+            if(range.originY) range.originY += begin;
+
+            sprites::quads(range, vertices + (size_t)begin * 4, end - begin);
+        });
+    }
+}
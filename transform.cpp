@@ -0,0 +1,210 @@
+#include "m3d/transform.h"
+#include "m3d/mat4x4.h"
+#include "m3d/mat3x3.h"
+#include "m3d/profile.h"
+
+#include <math.h>
+
+namespace m3d
+{
+    transform::transform() : transform(vec3(0.0f), quat(), vec3(1.0f)) {};
+    transform::transform(const vec3& position, const quat& rotation) : transform(position, rotation, vec3(1.0f)) {};
+    transform::transform(const vec3& position, const quat& rotation, const vec3& scale) : position(position), rotation(rotation), scale(scale) {};
+
+    ///////////////////////////////////////
+    //              STATIC               //
+    ///////////////////////////////////////
+
+    transform transform::lerp(const transform& a, const transform& b, const float& t)
+    {
+        M3D_PROFILE("transform::lerp");
+
+        transform res;
+        res.position = vec3::lerp(a.position, b.position, t);
+        res.rotation = quat::slerp(a.rotation, b.rotation, t);
+        res.scale = vec3::lerp(a.scale, b.scale, t);
+        return res;
+    }
+
+    // translation * rotation * scale
+    mat4x4 transform::toMat4x4(const transform& v)
+    {
+        M3D_PROFILE("transform::toMat4x4");
+
+        mat4x4 res;
+        mat3x3 r = mat3x3::initRotationFromQuat(v.rotation);
+        float s[3] = { v.scale.x, v.scale.y, v.scale.z };
+
+        for(int i = 0; i < 3; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                res.at(i, j) = r.at(i, j) * s[j];
+            }
+        }
+
+        res.at(0, 3) = v.position.x;
+        res.at(1, 3) = v.position.y;
+        res.at(2, 3) = v.position.z;
+        res.at(3, 3) = 1.0f;
+
+        return res;
+    }
+
+    namespace
+    {
+        // columns of a matrix without shear are orthogonal, the cosine between them is below this
+        const float SHEAR_TOLERANCE = 1e-4f;
+
+        // the upper 3x3 of m with the first column flipped when the determinant is negative,
+        // so the rotation stays proper and the mirror ends up in scale.x
+        mat3x3 upperProper(const mat4x4& m, float& flip)
+        {
+            mat3x3 res = mat3x3::fromMat4x4(m);
+
+            flip = mat3x3::determinant(res) < 0.0f ? -1.0f : 1.0f;
+            for(int i = 0; i < 3; i++)
+            {
+                res.at(i, 0) *= flip;
+            }
+
+            return res;
+        }
+    }
+
+    transform transform::decompose(const mat4x4& m)
+    {
+        M3D_PROFILE("transform::decompose");
+
+        transform res;
+        res.position = vec3(m.at(0, 3), m.at(1, 3), m.at(2, 3));
+
+        float flip;
+        mat3x3 u = upperProper(m, flip);
+
+        float len[3], dots[3];
+        int zeros = 0, zero = 0;
+        for(int j = 0; j < 3; j++)
+        {
+            len[j] = sqrtf(u.at(0, j) * u.at(0, j) + u.at(1, j) * u.at(1, j) + u.at(2, j) * u.at(2, j));
+            if(!(len[j] > 0.0f))
+            {
+                zeros++;
+                zero = j;
+            }
+        }
+
+        // a single flattened axis gets a unit column from the cross product of the other two, so the matrix is
+        // invertible again and the rotation survives. the scale of that axis is put back to zero at the end
+        float scale[3] = { len[0], len[1], len[2] };
+        if(zeros == 1)
+        {
+            int a = (zero + 1) % 3, b = (zero + 2) % 3;
+            vec3 c = vec3::cross(vec3(u.at(0, a), u.at(1, a), u.at(2, a)), vec3(u.at(0, b), u.at(1, b), u.at(2, b)));
+            float l = c.length();
+            if(l > 0.0f)
+            {
+                u.at(0, zero) = c.x / l;
+                u.at(1, zero) = c.y / l;
+                u.at(2, zero) = c.z / l;
+                len[zero] = 1.0f;
+            }
+        }
+
+        for(int j = 0; j < 3; j++)
+        {
+            int k = (j + 1) % 3;
+            dots[j] = u.at(0, j) * u.at(0, k) + u.at(1, j) * u.at(1, k) + u.at(2, j) * u.at(2, k);
+        }
+
+        bool sheared = false;
+        for(int j = 0; j < 3; j++)
+        {
+            sheared = sheared || fabsf(dots[j]) > SHEAR_TOLERANCE * len[j] * len[(j + 1) % 3];
+        }
+
+        if(!sheared && len[0] > 0.0f && len[1] > 0.0f && len[2] > 0.0f)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                float invLen = 1.0f / len[j];
+                for(int i = 0; i < 3; i++)
+                {
+                    u.at(i, j) *= invLen;
+                }
+            }
+
+            res.rotation = quat::fromRotation(u);
+            res.scale = vec3(scale[0] * flip, scale[1], scale[2]);
+            return res;
+        }
+
+        mat3x3 rotation, stretch;
+        if(!mat3x3::polarDecompose(u, rotation, stretch))
+        {
+            res.scale = vec3(scale[0] * flip, scale[1], scale[2]);
+            return res;
+        }
+
+        for(int j = 0; j < 3; j++)
+        {
+            if(scale[j] > 0.0f)
+                scale[j] = stretch.at(j, j);
+        }
+
+        res.rotation = quat::fromRotation(rotation);
+        res.scale = vec3(scale[0] * flip, scale[1], scale[2]);
+        return res;
+    }
+
+    void transform::decompose(const mat4x4* m, transform* res, const unsigned& count)
+    {
+        for(unsigned n = 0; n < count; n++)
+        {
+            res[n] = transform::decompose(m[n]);
+        }
+    }
+
+    bool transform::decompose(const mat4x4& m, vec3& translation, quat& rotation, mat3x3& stretch)
+    {
+        translation = vec3(m.at(0, 3), m.at(1, 3), m.at(2, 3));
+
+        float flip;
+        mat3x3 r;
+        if(!mat3x3::polarDecompose(upperProper(m, flip), r, stretch))
+            return false;
+
+        // undo the flip on the stretch so rotation * stretch is the original matrix
+        for(int j = 0; j < 3; j++)
+        {
+            stretch.at(j, 0) *= flip;
+        }
+
+        rotation = quat::fromRotation(r);
+        return true;
+    }
+
+    bool transform::equals(const transform& a, const transform& b)
+    {
+        return a.position == b.position && a.rotation == b.rotation && a.scale == b.scale;
+    }
+
+    ///////////////////////////////////////
+    //              METHODS              //
+    ///////////////////////////////////////
+
+    mat4x4 transform::toMat4x4() const
+    {
+        return transform::toMat4x4(*this);
+    }
+}
+
+bool operator==(const m3d::transform& a, const m3d::transform&b)
+{
+    return m3d::transform::equals(a, b);
+}
+
+bool operator!=(const m3d::transform& a, const m3d::transform&b)
+{
+    return !m3d::transform::equals(a, b);
+}
@@ -0,0 +1,160 @@
+#include "m3d/transformStore.h"
+#include "m3d/mat4x4.h"
+#include "m3d/parallel.h"
+#include "m3d/profile.h"
+
+namespace m3d
+{
+    namespace
+    {
+        const unsigned GRAIN = 1024;
+    }
+
+    // writer starts on 0, 1 is the exchange slot, the reader holds 2 and 3
+    transformStore::transformStore(const unsigned& count) : m_transforms((size_t)count * SLOTS), m_count(count),
+        m_write(0), m_frame(0), m_previous(2), m_current(3), m_exchange(1)
+    {
+        for(unsigned n = 0; n < SLOTS; n++)
+        {
+            m_snapshots[n].time = 0.0;
+            m_snapshots[n].frame = 0;
+        }
+    }
+
+    unsigned transformStore::count() const
+    {
+        return m_count;
+    }
+
+    transform* transformStore::write()
+    {
+        return m_transforms.data() + (size_t)m_write * m_count;
+    }
+
+    void transformStore::publish(const double& time)
+    {
+        m_snapshots[m_write].time = time;
+        m_snapshots[m_write].frame = ++m_frame;
+
+        // release makes the snapshot visible with the index, acquire gets the reader's writes to the slot coming back
+        m_write = m_exchange.exchange(m_write | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+
+    bool transformStore::acquire()
+    {
+        if(!(m_exchange.load(std::memory_order_relaxed) & FRESH))
+            return false;
+
+        // only the reader clears FRESH, so the exchange slot is still fresh here even if the writer published again
+        unsigned fresh = m_exchange.exchange(m_previous, std::memory_order_acq_rel) & ~FRESH;
+        m_previous = m_current;
+        m_current = fresh;
+        return true;
+    }
+
+    const transform* transformStore::slot(const unsigned& index) const
+    {
+        return m_transforms.data() + (size_t)index * m_count;
+    }
+
+    const transform* transformStore::previous() const
+    {
+        if(m_snapshots[m_current].frame == 0)
+            return nullptr;
+
+        return slot(m_snapshots[m_previous].frame == 0 ? m_current : m_previous);
+    }
+
+    const transform* transformStore::current() const
+    {
+        return m_snapshots[m_current].frame == 0 ? nullptr : slot(m_current);
+    }
+
+    double transformStore::previousTime() const
+    {
+        return m_snapshots[m_previous].frame == 0 ? currentTime() : m_snapshots[m_previous].time;
+    }
+
+    double transformStore::currentTime() const
+    {
+        return m_snapshots[m_current].time;
+    }
+
+    float transformStore::factor(const double& time) const
+    {
+        double from = previousTime(), to = currentTime();
+        if(to <= from)
+            return 1.0f;
+
+        double t = (time - from) / (to - from);
+        return t < 0.0 ? 0.0f : t > 1.0 ? 1.0f : (float)t;
+    }
+
+    void transformStore::interpolateRange(const float& t, const unsigned& begin, const unsigned& end, transform* res) const
+    {
+        const transform* a = previous();
+        const transform* b = current();
+
+        for(unsigned n = begin; n < end; n++)
+        {
+            res[n].position = vec3::lerp(a[n].position, b[n].position, t);
+            res[n].rotation = quat::slerp(a[n].rotation, b[n].rotation, t);
+            res[n].scale = vec3::lerp(a[n].scale, b[n].scale, t);
+        }
+    }
+
+    void transformStore::interpolateRange(const float& t, const unsigned& begin, const unsigned& end, mat4x4* res) const
+    {
+        const transform* a = previous();
+        const transform* b = current();
+
+        for(unsigned n = begin; n < end; n++)
+        {
+            transform v(vec3::lerp(a[n].position, b[n].position, t), quat::slerp(a[n].rotation, b[n].rotation, t),
+                        vec3::lerp(a[n].scale, b[n].scale, t));
+            res[n] = transform::toMat4x4(v);
+        }
+    }
+
+    void transformStore::interpolate(const float& t, transform* res) const
+    {
+        M3D_PROFILE("transformStore::interpolate");
+
+        if(current())
+            interpolateRange(t, 0, m_count, res);
+    }
+
+    void transformStore::interpolate(const float& t, mat4x4* res) const
+    {
+        M3D_PROFILE("transformStore::interpolate");
+
+        if(current())
+            interpolateRange(t, 0, m_count, res);
+    }
+
+    void transformStore::interpolateParallel(const float& t, transform* res) const
+    {
+        M3D_PROFILE("transformStore::interpolateParallel");
+
+        if(!current())
+            return;
+
+        parallelFor(m_count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            interpolateRange(t, begin, end, res);
+        });
+    }
+
+    void transformStore::interpolateParallel(const float& t, mat4x4* res) const
+    {
+        M3D_PROFILE("transformStore::interpolateParallel");
+
+        if(!current())
+            return;
+
+        parallelFor(m_count, GRAIN, [&](unsigned begin, unsigned end)
+        {
+            interpolateRange(t, begin, end, res);
+        });
+    }
+}
@@ -0,0 +1,354 @@
+#include "m3d/upload.h"
+#include "m3d/vec2.h"
+#include "m3d/vec3.h"
+#include "m3d/vec4.h"
+#include "m3d/mat3x3.h"
+#include "m3d/mat4x4.h"
+#include "m3d/affine.h"
+
+#include <string.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif // __SSE__
+
+//https://www.khronos.org/opengl/wiki/Interface_Block_(GLSL)#Memory_layout
+
+namespace m3d
+{
+    namespace
+    {
+#ifdef __SSE__
+        inline void store(uint8_t* dst, const __m128& v)
+        {
+            if(((uintptr_t)dst & 15) == 0)
+                _mm_stream_ps((float*)dst, v);
+            else
+                _mm_storeu_ps((float*)dst, v);
+        }
+
+        inline void store(uint8_t* dst, const float& x, const float& y, const float& z, const float& w)
+        {
+            store(dst, _mm_setr_ps(x, y, z, w));
+        }
+#else
+        inline void store(uint8_t* dst, const float& x, const float& y, const float& z, const float& w)
+        {
+            float v[4] = { x, y, z, w };
+            memcpy(dst, v, sizeof(v));
+        }
+#endif // __SSE__
+
+        // 4 columns of 16 bytes
+        inline void storeMat4x4(uint8_t* dst, const mat4x4& v)
+        {
+#if defined(__SSE__) && defined(M3D_COLUMN_MAJOR)
+            for(int j = 0; j < 4; j++)
+            {
+                store(dst + j * 16, _mm_loadu_ps(v.m[j]));
+            }
+#elif defined(__SSE__)
+            __m128 r0 = _mm_loadu_ps(v.m[0]);
+            __m128 r1 = _mm_loadu_ps(v.m[1]);
+            __m128 r2 = _mm_loadu_ps(v.m[2]);
+            __m128 r3 = _mm_loadu_ps(v.m[3]);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            store(dst, r0);
+            store(dst + 16, r1);
+            store(dst + 32, r2);
+            store(dst + 48, r3);
+#else
+            for(int j = 0; j < 4; j++)
+            {
+                store(dst + j * 16, v.at(0, j), v.at(1, j), v.at(2, j), v.at(3, j));
+            }
+#endif
+        }
+
+        // 3 columns padded to 16 bytes
+        inline void storeMat3x3(uint8_t* dst, const mat3x3& v)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                store(dst + j * 16, v.at(0, j), v.at(1, j), v.at(2, j), 0.0f);
+            }
+        }
+
+        // 3 rows of 16 bytes
+        inline void storeAffine(uint8_t* dst, const affine& v)
+        {
+            for(int i = 0; i < 3; i++)
+            {
+                store(dst + i * 16, v.m[i][0], v.m[i][1], v.m[i][2], v.m[i][3]);
+            }
+        }
+    }
+
+    uploadWriter::uploadWriter(void* dst, const size_t& capacity, const layout& layout)
+        : m_dst((uint8_t*)dst), m_capacity(capacity), m_offset(0), m_layout(layout) {}
+
+    size_t uploadWriter::offset() const
+    {
+        return m_offset;
+    }
+
+    size_t uploadWriter::capacity() const
+    {
+        return m_capacity;
+    }
+
+    uint8_t* uploadWriter::reserve(const size_t& alignment, const size_t& size)
+    {
+        size_t start = (m_offset + alignment - 1) / alignment * alignment;
+        if(start > m_capacity || size > m_capacity - start)
+            return nullptr;
+
+        m_offset = start + size;
+        return m_dst + start;
+    }
+
+    bool uploadWriter::align(const size_t& alignment)
+    {
+        return reserve(alignment, 0) != nullptr;
+    }
+
+    ///////////////////////////////////////
+    //              SINGLE               //
+    ///////////////////////////////////////
+
+    bool uploadWriter::write(const float& v)
+    {
+        uint8_t* dst = reserve(4, 4);
+        if(dst == nullptr)
+            return false;
+
+        memcpy(dst, &v, 4);
+        return true;
+    }
+
+    bool uploadWriter::write(const vec2& v)
+    {
+        uint8_t* dst = reserve(8, 8);
+        if(dst == nullptr)
+            return false;
+
+        float f[2] = { v.x, v.y };
+        memcpy(dst, f, 8);
+        return true;
+    }
+
+    // a following float can use the last 4 bytes, so no padding is written
+    bool uploadWriter::write(const vec3& v)
+    {
+        uint8_t* dst = reserve(16, 12);
+        if(dst == nullptr)
+            return false;
+
+        float f[3] = { v.x, v.y, v.z };
+        memcpy(dst, f, 12);
+        return true;
+    }
+
+    bool uploadWriter::write(const vec4& v)
+    {
+        uint8_t* dst = reserve(16, 16);
+        if(dst == nullptr)
+            return false;
+
+        store(dst, v.x, v.y, v.z, v.w);
+        return true;
+    }
+
+    bool uploadWriter::write(const mat3x3& v)
+    {
+        uint8_t* dst = reserve(16, 48);
+        if(dst == nullptr)
+            return false;
+
+        storeMat3x3(dst, v);
+        return true;
+    }
+
+    bool uploadWriter::write(const mat4x4& v)
+    {
+        uint8_t* dst = reserve(16, 64);
+        if(dst == nullptr)
+            return false;
+
+        storeMat4x4(dst, v);
+        return true;
+    }
+
+    bool uploadWriter::write(const affine& v)
+    {
+        uint8_t* dst = reserve(16, 48);
+        if(dst == nullptr)
+            return false;
+
+        storeAffine(dst, v);
+        return true;
+    }
+
+    ///////////////////////////////////////
+    //              ARRAYS               //
+    ///////////////////////////////////////
+
+    bool uploadWriter::write(const float* v, const unsigned& count)
+    {
+        size_t stride = arrayStride(m_layout, 4, 4);
+        uint8_t* dst = reserve(stride == 4 ? 4 : 16, stride * count);
+        if(dst == nullptr)
+            return false;
+
+        if(stride == 16)
+        {
+            for(unsigned n = 0; n < count; n++)
+            {
+                store(dst + n * 16, v[n], 0.0f, 0.0f, 0.0f);
+            }
+            return true;
+        }
+
+        // packed, plain stores up to the first 16 byte boundary then whole chunks
+        unsigned n = 0;
+        for(; n < count && ((uintptr_t)(dst + n * 4) & 15) != 0; n++)
+        {
+            memcpy(dst + n * 4, v + n, 4);
+        }
+        for(; n + 4 <= count; n += 4)
+        {
+            store(dst + n * 4, v[n], v[n + 1], v[n + 2], v[n + 3]);
+        }
+        if(n < count)
+        {
+            memcpy(dst + n * 4, v + n, (count - n) * 4);
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const vec2* v, const unsigned& count)
+    {
+        size_t stride = arrayStride(m_layout, 8, 8);
+        uint8_t* dst = reserve(stride == 8 ? 8 : 16, stride * count);
+        if(dst == nullptr)
+            return false;
+
+        if(stride == 16)
+        {
+            for(unsigned n = 0; n < count; n++)
+            {
+                store(dst + n * 16, v[n].x, v[n].y, 0.0f, 0.0f);
+            }
+            return true;
+        }
+
+        // packed, a single plain store when dst is not on a 16 byte boundary then pairs
+        unsigned n = 0;
+        if(count > 0 && ((uintptr_t)dst & 15) != 0)
+        {
+            memcpy(dst, &v[0].x, 4);
+            memcpy(dst + 4, &v[0].y, 4);
+            n++;
+        }
+        for(; n + 2 <= count; n += 2)
+        {
+            store(dst + n * 8, v[n].x, v[n].y, v[n + 1].x, v[n + 1].y);
+        }
+        if(n < count)
+        {
+            memcpy(dst + n * 8, &v[n].x, 4);
+            memcpy(dst + n * 8 + 4, &v[n].y, 4);
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const vec3* v, const unsigned& count)
+    {
+        uint8_t* dst = reserve(16, 16 * count);
+        if(dst == nullptr)
+            return false;
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            store(dst + n * 16, v[n].x, v[n].y, v[n].z, 0.0f);
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const vec4* v, const unsigned& count)
+    {
+        uint8_t* dst = reserve(16, 16 * count);
+        if(dst == nullptr)
+            return false;
+
+        for(unsigned n = 0; n < count; n++)
+        {
+#ifdef __SSE__
+            store(dst + n * 16, _mm_loadu_ps(&v[n].x));
+#else
+            store(dst + n * 16, v[n].x, v[n].y, v[n].z, v[n].w);
+#endif // __SSE__
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const mat3x3* v, const unsigned& count)
+    {
+        uint8_t* dst = reserve(16, 48 * count);
+        if(dst == nullptr)
+            return false;
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            storeMat3x3(dst + n * 48, v[n]);
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const mat4x4* v, const unsigned& count)
+    {
+        uint8_t* dst = reserve(16, 64 * count);
+        if(dst == nullptr)
+            return false;
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            storeMat4x4(dst + n * 64, v[n]);
+        }
+
+        return true;
+    }
+
+    bool uploadWriter::write(const affine* v, const unsigned& count)
+    {
+        uint8_t* dst = reserve(16, 48 * count);
+        if(dst == nullptr)
+            return false;
+
+        for(unsigned n = 0; n < count; n++)
+        {
+            storeAffine(dst + n * 48, v[n]);
+        }
+
+        return true;
+    }
+
+    void uploadWriter::flush()
+    {
+#ifdef __SSE__
+        _mm_sfence();
+#endif // __SSE__
+    }
+
+    // std140 rounds array strides up to a vec4, std430 keeps the element alignment
+    size_t uploadWriter::arrayStride(const layout& layout, const size_t& size, const size_t& alignment)
+    {
+        size_t base = layout == STD140 && alignment < 16 ? 16 : alignment;
+        return (size + base - 1) / base * base;
+    }
+}
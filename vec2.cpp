@@ -1,5 +1,6 @@
 #include "m3d/vec2.h"
 #include "m3d/math1D.h"
+#include "m3d/profile.h"
 #include <math.h>
 
 namespace m3d
@@ -14,6 +15,8 @@ namespace m3d
 
     float vec2::angle(const vec2& a, const vec2& b)
     {
+        M3D_PROFILE("vec2::angle");
+
         float numerator = vec2::dot(a, b);
         float denominator = vec2::length(a) * vec2::length(b);
 
@@ -73,6 +76,8 @@ namespace m3d
 
     vec2 vec2::normalized(const vec2& v)
     {
+        M3D_PROFILE("vec2::normalized");
+
         float length = vec2::length(v);
 
         if(length != 0)
@@ -90,6 +95,8 @@ namespace m3d
 
     vec2 vec2::slerp(const vec2& a, const vec2& b, const float& t)
     {
+        M3D_PROFILE("vec2::slerp");
+
         float dot = a.dot(b);
         dot = m3d::clamp(dot, -1.0f, 1.0f);
         float theta = acos(dot) * t;
@@ -1,7 +1,9 @@
 #include "m3d/vec3.h"
 #include "m3d/vec2.h"
 #include "m3d/math1D.h"
+#include "m3d/profile.h"
 #include <math.h>
+#include <float.h>
 
 namespace m3d
 {
@@ -47,6 +49,8 @@ namespace m3d
 
     float vec3::angle(const vec3& a, const vec3& b)
     {
+        M3D_PROFILE("vec3::angle");
+
         float numerator = vec3::dot(a, b);
         float denominator = vec3::length(a) * length(b);
 
@@ -55,6 +59,8 @@ namespace m3d
 
     vec3 vec3::cross(const vec3& a, const vec3& b)
     {
+        M3D_PROFILE("vec3::cross");
+
         vec3 res;
         res.x = a.y * b.z - a.z * b.y;
         res.y = a.z * b.x - a.x * b.z;
@@ -79,6 +85,8 @@ namespace m3d
 
     float vec3::length(const vec3& v)
     {
+        M3D_PROFILE("vec3::length");
+
         return sqrt(vec3::lengthSqr(v));
     }
 
@@ -89,6 +97,8 @@ namespace m3d
 
     vec3 vec3::lerp(const vec3& a, const vec3& b, const float& t)
     {
+        M3D_PROFILE("vec3::lerp");
+
         vec3 res;
         res.x = m3d::lerp(a.x, b.x, t);
         res.y = m3d::lerp(a.y, b.y, t);
@@ -118,6 +128,8 @@ namespace m3d
 
     vec3 vec3::normalized(const vec3& v)
     {
+        M3D_PROFILE("vec3::normalized");
+
         float length = vec3::length(v);
 
         if(length != 0)
@@ -125,6 +137,16 @@ namespace m3d
         else return v;
     }
 
+    vec3 vec3::normalizedFast(const vec3& v)
+    {
+        M3D_PROFILE("vec3::normalizedFast");
+
+        float lengthSqr = vec3::lengthSqr(v);
+
+        // the estimate flushes denormals, take the exact path for those
+        return lengthSqr >= FLT_MIN ? v * fastRsqrt(lengthSqr) : vec3::normalized(v);
+    }
+
     vec3 vec3::reflect(const vec3& v, const vec3& normal)
     {
         float numerator = vec3::dot(v * 2, normal);
@@ -135,6 +157,8 @@ namespace m3d
 
     vec3 vec3::slerp(const vec3& a, const vec3& b, const float& t)
     {
+        M3D_PROFILE("vec3::slerp");
+
         float dot = vec3::dot(a, b);
         dot = m3d::clamp(dot, -1.0f, 1.0f);
         float theta = acos(dot)* t;